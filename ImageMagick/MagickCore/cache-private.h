@@ -65,6 +65,9 @@ typedef void
 typedef void
   *(*GetAuthenticMetacontentFromHandler)(const Image *);
 
+typedef Image
+  *(*LoadPixelHandler)(const Image *,void *,ExceptionInfo *);
+
 typedef struct _CacheMethods
 {
   GetVirtualPixelHandler
@@ -101,6 +104,58 @@ typedef struct _CacheMethods
     destroy_pixel_handler;
 } CacheMethods;
 
+typedef struct _CacheBlob
+{
+  unsigned char
+    *data;
+
+  size_t
+    extent;
+
+  ssize_t
+    reference_count;
+
+  SemaphoreInfo
+    *semaphore;
+} CacheBlob;
+
+typedef struct _CacheBand
+{
+  CacheBlob
+    *blob;
+
+  Quantum
+    *pixels;
+
+  MagickBooleanType
+    dirty;
+
+  MagickSizeType
+    timestamp;
+} CacheBand;
+
+typedef struct _CacheBandInfo
+{
+  CacheBand
+    *bands;
+
+  size_t
+    rows,
+    number_bands;
+
+  size_t
+    *resident,
+    number_resident,
+    max_resident;
+
+  MagickSizeType
+    length,
+    timestamp;
+
+  unsigned char
+    *buffer;
+} CacheBandInfo;
+
 typedef struct _NexusInfo
 {
   MagickBooleanType
@@ -122,6 +177,10 @@ typedef struct _NexusInfo
   void
     *metacontent;
 
+  ssize_t
+    next_row,
+    readahead_row;
+
   size_t
     signature;
 } NexusInfo;
@@ -161,6 +220,23 @@ typedef struct _CacheInfo
   MagickBooleanType
     mapped;
 
+  size_t
+    tile_columns,
+    tile_rows;
+
+  CacheBandInfo
+    *band_info;
+
+  size_t
+    readahead,
+    storage_depth;
+
+  CacheStatistics
+    *statistics;
+
+  SemaphoreInfo
+    *statistics_semaphore;
+
   MagickOffsetType
     offset;
 
@@ -201,6 +277,17 @@ typedef struct _CacheInfo
   void
     *server_info;
 
+  LoadPixelHandler
+    loader;
+
+  void
+    *loader_info,
+    *(*relinquish_loader_info)(void *);
+
+  MagickBooleanType
+    loaded,
+    dirty;
+
   MagickBooleanType
     synchronize,
     debug;
@@ -209,11 +296,19 @@ typedef struct _CacheInfo
     id;
 
   ssize_t
-    reference_count;
+    reference_count,
+    file_references,
+    pins;
 
   SemaphoreInfo
     *semaphore,
-    *file_semaphore;
+    *file_semaphore,
+    *loader_semaphore;
+
+#if defined(MagickConcurrentDiskCache)
+  pthread_rwlock_t
+    *file_lock;
+#endif
 
   time_t
     timestamp;
@@ -229,7 +324,9 @@ extern MagickPrivate Cache
   AcquirePixelCache(const size_t),
   ClonePixelCache(const Cache),
   DestroyPixelCache(Cache),
-  ReferencePixelCache(Cache);
+  PinPixelCache(Cache),
+  ReferencePixelCache(Cache),
+  UnpinPixelCache(Cache);
 
 extern MagickPrivate ClassType
   GetPixelCacheStorageClass(const Cache);
@@ -243,15 +340,24 @@ extern MagickPrivate const Quantum
     ExceptionInfo *) magick_hot_spot,
   *GetVirtualPixelsNexus(const Cache,NexusInfo *magick_restrict);
 
+extern MagickPrivate const unsigned char
+  *GetVirtualCharPixelQueue(const Image *),
+  *GetVirtualCharPixels(const Image *,const ssize_t,const ssize_t,
+    const size_t);
+
 extern MagickPrivate const void
   *AcquirePixelCachePixels(const Image *,MagickSizeType *,ExceptionInfo *),
   *GetVirtualMetacontentFromNexus(const Cache,NexusInfo *magick_restrict);
 
 extern MagickPrivate MagickBooleanType
   CacheComponentGenesis(void),
+  SetPixelCacheLoader(Image *,LoadPixelHandler,void *,void *(*)(void *),
+    const MagickBooleanType),
+  SetPixelCacheType(Image *,const CacheType),
   SyncAuthenticPixelCacheNexus(Image *,NexusInfo *magick_restrict,
     ExceptionInfo *) magick_hot_spot,
-  SyncImagePixelCache(Image *,ExceptionInfo *);
+  SyncImagePixelCache(Image *,ExceptionInfo *),
+  UnloadPixelCache(Cache);
 
 extern MagickPrivate MagickSizeType
   GetPixelCacheNexusExtent(const Cache,NexusInfo *magick_restrict);
@@ -67,6 +67,9 @@ struct _CacheView
   Image
     *image;
 
+  Cache
+    pin;
+
   VirtualPixelMethod
     virtual_pixel_method;
 
@@ -172,6 +175,7 @@ MagickExport CacheView *AcquireVirtualCacheView(const Image *image,
   if (cache_view->number_threads == 0)
     cache_view->number_threads=1;
   cache_view->nexus_info=AcquirePixelCacheNexus(cache_view->number_threads);
+  cache_view->pin=PinPixelCache(image->cache);
   cache_view->virtual_pixel_method=GetImageVirtualPixelMethod(image);
   cache_view->debug=IsEventLogging();
   cache_view->signature=MagickCoreSignature;
@@ -220,6 +224,7 @@ MagickExport CacheView *CloneCacheView(const CacheView *cache_view)
   clone_view->image=ReferenceImage(cache_view->image);
   clone_view->number_threads=cache_view->number_threads;
   clone_view->nexus_info=AcquirePixelCacheNexus(cache_view->number_threads);
+  clone_view->pin=PinPixelCache(cache_view->image->cache);
   clone_view->virtual_pixel_method=cache_view->virtual_pixel_method;
   clone_view->debug=cache_view->debug;
   clone_view->signature=MagickCoreSignature;
@@ -259,6 +264,8 @@ MagickExport CacheView *DestroyCacheView(CacheView *cache_view)
   if (cache_view->nexus_info != (NexusInfo **) NULL)
     cache_view->nexus_info=DestroyPixelCacheNexus(cache_view->nexus_info,
       cache_view->number_threads);
+  if (cache_view->pin != (Cache) NULL)
+    cache_view->pin=UnpinPixelCache(cache_view->pin);
   cache_view->image=DestroyImage(cache_view->image);
   cache_view->signature=(~MagickCoreSignature);
   cache_view=(CacheView *) RelinquishAlignedMemory(cache_view);
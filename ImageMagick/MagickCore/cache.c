@@ -41,6 +41,7 @@
   Include declarations.
 */
 #include "studio.h"
+#include "artifact.h"
 #include "blob.h"
 #include "blob-private.h"
 #include "cache.h"
@@ -63,6 +64,7 @@
 #include "pixel-accessor.h"
 #include "policy.h"
 #include "quantum.h"
+#include "quantum-private.h"
 #include "random_.h"
 #include "registry.h"
 #include "resource_.h"
@@ -71,22 +73,65 @@
 #include "string_.h"
 #include "string-private.h"
 #include "thread-private.h"
+#include "timer.h"
 #include "utility.h"
 #include "utility-private.h"
 #if defined(MAGICKCORE_ZLIB_DELEGATE)
 #include "zlib.h"
 #endif
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
 
 /*
   Define declarations.
 */
+#if defined(__clang__) || (__GNUC__ > 4) || \
+    ((__GNUC__ == 4) && (__GNUC_MINOR__ > 6))
+#define CacheStatistic(cache_info,member,value) \
+{ \
+  if ((cache_info)->statistics != (CacheStatistics *) NULL) \
+    (void) __atomic_fetch_add(&(cache_info)->statistics->member,(value), \
+      __ATOMIC_RELAXED); \
+}
+#else
+#define CacheStatistic(cache_info,member,value) \
+{ \
+  if ((cache_info)->statistics != (CacheStatistics *) NULL) \
+    { \
+      LockSemaphoreInfo((cache_info)->statistics_semaphore); \
+      (cache_info)->statistics->member+=(value); \
+      UnlockSemaphoreInfo((cache_info)->statistics_semaphore); \
+    } \
+}
+#endif
 #define CacheTick(offset,extent)  QuantumTick((MagickOffsetType) offset,extent)
+#define CacheBandExtent  262144UL
+#define CacheHugePageExtent  2097152UL
+#define CacheReadAheadRows  64
+#define CachePoolEntries  32
+#define CachePoolIdle  5
+#define CachePoolThreshold  262144UL
+#define CacheTileExtent  128
 #define IsFileDescriptorLimitExceeded() (GetMagickResource(FileResource) > \
   GetMagickResourceLimit(FileResource) ? MagickTrue : MagickFalse)
 
 /*
   Typedef declarations.
 */
+typedef struct _CachePoolInfo
+{
+  void
+    *memory;
+
+  size_t
+    length;
+
+  time_t
+    timestamp;
+} CachePoolInfo;
+
 typedef struct _MagickModulo
 {
   ssize_t
@@ -119,6 +164,7 @@ static MagickBooleanType
   GetOneVirtualPixelFromCache(const Image *,const VirtualPixelMethod,
     const ssize_t,const ssize_t,Quantum *,ExceptionInfo *),
   OpenPixelCache(Image *,const MapMode,ExceptionInfo *),
+  OpenPixelCacheFile(CacheInfo *,const MapMode),
   OpenPixelCacheOnDisk(CacheInfo *,const MapMode),
   ReadPixelCachePixels(CacheInfo *magick_restrict,NexusInfo *magick_restrict,
     ExceptionInfo *),
@@ -157,10 +203,22 @@ static SemaphoreInfo
   *cache_semaphore = (SemaphoreInfo *) NULL;
 
 static ssize_t
-  cache_anonymous_memory = (-1);
+  cache_anonymous_memory = (-1),
+  cache_huge_pages = 0,
+  cache_numa_placement = 0;
 
 static time_t
   cache_epoch = 0;
+
+static CachePoolInfo
+  cache_pool[CachePoolEntries];
+
+static MagickSizeType
+  cache_pool_extent = 0,
+  cache_pool_limit = 0;
+
+static MagickBooleanType
+  cache_pool_initialized = MagickFalse;
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -226,6 +284,14 @@ MagickPrivate Cache AcquirePixelCache(const size_t number_threads)
   cache_info->semaphore=AcquireSemaphoreInfo();
   cache_info->reference_count=1;
   cache_info->file_semaphore=AcquireSemaphoreInfo();
+#if defined(MagickConcurrentDiskCache)
+  cache_info->file_lock=(pthread_rwlock_t *) AcquireMagickMemory(
+    sizeof(*cache_info->file_lock));
+  if (cache_info->file_lock == (pthread_rwlock_t *) NULL)
+    ThrowFatalException(ResourceLimitFatalError,"MemoryAllocationFailed");
+  (void) pthread_rwlock_init(cache_info->file_lock,
+    (const pthread_rwlockattr_t *) NULL);
+#endif
   cache_info->debug=IsEventLogging();
   cache_info->signature=MagickCoreSignature;
   return((Cache ) cache_info);
@@ -322,10 +388,147 @@ MagickPrivate const void *AcquirePixelCachePixels(const Image *image,
   *length=0;
   if ((cache_info->type != MemoryCache) && (cache_info->type != MapCache))
     return((const void *) NULL);
+  if ((cache_info->tile_columns != 0) || (cache_info->storage_depth != 0))
+    return((const void *) NULL);
   *length=cache_info->length;
   return((const void *) cache_info->pixels);
 }
 
+/*
+  The pixel cache pool recycles large heap buffers released by pixel caches
+  and nexus staging areas so that an image of the same geometry acquired soon
+  after reuses warm memory rather than faulting in fresh pages.  Buffers are
+  matched by exact length, are released after CachePoolIdle seconds of
+  disuse, and are only retained while the memory resource has headroom for
+  them.  The cache semaphore must be held by the caller of the helpers that
+  do not lock it themselves.
+*/
+static void TrimPixelCachePool(const time_t timestamp)
+{
+  register ssize_t
+    i;
+
+  for (i=0; i < (ssize_t) CachePoolEntries; i++)
+  {
+    if (cache_pool[i].memory == (void *) NULL)
+      continue;
+    if ((timestamp != 0) &&
+        ((timestamp-cache_pool[i].timestamp) < (time_t) CachePoolIdle))
+      continue;
+    cache_pool[i].memory=RelinquishAlignedMemory(cache_pool[i].memory);
+    cache_pool_extent-=cache_pool[i].length;
+    cache_pool[i].length=0;
+  }
+}
+
+static void InitializePixelCachePool(void)
+{
+  char
+    *value;
+
+  if (cache_pool_initialized != MagickFalse)
+    return;
+  cache_pool_limit=GetMagickResourceLimit(MemoryResource)/8;
+  value=GetEnvironmentValue("MAGICK_CACHE_POOL");
+  if (value == (char *) NULL)
+    value=GetPolicyValue("cache:pool");
+  if (value != (char *) NULL)
+    {
+      cache_pool_limit=(MagickSizeType) SiPrefixToDoubleInterval(value,
+        (double) GetMagickResourceLimit(MemoryResource));
+      value=DestroyString(value);
+    }
+  cache_pool_initialized=MagickTrue;
+}
+
+static void *AcquirePixelCachePoolMemory(const size_t length)
+{
+  register ssize_t
+    i;
+
+  void
+    *memory;
+
+  if (length < CachePoolThreshold)
+    return(AcquireAlignedMemory(1,length));
+  memory=(void *) NULL;
+  if (cache_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&cache_semaphore);
+  LockSemaphoreInfo(cache_semaphore);
+  TrimPixelCachePool(time((time_t *) NULL));
+  for (i=0; i < (ssize_t) CachePoolEntries; i++)
+    if ((cache_pool[i].memory != (void *) NULL) &&
+        (cache_pool[i].length == length))
+      {
+        memory=cache_pool[i].memory;
+        cache_pool[i].memory=(void *) NULL;
+        cache_pool[i].length=0;
+        cache_pool_extent-=length;
+        break;
+      }
+  UnlockSemaphoreInfo(cache_semaphore);
+  if (memory == (void *) NULL)
+    memory=AcquireAlignedMemory(1,length);
+  return(memory);
+}
+
+static void *RelinquishPixelCachePoolMemory(void *memory,const size_t length)
+{
+  MagickSizeType
+    limit;
+
+  register ssize_t
+    i;
+
+  ssize_t
+    j;
+
+  time_t
+    timestamp;
+
+  if ((memory == (void *) NULL) || (length < CachePoolThreshold))
+    return(RelinquishAlignedMemory(memory));
+  if (cache_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&cache_semaphore);
+  LockSemaphoreInfo(cache_semaphore);
+  InitializePixelCachePool();
+  timestamp=time((time_t *) NULL);
+  TrimPixelCachePool(timestamp);
+  limit=GetMagickResourceLimit(MemoryResource);
+  if (((cache_pool_extent+length) <= cache_pool_limit) &&
+      ((GetMagickResource(MemoryResource)+cache_pool_extent+length) <= limit))
+    {
+      /*
+        Retain the buffer, displacing the least recently released one.
+      */
+      j=0;
+      for (i=0; i < (ssize_t) CachePoolEntries; i++)
+      {
+        if (cache_pool[i].memory == (void *) NULL)
+          {
+            j=i;
+            break;
+          }
+        if (cache_pool[i].timestamp < cache_pool[j].timestamp)
+          j=i;
+      }
+      if (cache_pool[j].memory != (void *) NULL)
+        {
+          cache_pool[j].memory=RelinquishAlignedMemory(cache_pool[j].memory);
+          cache_pool_extent-=cache_pool[j].length;
+        }
+      cache_pool[j].memory=memory;
+      cache_pool[j].length=length;
+      cache_pool[j].timestamp=timestamp;
+      cache_pool_extent+=length;
+      memory=(void *) NULL;
+    }
+  UnlockSemaphoreInfo(cache_semaphore);
+  if (memory != (void *) NULL)
+    memory=RelinquishAlignedMemory(memory);
+  return(memory);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -374,6 +577,8 @@ MagickPrivate void CacheComponentTerminus(void)
   if (cache_semaphore == (SemaphoreInfo *) NULL)
     ActivateSemaphoreInfo(&cache_semaphore);
   LockSemaphoreInfo(cache_semaphore);
+  TrimPixelCachePool((time_t) 0);
+  cache_pool_initialized=MagickFalse;
   instantiate_cache=MagickFalse;
   UnlockSemaphoreInfo(cache_semaphore);
   RelinquishSemaphoreInfo(&cache_semaphore);
@@ -419,6 +624,8 @@ MagickPrivate Cache ClonePixelCache(const Cache cache)
   if (clone_info == (Cache) NULL)
     return((Cache) NULL);
   clone_info->virtual_pixel_method=cache_info->virtual_pixel_method;
+  if (cache_info->type == CompressedCache)
+    clone_info->type=CompressedCache;
   return((Cache ) clone_info);
 }
 
@@ -493,6 +700,518 @@ MagickPrivate void ClonePixelCacheMethods(Cache clone,const Cache cache)
 %
 */
 
+static inline void LockPixelCacheFile(
+  const CacheInfo *magick_restrict cache_info)
+{
+#if defined(MAGICKCORE_HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+  struct timespec
+    start,
+    stop;
+#else
+  TimerInfo
+    timer;
+#endif
+
+  /*
+    Lock the cache file semaphore, timing the wait if statistics are kept.
+    The wait is accumulated with the file semaphore held, which serializes
+    its updates.
+  */
+  if (cache_info->statistics == (CacheStatistics *) NULL)
+    {
+      LockSemaphoreInfo(cache_info->file_semaphore);
+      return;
+    }
+#if defined(MAGICKCORE_HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+  (void) clock_gettime(CLOCK_MONOTONIC,&start);
+  LockSemaphoreInfo(cache_info->file_semaphore);
+  (void) clock_gettime(CLOCK_MONOTONIC,&stop);
+  cache_info->statistics->lock_wait+=(double) (stop.tv_sec-start.tv_sec)+
+    (double) (stop.tv_nsec-start.tv_nsec)/1.0e9;
+#else
+  GetTimerInfo(&timer);
+  LockSemaphoreInfo(cache_info->file_semaphore);
+  cache_info->statistics->lock_wait+=GetElapsedTime(&timer);
+#endif
+}
+
+static inline void LockPixelCacheOnDisk(
+  const CacheInfo *magick_restrict cache_info)
+{
+  /*
+    Wait for disk transfers in flight to finish and keep new ones out while
+    the cache file is opened, closed, or copied.
+  */
+#if defined(MagickConcurrentDiskCache)
+  if (cache_info->file_lock != (pthread_rwlock_t *) NULL)
+    (void) pthread_rwlock_wrlock(cache_info->file_lock);
+#else
+  (void) cache_info;
+#endif
+}
+
+static inline void UnlockPixelCacheOnDisk(
+  const CacheInfo *magick_restrict cache_info)
+{
+#if defined(MagickConcurrentDiskCache)
+  if (cache_info->file_lock != (pthread_rwlock_t *) NULL)
+    (void) pthread_rwlock_unlock(cache_info->file_lock);
+#else
+  (void) cache_info;
+#endif
+}
+
+static inline size_t GetCacheBandPixels(
+  const CacheInfo *magick_restrict cache_info,const size_t band)
+{
+  size_t
+    rows;
+
+  rows=cache_info->band_info->rows;
+  if ((band+1)*rows > cache_info->rows)
+    rows=cache_info->rows-band*rows;
+  return(rows*cache_info->columns);
+}
+
+static inline void WriteCacheBandHeader(unsigned char *magick_restrict q,
+  const size_t count,const MagickBooleanType repeat)
+{
+  unsigned int
+    header;
+
+  header=(unsigned int) ((count << 1) | (repeat != MagickFalse ? 1 : 0));
+  (void) memcpy(q,&header,sizeof(header));
+}
+
+static size_t EncodeCacheBand(const CacheInfo *magick_restrict cache_info,
+  const Quantum *magick_restrict pixels,const size_t number_pixels,
+  unsigned char *magick_restrict buffer,const size_t extent)
+{
+#define MaxCacheBandRun  0x7fffffffUL
+
+  register const unsigned char
+    *magick_restrict p;
+
+  register size_t
+    i;
+
+  register unsigned char
+    *magick_restrict q;
+
+  size_t
+    literal,
+    packet_size,
+    run;
+
+  /*
+    Run-length encode the band a pixel at a time: each run is an unsigned int
+    header, the pixel count shifted left by one with the low bit set for a
+    repeat, followed by one pixel for a repeat or count pixels for a literal.
+    Returns zero if the encoding is no smaller than extent bytes.
+  */
+  packet_size=cache_info->number_channels*sizeof(Quantum);
+  p=(const unsigned char *) pixels;
+  q=buffer;
+  literal=0;
+  i=0;
+  while (i < number_pixels)
+  {
+    run=1;
+    while (((i+run) < number_pixels) && (run < MaxCacheBandRun) &&
+           (memcmp(p+i*packet_size,p+(i+run)*packet_size,packet_size) == 0))
+      run++;
+    if (((run-1)*packet_size <= sizeof(unsigned int)) &&
+        ((literal+run) < MaxCacheBandRun))
+      {
+        literal+=run;
+        i+=run;
+        continue;
+      }
+    if (literal != 0)
+      {
+        if ((size_t) (q-buffer)+sizeof(unsigned int)+literal*packet_size >=
+            extent)
+          return(0);
+        WriteCacheBandHeader(q,literal,MagickFalse);
+        q+=sizeof(unsigned int);
+        (void) memcpy(q,p+(i-literal)*packet_size,literal*packet_size);
+        q+=literal*packet_size;
+        literal=0;
+      }
+    if (run == 1)
+      {
+        literal=1;
+        i++;
+        continue;
+      }
+    if (run == number_pixels)
+      {
+        /*
+          A constant band is stored as its single pixel.
+        */
+        (void) memcpy(q,p,packet_size);
+        return(packet_size);
+      }
+    if ((size_t) (q-buffer)+sizeof(unsigned int)+packet_size >= extent)
+      return(0);
+    WriteCacheBandHeader(q,run,MagickTrue);
+    q+=sizeof(unsigned int);
+    (void) memcpy(q,p+i*packet_size,packet_size);
+    q+=packet_size;
+    i+=run;
+  }
+  if (literal != 0)
+    {
+      if ((size_t) (q-buffer)+sizeof(unsigned int)+literal*packet_size >=
+          extent)
+        return(0);
+      WriteCacheBandHeader(q,literal,MagickFalse);
+      q+=sizeof(unsigned int);
+      (void) memcpy(q,p+(i-literal)*packet_size,literal*packet_size);
+      q+=literal*packet_size;
+    }
+  return((size_t) (q-buffer));
+}
+
+static void DecodeCacheBand(const CacheInfo *magick_restrict cache_info,
+  const CacheBand *magick_restrict band,Quantum *magick_restrict pixels,
+  const size_t number_pixels)
+{
+  register const unsigned char
+    *magick_restrict p;
+
+  register size_t
+    i;
+
+  register unsigned char
+    *magick_restrict q;
+
+  size_t
+    packet_size;
+
+  /*
+    A band without a blob was never written and holds zeros, a one pixel
+    blob is a constant band, and a blob the size of the band is stored raw.
+  */
+  packet_size=cache_info->number_channels*sizeof(Quantum);
+  q=(unsigned char *) pixels;
+  if (band->blob == (CacheBlob *) NULL)
+    {
+      (void) ResetMagickMemory(q,0,number_pixels*packet_size);
+      return;
+    }
+  if (band->blob->extent == number_pixels*packet_size)
+    {
+      (void) memcpy(q,band->blob->data,band->blob->extent);
+      return;
+    }
+  if (band->blob->extent == packet_size)
+    {
+      for (i=0; i < number_pixels; i++)
+        (void) memcpy(q+i*packet_size,band->blob->data,packet_size);
+      return;
+    }
+  p=band->blob->data;
+  while (p < (band->blob->data+band->blob->extent))
+  {
+    size_t
+      count;
+
+    unsigned int
+      header;
+
+    (void) memcpy(&header,p,sizeof(header));
+    p+=sizeof(header);
+    count=(size_t) (header >> 1);
+    if ((header & 0x01) == 0)
+      {
+        (void) memcpy(q,p,count*packet_size);
+        p+=count*packet_size;
+        q+=count*packet_size;
+        continue;
+      }
+    for (i=0; i < count; i++)
+    {
+      (void) memcpy(q,p,packet_size);
+      q+=packet_size;
+    }
+    p+=packet_size;
+  }
+}
+
+static MagickBooleanType IsCacheBlobShared(CacheBlob *blob)
+{
+  MagickBooleanType
+    status;
+
+  LockSemaphoreInfo(blob->semaphore);
+  status=blob->reference_count != 1 ? MagickTrue : MagickFalse;
+  UnlockSemaphoreInfo(blob->semaphore);
+  return(status);
+}
+
+static CacheBlob *ReferenceCacheBlob(CacheBlob *blob)
+{
+  LockSemaphoreInfo(blob->semaphore);
+  blob->reference_count++;
+  UnlockSemaphoreInfo(blob->semaphore);
+  return(blob);
+}
+
+static CacheBlob *RelinquishCacheBlob(CacheBlob *blob)
+{
+  ssize_t
+    reference_count;
+
+  /*
+    Blobs are shared between a cache and its clones; the last reference
+    frees it.  Each blob counts its references under its own semaphore, so
+    unrelated caches do not contend.
+  */
+  LockSemaphoreInfo(blob->semaphore);
+  reference_count=(--blob->reference_count);
+  UnlockSemaphoreInfo(blob->semaphore);
+  if (reference_count != 0)
+    return((CacheBlob *) NULL);
+  RelinquishMagickResource(MemoryResource,blob->extent);
+  blob->data=(unsigned char *) RelinquishMagickMemory(blob->data);
+  RelinquishSemaphoreInfo(&blob->semaphore);
+  blob=(CacheBlob *) RelinquishMagickMemory(blob);
+  return(blob);
+}
+
+static MagickBooleanType CompressCacheBand(
+  CacheInfo *magick_restrict cache_info,CacheBand *magick_restrict band,
+  const size_t number_pixels)
+{
+  CacheBlob
+    *blob;
+
+  size_t
+    extent,
+    length;
+
+  /*
+    Replace the band blob with the encoding of its resident pixels.  A blob
+    still referenced by a clone is never modified in place.
+  */
+  length=number_pixels*cache_info->number_channels*sizeof(Quantum);
+  extent=EncodeCacheBand(cache_info,band->pixels,number_pixels,
+    cache_info->band_info->buffer,length);
+  if (extent == 0)
+    extent=length;
+  blob=band->blob;
+  if ((blob == (CacheBlob *) NULL) || (blob->extent != extent) ||
+      (IsCacheBlobShared(blob) != MagickFalse))
+    {
+      blob=(CacheBlob *) AcquireMagickMemory(sizeof(*blob));
+      if (blob == (CacheBlob *) NULL)
+        return(MagickFalse);
+      blob->data=(unsigned char *) AcquireQuantumMemory(extent,
+        sizeof(*blob->data));
+      if (blob->data == (unsigned char *) NULL)
+        {
+          blob=(CacheBlob *) RelinquishMagickMemory(blob);
+          return(MagickFalse);
+        }
+      (void) AcquireMagickResource(MemoryResource,extent);
+      blob->extent=extent;
+      blob->reference_count=1;
+      blob->semaphore=AcquireSemaphoreInfo();
+      if (band->blob != (CacheBlob *) NULL)
+        (void) RelinquishCacheBlob(band->blob);
+      band->blob=blob;
+    }
+  if (extent == length)
+    (void) memcpy(blob->data,band->pixels,length);
+  else
+    (void) memcpy(blob->data,cache_info->band_info->buffer,extent);
+  band->dirty=MagickFalse;
+  return(MagickTrue);
+}
+
+static Quantum *AcquireCacheBandPixels(CacheInfo *magick_restrict cache_info,
+  const size_t index,const MapMode mode,ExceptionInfo *exception)
+{
+  CacheBand
+    *magick_restrict band;
+
+  CacheBandInfo
+    *magick_restrict band_info;
+
+  Quantum
+    *pixels;
+
+  register size_t
+    i;
+
+  size_t
+    slot;
+
+  /*
+    Return the decompressed pixels of a band, evicting the least recently
+    used resident band if the resident set is full.  The caller holds the
+    cache file semaphore.
+  */
+  band_info=cache_info->band_info;
+  band=band_info->bands+index;
+  band->timestamp=(++band_info->timestamp);
+  if (mode != ReadMode)
+    band->dirty=MagickTrue;
+  if (band->pixels != (Quantum *) NULL)
+    return(band->pixels);
+  slot=band_info->number_resident;
+  if (band_info->number_resident < band_info->max_resident)
+    {
+      pixels=(Quantum *) AcquireAlignedMemory(band_info->rows*
+        cache_info->columns,cache_info->number_channels*sizeof(*pixels));
+      if (pixels == (Quantum *) NULL)
+        {
+          (void) ThrowMagickException(exception,GetMagickModule(),
+            ResourceLimitError,"MemoryAllocationFailed","`%s'",
+            cache_info->filename);
+          return((Quantum *) NULL);
+        }
+      band_info->number_resident++;
+    }
+  else
+    {
+      CacheBand
+        *magick_restrict victim;
+
+      slot=0;
+      for (i=1; i < band_info->number_resident; i++)
+        if (band_info->bands[band_info->resident[i]].timestamp <
+            band_info->bands[band_info->resident[slot]].timestamp)
+          slot=i;
+      victim=band_info->bands+band_info->resident[slot];
+      if ((victim->dirty != MagickFalse) && (CompressCacheBand(cache_info,
+           victim,GetCacheBandPixels(cache_info,band_info->resident[slot])) ==
+           MagickFalse))
+        {
+          (void) ThrowMagickException(exception,GetMagickModule(),
+            ResourceLimitError,"MemoryAllocationFailed","`%s'",
+            cache_info->filename);
+          return((Quantum *) NULL);
+        }
+      pixels=victim->pixels;
+      victim->pixels=(Quantum *) NULL;
+    }
+  band_info->resident[slot]=index;
+  DecodeCacheBand(cache_info,band,pixels,GetCacheBandPixels(cache_info,index));
+  band->pixels=pixels;
+  return(pixels);
+}
+
+static MagickBooleanType SyncCacheBands(CacheInfo *magick_restrict cache_info)
+{
+  CacheBandInfo
+    *magick_restrict band_info;
+
+  MagickBooleanType
+    status;
+
+  register size_t
+    i;
+
+  /*
+    Compress every dirty resident band so the blobs hold all the pixels.
+  */
+  band_info=cache_info->band_info;
+  status=MagickTrue;
+  for (i=0; i < band_info->number_resident; i++)
+  {
+    CacheBand
+      *magick_restrict band;
+
+    band=band_info->bands+band_info->resident[i];
+    if ((band->dirty != MagickFalse) && (CompressCacheBand(cache_info,band,
+         GetCacheBandPixels(cache_info,band_info->resident[i])) == MagickFalse))
+      status=MagickFalse;
+  }
+  return(status);
+}
+
+static CacheBandInfo *RelinquishCacheBands(CacheBandInfo *band_info)
+{
+  register size_t
+    i;
+
+  for (i=0; (band_info->bands != (CacheBand *) NULL) &&
+       (i < band_info->number_bands); i++)
+  {
+    CacheBand
+      *band;
+
+    band=band_info->bands+i;
+    if (band->pixels != (Quantum *) NULL)
+      band->pixels=(Quantum *) RelinquishAlignedMemory(band->pixels);
+    if (band->blob != (CacheBlob *) NULL)
+      band->blob=RelinquishCacheBlob(band->blob);
+  }
+  RelinquishMagickResource(MemoryResource,band_info->length);
+  if (band_info->buffer != (unsigned char *) NULL)
+    band_info->buffer=(unsigned char *) RelinquishMagickMemory(
+      band_info->buffer);
+  if (band_info->resident != (size_t *) NULL)
+    band_info->resident=(size_t *) RelinquishMagickMemory(band_info->resident);
+  if (band_info->bands != (CacheBand *) NULL)
+    band_info->bands=(CacheBand *) RelinquishMagickMemory(band_info->bands);
+  band_info=(CacheBandInfo *) RelinquishMagickMemory(band_info);
+  return(band_info);
+}
+
+static MagickBooleanType ClonePixelCacheBands(
+  CacheInfo *magick_restrict cache_info,CacheInfo *magick_restrict clone_info)
+{
+  CacheBandInfo
+    *magick_restrict band_info,
+    *magick_restrict clone_band_info;
+
+  MagickBooleanType
+    status;
+
+  register size_t
+    i;
+
+  /*
+    Clone compressed bands with identical morphology: the clone shares each
+    blob, copy-on-write, and starts with no resident bands.  Only the bands
+    either cache later writes are duplicated.
+  */
+  band_info=cache_info->band_info;
+  clone_band_info=clone_info->band_info;
+  if (band_info->rows != clone_band_info->rows)
+    return(MagickFalse);
+  for (i=0; i < clone_band_info->number_resident; i++)
+  {
+    CacheBand
+      *magick_restrict clone_band;
+
+    clone_band=clone_band_info->bands+clone_band_info->resident[i];
+    clone_band->pixels=(Quantum *) RelinquishAlignedMemory(clone_band->pixels);
+    clone_band->dirty=MagickFalse;
+  }
+  clone_band_info->number_resident=0;
+  LockPixelCacheFile(cache_info);
+  status=SyncCacheBands(cache_info);
+  for (i=0; (status != MagickFalse) && (i < band_info->number_bands); i++)
+  {
+    CacheBand
+      *magick_restrict band,
+      *magick_restrict clone_band;
+
+    band=band_info->bands+i;
+    clone_band=clone_band_info->bands+i;
+    if (clone_band->blob != (CacheBlob *) NULL)
+      clone_band->blob=RelinquishCacheBlob(clone_band->blob);
+    if (band->blob != (CacheBlob *) NULL)
+      clone_band->blob=ReferenceCacheBlob(band->blob);
+  }
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+  return(status);
+}
+
 static MagickBooleanType ClonePixelCacheOnDisk(
   CacheInfo *magick_restrict cache_info,CacheInfo *magick_restrict clone_info)
 {
@@ -512,11 +1231,18 @@ static MagickBooleanType ClonePixelCacheOnDisk(
     *buffer;
 
   /*
-    Clone pixel cache on disk with identical morphology.
+    Clone pixel cache on disk with identical morphology.  The copy uses the
+    file offsets, so neither cache admits transfers until it completes.
   */
-  if ((OpenPixelCacheOnDisk(cache_info,ReadMode) == MagickFalse) ||
-      (OpenPixelCacheOnDisk(clone_info,IOMode) == MagickFalse))
-    return(MagickFalse);
+  LockPixelCacheOnDisk(cache_info);
+  LockPixelCacheOnDisk(clone_info);
+  if ((OpenPixelCacheFile(cache_info,ReadMode) == MagickFalse) ||
+      (OpenPixelCacheFile(clone_info,IOMode) == MagickFalse))
+    {
+      UnlockPixelCacheOnDisk(clone_info);
+      UnlockPixelCacheOnDisk(cache_info);
+      return(MagickFalse);
+    }
   quantum=(size_t) MagickMaxBufferExtent;
   if ((fstat(cache_info->file,&file_stats) == 0) && (file_stats.st_size > 0))
     quantum=(size_t) MagickMin(file_stats.st_size,MagickMaxBufferExtent);
@@ -535,6 +1261,8 @@ static MagickBooleanType ClonePixelCacheOnDisk(
     extent+=number_bytes;
   }
   buffer=(unsigned char *) RelinquishMagickMemory(buffer);
+  UnlockPixelCacheOnDisk(clone_info);
+  UnlockPixelCacheOnDisk(cache_info);
   if (extent != cache_info->length)
     return(MagickFalse);
   return(MagickTrue);
@@ -576,7 +1304,10 @@ static MagickBooleanType ClonePixelCacheRepository(
       (cache_info->rows == clone_info->rows) &&
       (cache_info->number_channels == clone_info->number_channels) &&
       (memcmp(cache_info->channel_map,clone_info->channel_map,length) == 0) &&
-      (cache_info->metacontent_extent == clone_info->metacontent_extent))
+      (cache_info->metacontent_extent == clone_info->metacontent_extent) &&
+      (cache_info->tile_columns == clone_info->tile_columns) &&
+      (cache_info->tile_rows == clone_info->tile_rows) &&
+      (cache_info->storage_depth == clone_info->storage_depth))
     {
       /*
         Identical pixel cache morphology.
@@ -588,7 +1319,8 @@ static MagickBooleanType ClonePixelCacheRepository(
         {
           (void) memcpy(clone_info->pixels,cache_info->pixels,
             cache_info->columns*cache_info->number_channels*cache_info->rows*
-            sizeof(*cache_info->pixels));
+            (cache_info->storage_depth != 0 ? sizeof(unsigned char) :
+            sizeof(*cache_info->pixels)));
           if ((cache_info->metacontent_extent != 0) &&
               (clone_info->metacontent_extent != 0))
             (void) memcpy(clone_info->metacontent,cache_info->metacontent,
@@ -598,6 +1330,17 @@ static MagickBooleanType ClonePixelCacheRepository(
         }
       if ((cache_info->type == DiskCache) && (clone_info->type == DiskCache))
         return(ClonePixelCacheOnDisk(cache_info,clone_info));
+      if ((cache_info->type == CompressedCache) &&
+          (clone_info->type == CompressedCache) &&
+          (ClonePixelCacheBands(cache_info,clone_info) != MagickFalse))
+        {
+          if ((cache_info->metacontent_extent != 0) &&
+              (clone_info->metacontent_extent != 0))
+            (void) memcpy(clone_info->metacontent,cache_info->metacontent,
+              cache_info->columns*cache_info->rows*
+              clone_info->metacontent_extent*sizeof(unsigned char));
+          return(MagickTrue);
+        }
     }
   /*
     Mismatched pixel cache morphology.
@@ -848,6 +1591,7 @@ MagickExport void DestroyImagePixels(Image *image)
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  DestroyPixelCache() deallocates memory associated with the pixel cache.
+%  A cache still pinned by a cache view is freed by its last UnpinPixelCache().
 %
 %  The format of the DestroyPixelCache() method is:
 %
@@ -859,7 +1603,7 @@ MagickExport void DestroyImagePixels(Image *image)
 %
 */
 
-static MagickBooleanType ClosePixelCacheOnDisk(CacheInfo *cache_info)
+static MagickBooleanType ClosePixelCacheFile(CacheInfo *cache_info)
 {
   int
     status;
@@ -874,6 +1618,17 @@ static MagickBooleanType ClosePixelCacheOnDisk(CacheInfo *cache_info)
   return(status == -1 ? MagickFalse : MagickTrue);
 }
 
+static MagickBooleanType ClosePixelCacheOnDisk(CacheInfo *cache_info)
+{
+  MagickBooleanType
+    status;
+
+  LockPixelCacheOnDisk(cache_info);
+  status=ClosePixelCacheFile(cache_info);
+  UnlockPixelCacheOnDisk(cache_info);
+  return(status);
+}
+
 static inline void RelinquishPixelCachePixels(CacheInfo *cache_info)
 {
   switch (cache_info->type)
@@ -890,8 +1645,8 @@ static inline void RelinquishPixelCachePixels(CacheInfo *cache_info)
         }
 #endif
       if (cache_info->mapped == MagickFalse)
-        cache_info->pixels=(Quantum *) RelinquishAlignedMemory(
-          cache_info->pixels);
+        cache_info->pixels=(Quantum *) RelinquishPixelCachePoolMemory(
+          cache_info->pixels,(size_t) cache_info->length);
       else
         (void) UnmapBlob(cache_info->pixels,(size_t) cache_info->length);
       RelinquishMagickResource(MemoryResource,cache_info->length);
@@ -923,6 +1678,15 @@ static inline void RelinquishPixelCachePixels(CacheInfo *cache_info)
         cache_info->server_info);
       break;
     }
+    case CompressedCache:
+    {
+      if (cache_info->band_info != (CacheBandInfo *) NULL)
+        cache_info->band_info=RelinquishCacheBands(cache_info->band_info);
+      if (cache_info->metacontent != (void *) NULL)
+        cache_info->metacontent=RelinquishAlignedMemory(
+          cache_info->metacontent);
+      break;
+    }
     default:
       break;
   }
@@ -931,25 +1695,8 @@ static inline void RelinquishPixelCachePixels(CacheInfo *cache_info)
   cache_info->metacontent=(void *) NULL;
 }
 
-MagickPrivate Cache DestroyPixelCache(Cache cache)
+static void RelinquishPixelCacheInfo(CacheInfo *cache_info)
 {
-  CacheInfo
-    *magick_restrict cache_info;
-
-  assert(cache != (Cache) NULL);
-  cache_info=(CacheInfo *) cache;
-  assert(cache_info->signature == MagickCoreSignature);
-  if (cache_info->debug != MagickFalse)
-    (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",
-      cache_info->filename);
-  LockSemaphoreInfo(cache_info->semaphore);
-  cache_info->reference_count--;
-  if (cache_info->reference_count != 0)
-    {
-      UnlockSemaphoreInfo(cache_info->semaphore);
-      return((Cache) NULL);
-    }
-  UnlockSemaphoreInfo(cache_info->semaphore);
   if (cache_info->debug != MagickFalse)
     {
       char
@@ -960,6 +1707,9 @@ MagickPrivate Cache DestroyPixelCache(Cache cache)
       (void) LogMagickEvent(CacheEvent,GetMagickModule(),"%s",message);
     }
   RelinquishPixelCachePixels(cache_info);
+  if (cache_info->relinquish_loader_info != (void *(*)(void *)) NULL)
+    cache_info->loader_info=cache_info->relinquish_loader_info(
+      cache_info->loader_info);
   if (cache_info->server_info != (DistributeCacheInfo *) NULL)
     cache_info->server_info=DestroyDistributeCacheInfo((DistributeCacheInfo *)
       cache_info->server_info);
@@ -968,12 +1718,62 @@ MagickPrivate Cache DestroyPixelCache(Cache cache)
       cache_info->number_threads);
   if (cache_info->random_info != (RandomInfo *) NULL)
     cache_info->random_info=DestroyRandomInfo(cache_info->random_info);
+  if (cache_info->statistics != (CacheStatistics *) NULL)
+    {
+      if (cache_info->debug != MagickFalse)
+        (void) LogMagickEvent(CacheEvent,GetMagickModule(),
+          "statistics %s (%.20g requests, %.20g direct, %.20g staged, "
+          "%.20g virtual, %.20g bytes read, %.20g bytes written, %gs lock "
+          "wait)",cache_info->filename,(double)
+          cache_info->statistics->nexus_requests,(double)
+          cache_info->statistics->direct_regions,(double)
+          cache_info->statistics->staged_regions,(double)
+          cache_info->statistics->virtual_pixels,(double)
+          cache_info->statistics->bytes_read,(double)
+          cache_info->statistics->bytes_written,
+          cache_info->statistics->lock_wait);
+      RelinquishSemaphoreInfo(&cache_info->statistics_semaphore);
+      cache_info->statistics=(CacheStatistics *) RelinquishMagickMemory(
+        cache_info->statistics);
+    }
   if (cache_info->file_semaphore != (SemaphoreInfo *) NULL)
     RelinquishSemaphoreInfo(&cache_info->file_semaphore);
+#if defined(MagickConcurrentDiskCache)
+  if (cache_info->file_lock != (pthread_rwlock_t *) NULL)
+    {
+      (void) pthread_rwlock_destroy(cache_info->file_lock);
+      cache_info->file_lock=(pthread_rwlock_t *) RelinquishMagickMemory(
+        cache_info->file_lock);
+    }
+#endif
+  if (cache_info->loader_semaphore != (SemaphoreInfo *) NULL)
+    RelinquishSemaphoreInfo(&cache_info->loader_semaphore);
   if (cache_info->semaphore != (SemaphoreInfo *) NULL)
     RelinquishSemaphoreInfo(&cache_info->semaphore);
   cache_info->signature=(~MagickCoreSignature);
   cache_info=(CacheInfo *) RelinquishMagickMemory(cache_info);
+}
+
+MagickPrivate Cache DestroyPixelCache(Cache cache)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  assert(cache != (Cache) NULL);
+  cache_info=(CacheInfo *) cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  if (cache_info->debug != MagickFalse)
+    (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",
+      cache_info->filename);
+  LockSemaphoreInfo(cache_info->semaphore);
+  cache_info->reference_count--;
+  if ((cache_info->reference_count != 0) || (cache_info->pins != 0))
+    {
+      UnlockSemaphoreInfo(cache_info->semaphore);
+      return((Cache) NULL);
+    }
+  UnlockSemaphoreInfo(cache_info->semaphore);
+  RelinquishPixelCacheInfo(cache_info);
   cache=(Cache) NULL;
   return(cache);
 }
@@ -1007,7 +1807,8 @@ MagickPrivate Cache DestroyPixelCache(Cache cache)
 static inline void RelinquishCacheNexusPixels(NexusInfo *nexus_info)
 {
   if (nexus_info->mapped == MagickFalse)
-    (void) RelinquishAlignedMemory(nexus_info->cache);
+    (void) RelinquishPixelCachePoolMemory(nexus_info->cache,(size_t)
+      nexus_info->length);
   else
     (void) UnmapBlob(nexus_info->cache,(size_t) nexus_info->length);
   nexus_info->cache=(Quantum *) NULL;
@@ -1170,7 +1971,8 @@ MagickPrivate cl_mem GetAuthenticOpenCLBuffer(const Image *image,
   cache_info=(CacheInfo *) image->cache;
   if (cache_info->type == UndefinedCache)
     SyncImagePixelCache((Image *) image,exception);
-  if ((cache_info->type != MemoryCache) || (cache_info->mapped != MagickFalse))
+  if ((cache_info->type != MemoryCache) ||
+      (cache_info->mapped != MagickFalse) || (cache_info->storage_depth != 0))
     return((cl_mem) NULL);
   if ((cache_info->opencl != (MagickCLCacheInfo) NULL) &&
       (cache_info->opencl->device->context != device->context))
@@ -1574,6 +2376,62 @@ static inline MagickBooleanType ValidatePixelCacheMorphology(
   return(MagickTrue);
 }
 
+static inline MagickBooleanType IsPixelCacheLoaded(CacheInfo *cache_info)
+{
+  MagickBooleanType
+    loaded;
+
+  LockSemaphoreInfo(cache_info->semaphore);
+  loaded=cache_info->loaded;
+  UnlockSemaphoreInfo(cache_info->semaphore);
+  return(loaded);
+}
+
+static MagickBooleanType LoadPixelCache(Image *image,ExceptionInfo *exception)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  Image
+    *source_image;
+
+  MagickBooleanType
+    status;
+
+  /*
+    Fill a deferred pixel cache from its loader on first access.  The loader
+    runs under the loader lock only: it may unload other caches, which takes
+    their cache lock.
+  */
+  cache_info=(CacheInfo *) image->cache;
+  status=MagickTrue;
+  LockSemaphoreInfo(cache_info->loader_semaphore);
+  if (IsPixelCacheLoaded(cache_info) == MagickFalse)
+    {
+      source_image=cache_info->loader(image,cache_info->loader_info,exception);
+      status=source_image != (Image *) NULL ? MagickTrue : MagickFalse;
+      LockSemaphoreInfo(cache_info->semaphore);
+      if (status != MagickFalse)
+        {
+          status=OpenPixelCache(image,IOMode,exception);
+          if (status != MagickFalse)
+            status=ClonePixelCacheRepository(cache_info,(CacheInfo *)
+              source_image->cache,exception);
+          if (cache_info->type == DiskCache)
+            (void) ClosePixelCacheOnDisk(cache_info);
+          source_image=DestroyImage(source_image);
+        }
+      cache_info->loaded=MagickTrue;
+      cache_info->dirty=status == MagickFalse ? MagickTrue : MagickFalse;
+      UnlockSemaphoreInfo(cache_info->semaphore);
+      if ((cache_info->debug != MagickFalse) && (status != MagickFalse))
+        (void) LogMagickEvent(CacheEvent,GetMagickModule(),"load %s",
+          cache_info->filename);
+    }
+  UnlockSemaphoreInfo(cache_info->loader_semaphore);
+  return(status);
+}
+
 static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
   ExceptionInfo *exception)
 {
@@ -1613,6 +2471,17 @@ static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
   LockSemaphoreInfo(image->semaphore);
   assert(image->cache != (Cache) NULL);
   cache_info=(CacheInfo *) image->cache;
+  if (cache_info->loader != (LoadPixelHandler) NULL)
+    {
+      /*
+        Authentic access: fill a deferred cache and pin it in memory.
+      */
+      if (IsPixelCacheLoaded(cache_info) == MagickFalse)
+        status=LoadPixelCache(image,exception);
+      LockSemaphoreInfo(cache_info->semaphore);
+      cache_info->dirty=MagickTrue;
+      UnlockSemaphoreInfo(cache_info->semaphore);
+    }
 #if defined(MAGICKCORE_OPENCL_SUPPORT)
   CopyOpenCLBuffer(cache_info);
 #endif
@@ -1675,7 +2544,61 @@ static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
     return((Cache) NULL);
   return(image->cache);
 }
-
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   G e t I m a g e P i x e l C a c h e S t a t i s t i c s                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetImagePixelCacheStatistics() returns the access counters of the image
+%  pixel cache: nexus requests, regions accessed directly or through a staging
+%  buffer, requests that fell outside the image and took the virtual pixel
+%  path, bytes read from and written to the cache storage, and the time in
+%  seconds spent waiting on the cache file lock.  Counters are only kept if
+%  the cache was opened with -define cache:statistics=true or a policy of the
+%  same name; otherwise MagickFalse is returned and the counters are zero.
+%
+%  The format of the GetImagePixelCacheStatistics() method is:
+%
+%      MagickBooleanType GetImagePixelCacheStatistics(const Image *image,
+%        CacheStatistics *statistics)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o statistics: return the pixel cache statistics.
+%
+*/
+MagickExport MagickBooleanType GetImagePixelCacheStatistics(const Image *image,
+  CacheStatistics *statistics)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(image->cache != (Cache) NULL);
+  assert(statistics != (CacheStatistics *) NULL);
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  (void) ResetMagickMemory(statistics,0,sizeof(*statistics));
+  if (cache_info->statistics == (CacheStatistics *) NULL)
+    return(MagickFalse);
+  LockSemaphoreInfo(cache_info->file_semaphore);
+  LockSemaphoreInfo(cache_info->statistics_semaphore);
+  *statistics=(*cache_info->statistics);
+  UnlockSemaphoreInfo(cache_info->statistics_semaphore);
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+  return(MagickTrue);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1688,7 +2611,7 @@ static Cache GetImagePixelCache(Image *image,const MagickBooleanType clone,
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  GetImagePixelCacheType() returns the pixel cache type: UndefinedCache,
-%  DiskCache, MemoryCache, MapCache, or PingCache.
+%  DiskCache, MemoryCache, MapCache, CompressedCache, or PingCache.
 %
 %  The format of the GetImagePixelCacheType() method is:
 %
@@ -2193,6 +3116,8 @@ MagickPrivate void *GetPixelCachePixels(Image *image,MagickSizeType *length,
   *length=0;
   if ((cache_info->type != MemoryCache) && (cache_info->type != MapCache))
     return((void *) NULL);
+  if ((cache_info->tile_columns != 0) || (cache_info->storage_depth != 0))
+    return((void *) NULL);
   *length=cache_info->length;
   return((void *) cache_info->pixels);
 }
@@ -2274,6 +3199,15 @@ MagickPrivate void GetPixelCacheTileSize(const Image *image,size_t *width,
     (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
   cache_info=(CacheInfo *) image->cache;
   assert(cache_info->signature == MagickCoreSignature);
+  if (cache_info->tile_columns != 0)
+    {
+      /*
+        Tiles of a tile-major cache are contiguous.
+      */
+      *width=cache_info->tile_columns;
+      *height=cache_info->tile_rows;
+      return;
+    }
   *width=2048UL/(cache_info->number_channels*sizeof(Quantum));
   if (GetImagePixelCacheType(image) == DiskCache)
     *width=8192UL/(cache_info->number_channels*sizeof(Quantum));
@@ -2317,6 +3251,132 @@ MagickPrivate VirtualPixelMethod GetPixelCacheVirtualMethod(const Image *image)
   return(cache_info->virtual_pixel_method);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t V i r t u a l C h a r P i x e l Q u e u e                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetVirtualCharPixelQueue() returns the 8-bit samples behind the pixels
+%  last returned by GetVirtualPixels() for the image, as stored by a cache
+%  opened with -define cache:depth=8.  The samples of a pixel are in the
+%  order of the image channel map, and rows follow each other without
+%  padding.  NULL is returned if the cache does not keep 8-bit samples or
+%  the region is not a contiguous run of pixels inside the image.
+%
+%  The format of the GetVirtualCharPixelQueue() method is:
+%
+%      const unsigned char *GetVirtualCharPixelQueue(const Image *image)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+*/
+MagickPrivate const unsigned char *GetVirtualCharPixelQueue(
+  const Image *image)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  const int
+    id = GetOpenMPThreadId();
+
+  NexusInfo
+    *magick_restrict nexus_info;
+
+  assert(image != (const Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(image->cache != (Cache) NULL);
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  if (cache_info->storage_depth == 0)
+    return((const unsigned char *) NULL);
+  assert(id < (int) cache_info->number_threads);
+  nexus_info=cache_info->nexus_info[id];
+  if ((nexus_info->region.height != 1) &&
+      ((nexus_info->region.x != 0) ||
+       (nexus_info->region.width != cache_info->columns)))
+    return((const unsigned char *) NULL);
+  if (((nexus_info->region.y+(ssize_t) nexus_info->region.height) >
+       (ssize_t) cache_info->rows))
+    return((const unsigned char *) NULL);
+  return(GetVirtualCharPixels(image,nexus_info->region.x,
+    nexus_info->region.y,nexus_info->region.width));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t V i r t u a l C h a r P i x e l s                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetVirtualCharPixels() returns the 8-bit samples of a run of pixels in one
+%  row straight from a memory cache opened with -define cache:depth=8, so an
+%  8-bit consumer skips the expansion to Quantum and the narrowing back.
+%  The samples of a pixel are in the order of the image channel map.  NULL
+%  is returned if the cache does not keep 8-bit samples in memory, is not
+%  loaded, or the run is not inside the image; call GetVirtualPixels()
+%  instead.  Like the pixels returned by GetVirtualPixels() the samples must
+%  not be modified.
+%
+%  The format of the GetVirtualCharPixels() method is:
+%
+%      const unsigned char *GetVirtualCharPixels(const Image *image,
+%        const ssize_t x,const ssize_t y,const size_t columns)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o x,y,columns:  These values define the run of pixels.
+%
+*/
+MagickPrivate const unsigned char *GetVirtualCharPixels(const Image *image,
+  const ssize_t x,const ssize_t y,const size_t columns)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  MagickOffsetType
+    offset;
+
+  assert(image != (const Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(image->cache != (Cache) NULL);
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  if ((cache_info->storage_depth != 8) ||
+      (cache_info->type != MemoryCache) || (cache_info->tile_columns != 0) ||
+      (cache_info->methods.get_virtual_pixels_handler !=
+       GetVirtualPixelsCache))
+    return((const unsigned char *) NULL);
+  if ((cache_info->loader != (LoadPixelHandler) NULL) &&
+      (IsPixelCacheLoaded(cache_info) == MagickFalse))
+    return((const unsigned char *) NULL);
+  if ((cache_info->number_channels != GetPixelChannels(image)) ||
+      (cache_info->columns != image->columns) ||
+      (cache_info->rows != image->rows))
+    return((const unsigned char *) NULL);
+  if ((x < 0) || (y < 0) || (columns == 0) ||
+      ((x+(ssize_t) columns) > (ssize_t) cache_info->columns) ||
+      (y >= (ssize_t) cache_info->rows))
+    return((const unsigned char *) NULL);
+  offset=(MagickOffsetType) y*cache_info->columns+x;
+  return((const unsigned char *) cache_info->pixels+offset*
+    cache_info->number_channels);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -2630,6 +3690,10 @@ MagickPrivate const Quantum *GetVirtualPixelsFromNexus(const Image *image,
   assert(image->cache != (Cache) NULL);
   cache_info=(CacheInfo *) image->cache;
   assert(cache_info->signature == MagickCoreSignature);
+  if ((cache_info->loader != (LoadPixelHandler) NULL) &&
+      (IsPixelCacheLoaded(cache_info) == MagickFalse) &&
+      (LoadPixelCache((Image *) image,exception) == MagickFalse))
+    return((const Quantum *) NULL);
   if (cache_info->type == UndefinedCache)
     return((const Quantum *) NULL);
 #if defined(MAGICKCORE_OPENCL_SUPPORT)
@@ -2675,6 +3739,7 @@ MagickPrivate const Quantum *GetVirtualPixelsFromNexus(const Image *image,
   /*
     Pixel request is outside cache extents.
   */
+  CacheStatistic(cache_info,virtual_pixels,1);
   s=(unsigned char *) nexus_info->metacontent;
   virtual_nexus=AcquirePixelCacheNexus(1);
   if (virtual_nexus == (NexusInfo **) NULL)
@@ -3277,7 +4342,7 @@ static void CacheSignalHandler(int status)
 }
 #endif
 
-static MagickBooleanType OpenPixelCacheOnDisk(CacheInfo *cache_info,
+static MagickBooleanType OpenPixelCacheFile(CacheInfo *cache_info,
   const MapMode mode)
 {
   int
@@ -3320,11 +4385,79 @@ static MagickBooleanType OpenPixelCacheOnDisk(CacheInfo *cache_info,
     return(MagickFalse);
   (void) AcquireMagickResource(FileResource,1);
   if (cache_info->file != -1)
-    (void) ClosePixelCacheOnDisk(cache_info);
+    (void) ClosePixelCacheFile(cache_info);
   cache_info->file=file;
   return(MagickTrue);
 }
 
+static MagickBooleanType OpenPixelCacheOnDisk(CacheInfo *cache_info,
+  const MapMode mode)
+{
+  MagickBooleanType
+    status;
+
+  LockPixelCacheOnDisk(cache_info);
+  status=OpenPixelCacheFile(cache_info,mode);
+  UnlockPixelCacheOnDisk(cache_info);
+  return(status);
+}
+
+static MagickBooleanType AcquirePixelCacheOnDisk(CacheInfo *cache_info,
+  ExceptionInfo *exception)
+{
+  /*
+    Open the pixel cache on disk for a transfer.  With positional I/O each
+    transfer carries its own offset, so the file lock is only held while the
+    descriptor is opened and referenced; otherwise the shared file offset
+    requires the lock to be held until RelinquishPixelCacheOnDisk().  The
+    transfer holds the cache file open: it is not closed or reopened by
+    another thread until RelinquishPixelCacheOnDisk().
+  */
+#if defined(MagickConcurrentDiskCache)
+  if (cache_info->file_lock != (pthread_rwlock_t *) NULL)
+    (void) pthread_rwlock_rdlock(cache_info->file_lock);
+#endif
+  LockPixelCacheFile(cache_info);
+  if ((cache_info->file == -1) || (cache_info->file_references == 0))
+    if (OpenPixelCacheFile(cache_info,IOMode) == MagickFalse)
+      {
+        ThrowFileException(exception,FileOpenError,"UnableToOpenFile",
+          cache_info->cache_filename);
+        UnlockSemaphoreInfo(cache_info->file_semaphore);
+#if defined(MagickConcurrentDiskCache)
+        if (cache_info->file_lock != (pthread_rwlock_t *) NULL)
+          (void) pthread_rwlock_unlock(cache_info->file_lock);
+#endif
+        return(MagickFalse);
+      }
+#if defined(MagickConcurrentDiskCache)
+  cache_info->file_references++;
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+#endif
+  return(MagickTrue);
+}
+
+static void RelinquishPixelCacheOnDisk(CacheInfo *cache_info)
+{
+  /*
+    Release a transfer; the descriptor is only closed once it is idle.
+  */
+#if defined(MagickConcurrentDiskCache)
+  LockPixelCacheFile(cache_info);
+  cache_info->file_references--;
+  if ((cache_info->file_references == 0) &&
+      (IsFileDescriptorLimitExceeded() != MagickFalse))
+    (void) ClosePixelCacheFile(cache_info);
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+  if (cache_info->file_lock != (pthread_rwlock_t *) NULL)
+    (void) pthread_rwlock_unlock(cache_info->file_lock);
+#else
+  if (IsFileDescriptorLimitExceeded() != MagickFalse)
+    (void) ClosePixelCacheFile(cache_info);
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+#endif
+}
+
 static inline MagickOffsetType WritePixelCacheRegion(
   const CacheInfo *magick_restrict cache_info,const MagickOffsetType offset,
   const MagickSizeType length,const unsigned char *magick_restrict buffer)
@@ -3404,9 +4537,367 @@ static MagickBooleanType SetPixelCacheExtent(Image *image,MagickSizeType length)
       (void) signal(SIGBUS,CacheSignalHandler);
 #endif
     }
-  offset=(MagickOffsetType) lseek(cache_info->file,0,SEEK_SET);
-  if (offset < 0)
-    return(MagickFalse);
+  offset=(MagickOffsetType) lseek(cache_info->file,0,SEEK_SET);
+  if (offset < 0)
+    return(MagickFalse);
+  return(MagickTrue);
+}
+
+static void SetPixelCacheLayout(const Image *image,CacheInfo *cache_info)
+{
+  char
+    *policy;
+
+  const char
+    *option;
+
+  /*
+    A cache:layout of "tile" or "WxH" stores pixels in tile-major order.
+  */
+  cache_info->tile_columns=0;
+  cache_info->tile_rows=0;
+  policy=(char *) NULL;
+  option=GetImageArtifact(image,"cache:layout");
+  if (option == (const char *) NULL)
+    {
+      policy=GetPolicyValue("cache:layout");
+      option=policy;
+    }
+  if (option != (const char *) NULL)
+    {
+      if (LocaleCompare(option,"tile") == 0)
+        {
+          cache_info->tile_columns=CacheTileExtent;
+          cache_info->tile_rows=CacheTileExtent;
+        }
+      else
+        if (IsGeometry(option) != MagickFalse)
+          {
+            GeometryInfo
+              geometry_info;
+
+            MagickStatusType
+              flags;
+
+            flags=ParseGeometry(option,&geometry_info);
+            cache_info->tile_columns=(size_t) MagickMax(geometry_info.rho,0.0);
+            cache_info->tile_rows=cache_info->tile_columns;
+            if ((flags & SigmaValue) != 0)
+              cache_info->tile_rows=(size_t) MagickMax(geometry_info.sigma,
+                0.0);
+          }
+    }
+  if (policy != (char *) NULL)
+    policy=DestroyString(policy);
+  if ((cache_info->tile_columns == 0) || (cache_info->tile_rows == 0) ||
+      (cache_info->tile_columns >= cache_info->columns))
+    {
+      /*
+        Tiles as wide as the image are the row-major layout.
+      */
+      cache_info->tile_columns=0;
+      cache_info->tile_rows=0;
+    }
+}
+
+static void *AcquireHugePixelCacheMemory(const size_t length)
+{
+#if defined(MAGICKCORE_HAVE_MMAP) && defined(MAP_ANONYMOUS) && \
+    defined(MADV_HUGEPAGE)
+  size_t
+    extent,
+    head,
+    page_size,
+    tail;
+
+  unsigned char
+    *map,
+    *memory;
+
+  /*
+    Map a 2MB aligned anonymous region and let the kernel back it with
+    transparent huge pages.  The region is trimmed to the page rounded length
+    so that it is released like any other anonymous mapping.
+  */
+  page_size=(size_t) GetMagickPageSize();
+  extent=length+CacheHugePageExtent;
+  map=(unsigned char *) mmap((void *) NULL,extent,PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+  if (map == (unsigned char *) MAP_FAILED)
+    return((void *) NULL);
+  memory=(unsigned char *) (((size_t) map+CacheHugePageExtent-1) &
+    ~(CacheHugePageExtent-1));
+  head=(size_t) (memory-map);
+  if (head != 0)
+    (void) munmap(map,head);
+  tail=(length+page_size-1)/page_size*page_size;
+  if ((head+tail) < extent)
+    (void) munmap(memory+tail,extent-head-tail);
+  (void) madvise(memory,length,MADV_HUGEPAGE);
+  return((void *) memory);
+#else
+  magick_unreferenced(length);
+  return((void *) NULL);
+#endif
+}
+
+static MagickBooleanType InterleavePixelCachePixels(
+  const CacheInfo *magick_restrict cache_info)
+{
+#if defined(__linux__) && defined(SYS_mbind) && defined(MPOL_INTERLEAVE)
+  size_t
+    head,
+    page_size,
+    tail;
+
+  unsigned long
+    nodes;
+
+  /*
+    Ask the kernel to interleave the pages of the repository across all the
+    nodes this process may allocate from.  Only whole pages that belong to
+    the cache are bound.
+  */
+  page_size=(size_t) GetMagickPageSize();
+  head=((size_t) cache_info->pixels+page_size-1) & ~(page_size-1);
+  tail=((size_t) cache_info->pixels+(size_t) cache_info->length) &
+    ~(page_size-1);
+  if (tail <= head)
+    return(MagickFalse);
+  nodes=~0UL;
+  if (syscall(SYS_mbind,(void *) head,tail-head,MPOL_INTERLEAVE,&nodes,
+        8*sizeof(nodes),0) != 0)
+    return(MagickFalse);
+  return(MagickTrue);
+#else
+  magick_unreferenced(cache_info);
+  return(MagickFalse);
+#endif
+}
+
+static void PlacePixelCachePixels(const CacheInfo *magick_restrict cache_info)
+{
+  size_t
+    metacontent_extent,
+    pixel_extent;
+
+  ssize_t
+    y;
+
+  /*
+    Touch each row of a fresh memory cache from the thread that will later
+    process it, so first-touch NUMA policy places the rows local to that
+    thread.  The rows are split with the static,4 schedule and thread count
+    the pixel filters use.  Interleave binds the pages with MPOL_INTERLEAVE
+    where the kernel supports it, otherwise it touches one row at a time.
+  */
+  if ((cache_numa_placement > 1) &&
+      (InterleavePixelCachePixels(cache_info) != MagickFalse))
+    return;
+  pixel_extent=cache_info->columns*cache_info->number_channels*
+    (cache_info->storage_depth != 0 ? sizeof(unsigned char) : sizeof(Quantum));
+  metacontent_extent=cache_info->columns*cache_info->metacontent_extent;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static,cache_numa_placement > 1 ? 1 : 4) \
+    num_threads(MagickMax(1,MagickMin(GetMagickResourceLimit(ThreadResource), \
+      cache_info->rows/16)))
+#endif
+  for (y=0; y < (ssize_t) cache_info->rows; y++)
+  {
+    (void) ResetMagickMemory((unsigned char *) cache_info->pixels+y*
+      pixel_extent,0,pixel_extent);
+    if (cache_info->metacontent != (void *) NULL)
+      (void) ResetMagickMemory((unsigned char *) cache_info->metacontent+y*
+        metacontent_extent,0,metacontent_extent);
+  }
+}
+
+static void SetPixelCacheStorageDepth(const Image *image,
+  CacheInfo *cache_info)
+{
+#if (MAGICKCORE_QUANTUM_DEPTH > 8)
+  char
+    *policy;
+
+  const char
+    *option;
+#endif
+
+  /*
+    A cache:depth of 8 keeps a memory cache at 8 bits per channel and
+    converts at the nexus; it has no effect in a Q8 build.
+  */
+  cache_info->storage_depth=0;
+#if (MAGICKCORE_QUANTUM_DEPTH > 8)
+  policy=(char *) NULL;
+  option=GetImageArtifact(image,"cache:depth");
+  if (option == (const char *) NULL)
+    {
+      policy=GetPolicyValue("cache:depth");
+      option=policy;
+    }
+  if ((option != (const char *) NULL) && (StringToUnsignedLong(option) == 8))
+    cache_info->storage_depth=8;
+  if (policy != (char *) NULL)
+    policy=DestroyString(policy);
+#else
+  (void) image;
+#endif
+}
+
+static void SetPixelCacheStatistics(const Image *image,CacheInfo *cache_info)
+{
+  char
+    *policy;
+
+  const char
+    *option;
+
+  /*
+    A cache:statistics of true keeps access counters for this cache.
+  */
+  policy=(char *) NULL;
+  option=GetImageArtifact(image,"cache:statistics");
+  if (option == (const char *) NULL)
+    {
+      policy=GetPolicyValue("cache:statistics");
+      option=policy;
+    }
+  if ((option != (const char *) NULL) && (IsStringTrue(option) != MagickFalse))
+    {
+      cache_info->statistics=(CacheStatistics *) AcquireMagickMemory(
+        sizeof(*cache_info->statistics));
+      if (cache_info->statistics != (CacheStatistics *) NULL)
+        {
+          (void) ResetMagickMemory(cache_info->statistics,0,
+            sizeof(*cache_info->statistics));
+          cache_info->statistics_semaphore=AcquireSemaphoreInfo();
+        }
+    }
+  if (policy != (char *) NULL)
+    policy=DestroyString(policy);
+}
+
+static void SetPixelCacheReadAhead(const Image *image,CacheInfo *cache_info)
+{
+  char
+    *policy;
+
+  const char
+    *option;
+
+  /*
+    A cache:readahead of N rows (0 disables it) sets how far ahead of a
+    sequential reader a disk or map cache asks the kernel to fetch.
+  */
+  cache_info->readahead=CacheReadAheadRows;
+  policy=(char *) NULL;
+  option=GetImageArtifact(image,"cache:readahead");
+  if (option == (const char *) NULL)
+    {
+      policy=GetPolicyValue("cache:readahead");
+      option=policy;
+    }
+  if (option != (const char *) NULL)
+    cache_info->readahead=(size_t) StringToUnsignedLong(option);
+  if (policy != (char *) NULL)
+    policy=DestroyString(policy);
+}
+
+static MagickBooleanType AcquirePixelCacheBands(const Image *image,
+  CacheInfo *cache_info)
+{
+  CacheBandInfo
+    *band_info;
+
+  char
+    *policy;
+
+  const char
+    *option;
+
+  MagickSizeType
+    length;
+
+  size_t
+    band_length,
+    packet_size;
+
+  /*
+    A compressed cache holds rows in independently compressed bands of about
+    CacheBandExtent bytes, with at most a few bands decompressed at a time.
+    Only the decompressed bands and the meta-content are charged up front;
+    the blobs are charged to the memory resource as they are stored.
+  */
+  if (cache_info->type != CompressedCache)
+    {
+      policy=(char *) NULL;
+      option=GetImageArtifact(image,"cache:compress");
+      if (option == (const char *) NULL)
+        {
+          policy=GetPolicyValue("cache:compress");
+          option=policy;
+        }
+      if ((option == (const char *) NULL) ||
+          (IsStringTrue(option) == MagickFalse))
+        {
+          if (policy != (char *) NULL)
+            policy=DestroyString(policy);
+          return(MagickFalse);
+        }
+      if (policy != (char *) NULL)
+        policy=DestroyString(policy);
+    }
+  band_info=(CacheBandInfo *) AcquireMagickMemory(sizeof(*band_info));
+  if (band_info == (CacheBandInfo *) NULL)
+    return(MagickFalse);
+  (void) ResetMagickMemory(band_info,0,sizeof(*band_info));
+  packet_size=cache_info->number_channels*sizeof(Quantum);
+  band_info->rows=MagickMax(CacheBandExtent/(cache_info->columns*packet_size),
+    1);
+  band_info->rows=MagickMin(band_info->rows,cache_info->rows);
+  band_info->number_bands=(cache_info->rows+band_info->rows-1)/
+    band_info->rows;
+  band_info->max_resident=MagickMax(2*(size_t) GetMagickResourceLimit(
+    ThreadResource),8);
+  band_info->max_resident=MagickMin(band_info->max_resident,
+    band_info->number_bands);
+  band_length=band_info->rows*cache_info->columns*packet_size;
+  length=(MagickSizeType) band_info->max_resident*band_length+
+    (MagickSizeType) cache_info->columns*cache_info->rows*
+    cache_info->metacontent_extent;
+  band_info->length=length;
+  if (AcquireMagickResource(MemoryResource,length) == MagickFalse)
+    {
+      band_info=RelinquishCacheBands(band_info);
+      return(MagickFalse);
+    }
+  band_info->bands=(CacheBand *) AcquireQuantumMemory(band_info->number_bands,
+    sizeof(*band_info->bands));
+  if (band_info->bands != (CacheBand *) NULL)
+    (void) ResetMagickMemory(band_info->bands,0,band_info->number_bands*
+      sizeof(*band_info->bands));
+  band_info->resident=(size_t *) AcquireQuantumMemory(band_info->max_resident,
+    sizeof(*band_info->resident));
+  band_info->buffer=(unsigned char *) AcquireQuantumMemory(band_length,
+    sizeof(*band_info->buffer));
+  cache_info->metacontent=(void *) NULL;
+  if (cache_info->metacontent_extent != 0)
+    cache_info->metacontent=AcquireAlignedMemory(cache_info->columns*
+      cache_info->rows,cache_info->metacontent_extent);
+  if ((band_info->bands == (CacheBand *) NULL) ||
+      (band_info->resident == (size_t *) NULL) ||
+      (band_info->buffer == (unsigned char *) NULL) ||
+      ((cache_info->metacontent_extent != 0) &&
+       (cache_info->metacontent == (void *) NULL)))
+    {
+      if (cache_info->metacontent != (void *) NULL)
+        cache_info->metacontent=RelinquishAlignedMemory(
+          cache_info->metacontent);
+      band_info=RelinquishCacheBands(band_info);
+      return(MagickFalse);
+    }
+  cache_info->band_info=band_info;
   return(MagickTrue);
 }
 
@@ -3463,6 +4954,28 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
 #endif
         }
       value=DestroyString(value);
+      /*
+        Does the policy request huge pages or NUMA placement for memory cache?
+      */
+      value=GetPolicyValue("cache:huge-pages");
+      if (IsStringTrue(value) != MagickFalse)
+        {
+#if defined(MAGICKCORE_HAVE_MMAP) && defined(MAP_ANONYMOUS) && \
+    defined(MADV_HUGEPAGE)
+          cache_huge_pages=1;
+#else
+          (void) ThrowMagickException(exception,GetMagickModule(),
+            MissingDelegateError,"DelegateLibrarySupportNotBuiltIn",
+            "'%s' (policy requires huge pages)",image->filename);
+#endif
+        }
+      value=DestroyString(value);
+      value=GetPolicyValue("cache:numa");
+      if (LocaleCompare(value,"first-touch") == 0)
+        cache_numa_placement=1;
+      if (LocaleCompare(value,"interleave") == 0)
+        cache_numa_placement=2;
+      value=DestroyString(value);
     }
   if ((image->columns == 0) || (image->rows == 0))
     ThrowBinaryException(CacheError,"NoPixelsDefinedInCache",image->filename);
@@ -3474,6 +4987,12 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
       image->filename);
   source_info=(*cache_info);
   source_info.file=(-1);
+#if defined(MagickConcurrentDiskCache)
+  source_info.file_lock=(pthread_rwlock_t *) NULL;  /* private to this call */
+#endif
+  cache_info->band_info=(CacheBandInfo *) NULL;
+  cache_info->readahead=0;
+  cache_info->storage_depth=0;
   (void) FormatLocaleString(cache_info->filename,MagickPathExtent,"%s[%.20g]",
     image->filename,(double) GetImageIndexInList(image));
   cache_info->storage_class=image->storage_class;
@@ -3489,6 +5008,8 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
     sizeof(*image->channel_map));
   cache_info->metacontent_extent=image->metacontent_extent;
   cache_info->mode=mode;
+  if (cache_info->statistics == (CacheStatistics *) NULL)
+    SetPixelCacheStatistics(image,cache_info);
   number_pixels=(MagickSizeType) cache_info->columns*cache_info->rows;
   packet_size=cache_info->number_channels*sizeof(Quantum);
   if (image->metacontent_extent != 0)
@@ -3510,24 +5031,73 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
   status=AcquireMagickResource(AreaResource,cache_info->length);
   length=number_pixels*(cache_info->number_channels*sizeof(Quantum)+
     cache_info->metacontent_extent);
+  if ((status != MagickFalse) &&
+      (length == (MagickSizeType) ((size_t) length)) &&
+      ((cache_info->type == UndefinedCache) ||
+       (cache_info->type == CompressedCache)) &&
+      (AcquirePixelCacheBands(image,cache_info) != MagickFalse))
+    {
+      /*
+        Create compressed memory pixel cache.
+      */
+      cache_info->type=CompressedCache;
+      cache_info->mapped=MagickFalse;
+      cache_info->pixels=(Quantum *) NULL;
+      cache_info->tile_columns=0;
+      cache_info->tile_rows=0;
+      if ((source_info.storage_class != UndefinedClass) && (mode != ReadMode))
+        {
+          status=ClonePixelCacheRepository(cache_info,&source_info,exception);
+          RelinquishPixelCachePixels(&source_info);
+        }
+      if (image->debug != MagickFalse)
+        {
+          (void) FormatMagickSize(cache_info->length,MagickTrue,"B",
+            MagickPathExtent,format);
+          type=CommandOptionToMnemonic(MagickCacheOptions,(ssize_t)
+            cache_info->type);
+          (void) FormatLocaleString(message,MagickPathExtent,
+            "open %s (%s, %.20gx%.20gx%.20g %s, %.20g bands)",
+            cache_info->filename,type,(double) cache_info->columns,(double)
+            cache_info->rows,(double) cache_info->number_channels,format,
+            (double) cache_info->band_info->number_bands);
+          (void) LogMagickEvent(CacheEvent,GetMagickModule(),"%s",message);
+        }
+      return(status == 0 ? MagickFalse : MagickTrue);
+    }
   if ((status != MagickFalse) && (length == (MagickSizeType) ((size_t) length)))
     {
+      SetPixelCacheStorageDepth(image,cache_info);
+      if (cache_info->storage_depth != 0)
+        cache_info->length=number_pixels*(cache_info->number_channels+
+          cache_info->metacontent_extent);
       status=AcquireMagickResource(MemoryResource,cache_info->length);
       if (((cache_info->type == UndefinedCache) && (status != MagickFalse)) ||
           (cache_info->type == MemoryCache))
         {
           status=MagickTrue;
-          if (cache_anonymous_memory <= 0)
+          cache_info->pixels=(Quantum *) NULL;
+          if ((cache_huge_pages > 0) &&
+              (cache_info->length >= (MagickSizeType) CacheHugePageExtent))
             {
-              cache_info->mapped=MagickFalse;
-              cache_info->pixels=(Quantum *) MagickAssumeAligned(
-                AcquireAlignedMemory(1,(size_t) cache_info->length));
+              cache_info->mapped=MagickTrue;
+              cache_info->pixels=(Quantum *) AcquireHugePixelCacheMemory(
+                (size_t) cache_info->length);
             }
-          else
+          if (cache_info->pixels == (Quantum *) NULL)
             {
-              cache_info->mapped=MagickTrue;
-              cache_info->pixels=(Quantum *) MapBlob(-1,IOMode,0,(size_t)
-                cache_info->length);
+              if (cache_anonymous_memory <= 0)
+                {
+                  cache_info->mapped=MagickFalse;
+                  cache_info->pixels=(Quantum *) MagickAssumeAligned(
+                    AcquirePixelCachePoolMemory((size_t) cache_info->length));
+                }
+              else
+                {
+                  cache_info->mapped=MagickTrue;
+                  cache_info->pixels=(Quantum *) MapBlob(-1,IOMode,0,(size_t)
+                    cache_info->length);
+                }
             }
           if (cache_info->pixels == (Quantum *) NULL)
             cache_info->pixels=source_info.pixels;
@@ -3537,10 +5107,21 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
                 Create memory pixel cache.
               */
               cache_info->type=MemoryCache;
+              cache_info->tile_columns=0;
+              cache_info->tile_rows=0;
               cache_info->metacontent=(void *) NULL;
               if (cache_info->metacontent_extent != 0)
-                cache_info->metacontent=(void *) (cache_info->pixels+
-                  number_pixels*cache_info->number_channels);
+                {
+                  if (cache_info->storage_depth != 0)
+                    cache_info->metacontent=(void *) ((unsigned char *)
+                      cache_info->pixels+number_pixels*
+                      cache_info->number_channels);
+                  else
+                    cache_info->metacontent=(void *) (cache_info->pixels+
+                      number_pixels*cache_info->number_channels);
+                }
+              if (cache_numa_placement > 0)
+                PlacePixelCachePixels(cache_info);
               if ((source_info.storage_class != UndefinedClass) &&
                   (mode != ReadMode))
                 {
@@ -3567,6 +5148,8 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
             }
         }
       RelinquishMagickResource(MemoryResource,cache_info->length);
+      cache_info->storage_depth=0;
+      cache_info->length=number_pixels*packet_size;
     }
   /*
     Create pixel cache on disk.
@@ -3596,6 +5179,8 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
               */
               status=MagickTrue;
               cache_info->type=DistributedCache;
+              cache_info->tile_columns=0;
+              cache_info->tile_rows=0;
               cache_info->server_info=server_info;
               (void) FormatLocaleString(cache_info->cache_filename,
                 MagickPathExtent,"%s:%d",GetDistributeCacheHostname(
@@ -3638,6 +5223,9 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
       (void) ClosePixelCacheOnDisk(cache_info);
       *cache_info->cache_filename='\0';
     }
+  if (*cache_info->cache_filename == '\0')
+    SetPixelCacheLayout(image,cache_info);
+  SetPixelCacheReadAhead(image,cache_info);
   if (OpenPixelCacheOnDisk(cache_info,mode) == MagickFalse)
     {
       RelinquishMagickResource(DiskResource,cache_info->length);
@@ -3840,6 +5428,49 @@ MagickExport MagickBooleanType PersistPixelCache(Image *image,
   return(status);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   P i n P i x e l C a c h e                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  PinPixelCache() keeps a cache filled by its loader from being unloaded
+%  while a cache view is open on it.  A pin is counted apart from the cache
+%  references: it keeps the cache alive but does not make it shared, so
+%  authentic access through the view does not clone it.  It returns the
+%  pinned cache, or NULL if the cache has no loader and needs no pin.
+%  Release the pin with UnpinPixelCache().
+%
+%  The format of the PinPixelCache() method is:
+%
+%      Cache PinPixelCache(Cache cache)
+%
+%  A description of each parameter follows:
+%
+%    o cache: the pixel cache.
+%
+*/
+MagickPrivate Cache PinPixelCache(Cache cache)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  assert(cache != (Cache) NULL);
+  cache_info=(CacheInfo *) cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  if (cache_info->loader == (LoadPixelHandler) NULL)
+    return((Cache) NULL);
+  LockSemaphoreInfo(cache_info->semaphore);
+  cache_info->pins++;
+  UnlockSemaphoreInfo(cache_info->semaphore);
+  return(cache);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -4141,6 +5772,274 @@ static inline MagickOffsetType ReadPixelCacheRegion(
   return(i);
 }
 
+static MagickBooleanType TransferPixelCacheTiles(
+  CacheInfo *magick_restrict cache_info,NexusInfo *magick_restrict nexus_info,
+  const MapMode mode,ExceptionInfo *exception)
+{
+  MagickBooleanType
+    status;
+
+  MagickOffsetType
+    count;
+
+  MagickSizeType
+    packet_size;
+
+  register ssize_t
+    y;
+
+  size_t
+    number_channels;
+
+  ssize_t
+    tile_x,
+    tile_y;
+
+  unsigned char
+    *buffer;
+
+  /*
+    Move the nexus region to or from the tiles of a tile-major cache.  Tile
+    (tile_x,tile_y) is stored whole, its rows packed at the tile's width,
+    starting after every tile above and to the left of it.
+  */
+  number_channels=cache_info->number_channels;
+  packet_size=(MagickSizeType) number_channels*sizeof(Quantum);
+  buffer=(unsigned char *) NULL;
+  if (cache_info->type == DiskCache)
+    {
+      buffer=(unsigned char *) AcquireQuantumMemory(cache_info->tile_columns*
+        cache_info->tile_rows,(size_t) packet_size);
+      if (buffer == (unsigned char *) NULL)
+        {
+          (void) ThrowMagickException(exception,GetMagickModule(),
+            ResourceLimitError,"MemoryAllocationFailed","`%s'",
+            cache_info->filename);
+          return(MagickFalse);
+        }
+      if (AcquirePixelCacheOnDisk(cache_info,exception) == MagickFalse)
+        {
+          buffer=(unsigned char *) RelinquishMagickMemory(buffer);
+          return(MagickFalse);
+        }
+    }
+  status=MagickTrue;
+  for (tile_y=nexus_info->region.y/(ssize_t) cache_info->tile_rows;
+       (status != MagickFalse) && (tile_y*(ssize_t) cache_info->tile_rows <
+       nexus_info->region.y+(ssize_t) nexus_info->region.height); tile_y++)
+  {
+    size_t
+      height;
+
+    ssize_t
+      bottom,
+      top,
+      y_offset;
+
+    y_offset=tile_y*(ssize_t) cache_info->tile_rows;
+    height=MagickMin(cache_info->tile_rows,cache_info->rows-y_offset);
+    top=MagickMax(nexus_info->region.y,y_offset);
+    bottom=MagickMin(nexus_info->region.y+(ssize_t) nexus_info->region.height,
+      y_offset+(ssize_t) height);
+    for (tile_x=nexus_info->region.x/(ssize_t) cache_info->tile_columns;
+         (status != MagickFalse) && (tile_x*(ssize_t) cache_info->tile_columns <
+         nexus_info->region.x+(ssize_t) nexus_info->region.width); tile_x++)
+    {
+      MagickOffsetType
+        offset;
+
+      MagickSizeType
+        length;
+
+      register Quantum
+        *magick_restrict p;
+
+      size_t
+        rows,
+        width;
+
+      ssize_t
+        left,
+        right,
+        x_offset;
+
+      x_offset=tile_x*(ssize_t) cache_info->tile_columns;
+      width=MagickMin(cache_info->tile_columns,cache_info->columns-x_offset);
+      left=MagickMax(nexus_info->region.x,x_offset);
+      right=MagickMin(nexus_info->region.x+(ssize_t) nexus_info->region.width,
+        x_offset+(ssize_t) width);
+      offset=(MagickOffsetType) y_offset*cache_info->columns+x_offset*height+
+        (top-y_offset)*width+(left-x_offset);
+      length=(MagickSizeType) (right-left)*packet_size;
+      rows=(size_t) (bottom-top);
+      p=nexus_info->pixels+((top-nexus_info->region.y)*(ssize_t)
+        nexus_info->region.width+(left-nexus_info->region.x))*number_channels;
+      if (cache_info->type != DiskCache)
+        {
+          register Quantum
+            *magick_restrict q;
+
+          q=cache_info->pixels+offset*number_channels;
+          for (y=0; y < (ssize_t) rows; y++)
+          {
+            if (mode == ReadMode)
+              (void) memcpy(p,q,(size_t) length);
+            else
+              (void) memcpy(q,p,(size_t) length);
+            p+=nexus_info->region.width*number_channels;
+            q+=width*number_channels;
+          }
+          continue;
+        }
+      if ((right-left) == (ssize_t) width)
+        {
+          MagickSizeType
+            extent;
+
+          register unsigned char
+            *magick_restrict q;
+
+          /*
+            Full-width tile rows are contiguous: one transfer per tile.
+          */
+          extent=rows*length;
+          q=(nexus_info->region.width == width) ? (unsigned char *) p : buffer;
+          if ((mode != ReadMode) && (q == buffer))
+            for (y=0; y < (ssize_t) rows; y++)
+              (void) memcpy(q+y*length,p+y*nexus_info->region.width*
+                number_channels,(size_t) length);
+          if (mode == ReadMode)
+            count=ReadPixelCacheRegion(cache_info,cache_info->offset+offset*
+              packet_size,extent,q);
+          else
+            count=WritePixelCacheRegion(cache_info,cache_info->offset+offset*
+              packet_size,extent,q);
+          if (count != (MagickOffsetType) extent)
+            status=MagickFalse;
+          if ((mode == ReadMode) && (q == buffer))
+            for (y=0; y < (ssize_t) rows; y++)
+              (void) memcpy(p+y*nexus_info->region.width*number_channels,
+                q+y*length,(size_t) length);
+          continue;
+        }
+      if (mode == ReadMode)
+        {
+          MagickSizeType
+            extent;
+
+          /*
+            Read the span of the tile covering the region in one transfer.
+          */
+          extent=((rows-1)*width)*packet_size+length;
+          count=ReadPixelCacheRegion(cache_info,cache_info->offset+offset*
+            packet_size,extent,buffer);
+          if (count != (MagickOffsetType) extent)
+            {
+              status=MagickFalse;
+              continue;
+            }
+          for (y=0; y < (ssize_t) rows; y++)
+            (void) memcpy(p+y*nexus_info->region.width*number_channels,
+              buffer+y*width*packet_size,(size_t) length);
+          continue;
+        }
+      for (y=0; y < (ssize_t) rows; y++)
+      {
+        count=WritePixelCacheRegion(cache_info,cache_info->offset+(offset+y*
+          width)*packet_size,length,(const unsigned char *) (p+y*
+          nexus_info->region.width*number_channels));
+        if (count != (MagickOffsetType) length)
+          {
+            status=MagickFalse;
+            break;
+          }
+      }
+    }
+  }
+  if (cache_info->type == DiskCache)
+    {
+      RelinquishPixelCacheOnDisk(cache_info);
+      buffer=(unsigned char *) RelinquishMagickMemory(buffer);
+    }
+  return(status);
+}
+
+static MagickBooleanType TransferPixelCacheBands(
+  CacheInfo *magick_restrict cache_info,NexusInfo *magick_restrict nexus_info,
+  const MapMode mode,ExceptionInfo *exception)
+{
+  MagickBooleanType
+    status;
+
+  register Quantum
+    *magick_restrict p;
+
+  size_t
+    length,
+    number_channels;
+
+  ssize_t
+    y;
+
+  /*
+    Move the nexus region to or from the decompressed bands it overlaps.
+  */
+  number_channels=cache_info->number_channels;
+  length=nexus_info->region.width*number_channels*sizeof(Quantum);
+  p=nexus_info->pixels;
+  status=MagickTrue;
+  LockPixelCacheFile(cache_info);
+  for (y=nexus_info->region.y; y < (nexus_info->region.y+(ssize_t)
+       nexus_info->region.height); )
+  {
+    register Quantum
+      *magick_restrict q;
+
+    register ssize_t
+      i;
+
+    size_t
+      band,
+      rows;
+
+    band=(size_t) y/cache_info->band_info->rows;
+    q=AcquireCacheBandPixels(cache_info,band,mode,exception);
+    if (q == (Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    rows=(size_t) MagickMin((ssize_t) ((band+1)*cache_info->band_info->rows),
+      nexus_info->region.y+(ssize_t) nexus_info->region.height)-y;
+    q+=((y-(ssize_t) (band*cache_info->band_info->rows))*(ssize_t)
+      cache_info->columns+nexus_info->region.x)*(ssize_t) number_channels;
+    if (nexus_info->region.width == cache_info->columns)
+      {
+        /*
+          Full-width rows are contiguous within a band.
+        */
+        if (mode == ReadMode)
+          (void) memcpy(p,q,rows*length);
+        else
+          (void) memcpy(q,p,rows*length);
+        p+=rows*nexus_info->region.width*number_channels;
+      }
+    else
+      for (i=0; i < (ssize_t) rows; i++)
+      {
+        if (mode == ReadMode)
+          (void) memcpy(p,q,length);
+        else
+          (void) memcpy(q,p,length);
+        p+=nexus_info->region.width*number_channels;
+        q+=cache_info->columns*number_channels;
+      }
+    y+=(ssize_t) rows;
+  }
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+  return(status);
+}
+
 static MagickBooleanType ReadPixelCacheMetacontent(
   CacheInfo *magick_restrict cache_info,NexusInfo *magick_restrict nexus_info,
   ExceptionInfo *exception)
@@ -4178,6 +6077,7 @@ static MagickBooleanType ReadPixelCacheMetacontent(
   {
     case MemoryCache:
     case MapCache:
+    case CompressedCache:
     {
       register unsigned char
         *magick_restrict p;
@@ -4206,14 +6106,8 @@ static MagickBooleanType ReadPixelCacheMetacontent(
       /*
         Read meta content from disk.
       */
-      LockSemaphoreInfo(cache_info->file_semaphore);
-      if (OpenPixelCacheOnDisk(cache_info,IOMode) == MagickFalse)
-        {
-          ThrowFileException(exception,FileOpenError,"UnableToOpenFile",
-            cache_info->cache_filename);
-          UnlockSemaphoreInfo(cache_info->file_semaphore);
-          return(MagickFalse);
-        }
+      if (AcquirePixelCacheOnDisk(cache_info,exception) == MagickFalse)
+        return(MagickFalse);
       if ((cache_info->columns == nexus_info->region.width) &&
           (extent <= MagickMaxBufferExtent))
         {
@@ -4231,9 +6125,7 @@ static MagickBooleanType ReadPixelCacheMetacontent(
         offset+=cache_info->columns;
         q+=cache_info->metacontent_extent*nexus_info->region.width;
       }
-      if (IsFileDescriptorLimitExceeded() != MagickFalse)
-        (void) ClosePixelCacheOnDisk(cache_info);
-      UnlockSemaphoreInfo(cache_info->file_semaphore);
+      RelinquishPixelCacheOnDisk(cache_info);
       break;
     }
     case DistributedCache:
@@ -4244,25 +6136,23 @@ static MagickBooleanType ReadPixelCacheMetacontent(
       /*
         Read metacontent from distributed cache.
       */
-      LockSemaphoreInfo(cache_info->file_semaphore);
+      LockPixelCacheFile(cache_info);
       region=nexus_info->region;
-      if ((cache_info->columns != nexus_info->region.width) ||
-          (extent > MagickMaxBufferExtent))
+      if (extent > MagickMaxBufferExtent)
         region.height=1UL;
       else
         {
           length=extent;
           rows=1UL;
         }
-      for (y=0; y < (ssize_t) rows; y++)
-      {
+      if (rows == 1)
         count=ReadDistributePixelCacheMetacontent((DistributeCacheInfo *)
           cache_info->server_info,&region,length,(unsigned char *) q);
-        if (count != (MagickOffsetType) length)
-          break;
-        q+=cache_info->metacontent_extent*nexus_info->region.width;
-        region.y++;
-      }
+      else
+        count=ReadDistributeCacheMetacontentRows((DistributeCacheInfo *)
+          cache_info->server_info,&region,rows,length,(unsigned char *) q);
+      if (count == (MagickOffsetType) (rows*length))
+        y=(ssize_t) rows;
       UnlockSemaphoreInfo(cache_info->file_semaphore);
       break;
     }
@@ -4275,6 +6165,9 @@ static MagickBooleanType ReadPixelCacheMetacontent(
         cache_info->cache_filename);
       return(MagickFalse);
     }
+  CacheStatistic(cache_info,bytes_read,(MagickSizeType)
+    nexus_info->region.width*nexus_info->region.height*
+    cache_info->metacontent_extent);
   if ((cache_info->debug != MagickFalse) &&
       (CacheTick(nexus_info->region.y,cache_info->rows) != MagickFalse))
     (void) LogMagickEvent(CacheEvent,GetMagickModule(),
@@ -4349,6 +6242,21 @@ static MagickBooleanType ReadPixelCachePixels(
   extent=length*rows;
   if ((extent == 0) || ((extent/length) != rows))
     return(MagickFalse);
+  if (cache_info->tile_columns != 0)
+    {
+      /*
+        Assemble the region from the cache tiles it overlaps.
+      */
+      if (TransferPixelCacheTiles(cache_info,nexus_info,ReadMode,
+            exception) != MagickFalse)
+        {
+          CacheStatistic(cache_info,bytes_read,extent);
+          return(MagickTrue);
+        }
+      ThrowFileException(exception,CacheError,"UnableToReadPixelCache",
+        cache_info->cache_filename);
+      return(MagickFalse);
+    }
   y=0;
   q=nexus_info->pixels;
   switch (cache_info->type)
@@ -4362,6 +6270,28 @@ static MagickBooleanType ReadPixelCachePixels(
       /*
         Read pixels from memory.
       */
+      if (cache_info->storage_depth != 0)
+        {
+          register const unsigned char
+            *magick_restrict r;
+
+          register ssize_t
+            i;
+
+          /*
+            Expand the 8-bit samples of a compact repository.
+          */
+          r=(const unsigned char *) cache_info->pixels+offset*number_channels;
+          for (y=0; y < (ssize_t) rows; y++)
+          {
+            for (i=0; i < (ssize_t) (nexus_info->region.width*number_channels);
+                 i++)
+              q[i]=ScaleCharToQuantum(r[i]);
+            r+=cache_info->columns*number_channels;
+            q+=nexus_info->region.width*number_channels;
+          }
+          break;
+        }
       if ((cache_info->columns == nexus_info->region.width) &&
           (extent == (MagickSizeType) ((size_t) extent)))
         {
@@ -4382,14 +6312,8 @@ static MagickBooleanType ReadPixelCachePixels(
       /*
         Read pixels from disk.
       */
-      LockSemaphoreInfo(cache_info->file_semaphore);
-      if (OpenPixelCacheOnDisk(cache_info,IOMode) == MagickFalse)
-        {
-          ThrowFileException(exception,FileOpenError,"UnableToOpenFile",
-            cache_info->cache_filename);
-          UnlockSemaphoreInfo(cache_info->file_semaphore);
-          return(MagickFalse);
-        }
+      if (AcquirePixelCacheOnDisk(cache_info,exception) == MagickFalse)
+        return(MagickFalse);
       if ((cache_info->columns == nexus_info->region.width) &&
           (extent <= MagickMaxBufferExtent))
         {
@@ -4405,9 +6329,7 @@ static MagickBooleanType ReadPixelCachePixels(
         offset+=cache_info->columns;
         q+=cache_info->number_channels*nexus_info->region.width;
       }
-      if (IsFileDescriptorLimitExceeded() != MagickFalse)
-        (void) ClosePixelCacheOnDisk(cache_info);
-      UnlockSemaphoreInfo(cache_info->file_semaphore);
+      RelinquishPixelCacheOnDisk(cache_info);
       break;
     }
     case DistributedCache:
@@ -4418,28 +6340,36 @@ static MagickBooleanType ReadPixelCachePixels(
       /*
         Read pixels from distributed cache.
       */
-      LockSemaphoreInfo(cache_info->file_semaphore);
+      LockPixelCacheFile(cache_info);
       region=nexus_info->region;
-      if ((cache_info->columns != nexus_info->region.width) ||
-          (extent > MagickMaxBufferExtent))
+      if (extent > MagickMaxBufferExtent)
         region.height=1UL;
       else
         {
           length=extent;
           rows=1UL;
         }
-      for (y=0; y < (ssize_t) rows; y++)
-      {
+      if (rows == 1)
         count=ReadDistributePixelCachePixels((DistributeCacheInfo *)
           cache_info->server_info,&region,length,(unsigned char *) q);
-        if (count != (MagickOffsetType) length)
-          break;
-        q+=cache_info->number_channels*nexus_info->region.width;
-        region.y++;
-      }
+      else
+        count=ReadDistributeCachePixelRows((DistributeCacheInfo *)
+          cache_info->server_info,&region,rows,length,(unsigned char *) q);
+      if (count == (MagickOffsetType) (rows*length))
+        y=(ssize_t) rows;
       UnlockSemaphoreInfo(cache_info->file_semaphore);
       break;
     }
+    case CompressedCache:
+    {
+      /*
+        Read pixels from the compressed bands.
+      */
+      if (TransferPixelCacheBands(cache_info,nexus_info,ReadMode,
+            exception) != MagickFalse)
+        y=(ssize_t) rows;
+      break;
+    }
     default:
       break;
   }
@@ -4449,6 +6379,9 @@ static MagickBooleanType ReadPixelCachePixels(
         cache_info->cache_filename);
       return(MagickFalse);
     }
+  CacheStatistic(cache_info,bytes_read,(MagickSizeType)
+    nexus_info->region.width*nexus_info->region.height*
+    cache_info->number_channels*sizeof(Quantum));
   if ((cache_info->debug != MagickFalse) &&
       (CacheTick(nexus_info->region.y,cache_info->rows) != MagickFalse))
     (void) LogMagickEvent(CacheEvent,GetMagickModule(),
@@ -4494,6 +6427,36 @@ MagickPrivate Cache ReferencePixelCache(Cache cache)
   UnlockSemaphoreInfo(cache_info->semaphore);
   return(cache_info);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   R e l i n q u i s h P i x e l C a c h e P o o l                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  RelinquishPixelCachePool() frees the buffers held by the pixel cache pool.
+%  Idle buffers are otherwise only released by a later pool operation, so a
+%  long-running process that has finished with its images can call this to
+%  return that memory to the system.
+%
+%  The format of the RelinquishPixelCachePool method is:
+%
+%      void RelinquishPixelCachePool(void)
+%
+*/
+MagickExport void RelinquishPixelCachePool(void)
+{
+  if (cache_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&cache_semaphore);
+  LockSemaphoreInfo(cache_semaphore);
+  TrimPixelCachePool((time_t) 0);
+  UnlockSemaphoreInfo(cache_semaphore);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -4558,6 +6521,86 @@ MagickPrivate void ResetPixelCacheEpoch(void)
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   S e t P i x e l C a c h e L o a d e r                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetPixelCacheLoader() defers filling the image pixel cache to a loader.
+%  The first time the pixels are accessed, the loader returns an image whose
+%  pixels are copied into the cache.  Unless the pixels are already loaded,
+%  any pixels the cache holds are discarded and a shared cache is replaced
+%  with a private one.  The loader info is relinquished with the cache.
+%
+%  The format of the SetPixelCacheLoader() method is:
+%
+%      MagickBooleanType SetPixelCacheLoader(Image *image,
+%        LoadPixelHandler loader,void *loader_info,
+%        void *(*relinquish_loader_info)(void *),const MagickBooleanType loaded)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o loader: the method that renders the image pixels.
+%
+%    o loader_info: client data passed to the loader.
+%
+%    o relinquish_loader_info: frees the loader info when the cache is
+%      destroyed (NULL if none).
+%
+%    o loaded: set to MagickTrue if the cache already holds the pixels the
+%      loader would return.
+%
+*/
+MagickPrivate MagickBooleanType SetPixelCacheLoader(Image *image,
+  LoadPixelHandler loader,void *loader_info,
+  void *(*relinquish_loader_info)(void *),const MagickBooleanType loaded)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  assert(image->cache != (Cache) NULL);
+  assert(loader != (LoadPixelHandler) NULL);
+  if (image->debug != MagickFalse)
+    (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
+  cache_info=(CacheInfo *) image->cache;
+  if ((loaded == MagickFalse) && (cache_info->reference_count > 1))
+    {
+      image->cache=ClonePixelCache(cache_info);
+      if (image->cache == (Cache) NULL)
+        {
+          image->cache=(Cache) cache_info;
+          return(MagickFalse);
+        }
+      (void) DestroyPixelCache(cache_info);
+      cache_info=(CacheInfo *) image->cache;
+    }
+  if (cache_info->loader_semaphore == (SemaphoreInfo *) NULL)
+    cache_info->loader_semaphore=AcquireSemaphoreInfo();
+  LockSemaphoreInfo(cache_info->semaphore);
+  if (cache_info->relinquish_loader_info != (void *(*)(void *)) NULL)
+    cache_info->loader_info=cache_info->relinquish_loader_info(
+      cache_info->loader_info);
+  if (loaded == MagickFalse)
+    RelinquishPixelCachePixels(cache_info);
+  cache_info->loader=loader;
+  cache_info->loader_info=loader_info;
+  cache_info->relinquish_loader_info=relinquish_loader_info;
+  cache_info->loaded=loaded;
+  cache_info->dirty=MagickFalse;
+  UnlockSemaphoreInfo(cache_info->semaphore);
+  return(MagickTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 +   S e t P i x e l C a c h e M e t h o d s                                   %
 %                                                                             %
 %                                                                             %
@@ -4686,8 +6729,8 @@ static inline MagickBooleanType AcquireCacheNexusPixels(
   if (cache_anonymous_memory <= 0)
     {
       nexus_info->mapped=MagickFalse;
-      nexus_info->cache=(Quantum *) MagickAssumeAligned(AcquireAlignedMemory(1,
-        (size_t) nexus_info->length));
+      nexus_info->cache=(Quantum *) MagickAssumeAligned(
+        AcquirePixelCachePoolMemory((size_t) nexus_info->length));
       if (nexus_info->cache != (Quantum *) NULL)
         (void) ResetMagickMemory(nexus_info->cache,0,(size_t)
           nexus_info->length);
@@ -4741,6 +6784,90 @@ static inline void PrefetchPixelCacheNexusPixels(const NexusInfo *nexus_info,
   MagickCachePrefetch((unsigned char *) nexus_info->pixels,1,1);
 }
 
+static inline void ReadAheadPixelCacheNexus(
+  const CacheInfo *magick_restrict cache_info,
+  NexusInfo *magick_restrict nexus_info)
+{
+  MagickOffsetType
+    offset;
+
+  MagickSizeType
+    length,
+    packet_size;
+
+  ssize_t
+    band,
+    first,
+    last,
+    next_row;
+
+  /*
+    A nexus that reads the rows following its previous region is sweeping
+    the image: ask the kernel to fetch the next rows of a disk or map cache
+    in the background, so the I/O overlaps with work on the current rows.
+    Hints are issued once half the window has been consumed.
+  */
+  next_row=nexus_info->region.y+(ssize_t) nexus_info->region.height;
+  if (nexus_info->region.y != nexus_info->next_row)
+    {
+      nexus_info->next_row=next_row;
+      nexus_info->readahead_row=next_row;
+      return;
+    }
+  nexus_info->next_row=next_row;
+  if (nexus_info->readahead_row < next_row)
+    nexus_info->readahead_row=next_row;
+  last=MagickMin(next_row+(ssize_t) cache_info->readahead,(ssize_t)
+    cache_info->rows);
+  if ((nexus_info->readahead_row >= last) || ((nexus_info->readahead_row-
+       next_row) > (ssize_t) (cache_info->readahead/2)))
+    return;
+  /*
+    Rows of a tile-major cache are contiguous a band of tiles at a time.
+  */
+  band=cache_info->tile_rows == 0 ? 1 : (ssize_t) cache_info->tile_rows;
+  first=nexus_info->readahead_row/band*band;
+  nexus_info->readahead_row=last;
+  last=MagickMin((last+band-1)/band*band,(ssize_t) cache_info->rows);
+  packet_size=(MagickSizeType) cache_info->number_channels*sizeof(Quantum);
+  offset=(MagickOffsetType) ((MagickSizeType) first*cache_info->columns*
+    packet_size);
+  length=(MagickSizeType) (last-first)*cache_info->columns*packet_size;
+  if (cache_info->type == DiskCache)
+    {
+#if defined(MAGICKCORE_HAVE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+      /*
+        Hint only with the descriptor held, as a transfer would: another
+        thread must not close or reopen it under the call.
+      */
+#if defined(MagickConcurrentDiskCache)
+      if (cache_info->file_lock != (pthread_rwlock_t *) NULL)
+        (void) pthread_rwlock_rdlock(cache_info->file_lock);
+#endif
+      LockPixelCacheFile(cache_info);
+      if (cache_info->file != -1)
+        (void) posix_fadvise(cache_info->file,(off_t) (cache_info->offset+
+          offset),(off_t) length,POSIX_FADV_WILLNEED);
+      UnlockSemaphoreInfo(cache_info->file_semaphore);
+#if defined(MagickConcurrentDiskCache)
+      if (cache_info->file_lock != (pthread_rwlock_t *) NULL)
+        (void) pthread_rwlock_unlock(cache_info->file_lock);
+#endif
+#endif
+      return;
+    }
+#if defined(MAGICKCORE_HAVE_POSIX_MADVISE) && defined(POSIX_MADV_WILLNEED)
+  {
+    MagickOffsetType
+      page_offset;
+
+    page_offset=offset % (MagickOffsetType) GetMagickPageSize();
+    (void) posix_madvise((unsigned char *) cache_info->pixels+offset-
+      page_offset,(size_t) (length+page_offset),POSIX_MADV_WILLNEED);
+  }
+#endif
+}
+
 static Quantum *SetPixelCacheNexusPixels(const CacheInfo *cache_info,
   const MapMode mode,const RectangleInfo *region,NexusInfo *nexus_info,
   ExceptionInfo *exception)
@@ -4757,7 +6884,12 @@ static Quantum *SetPixelCacheNexusPixels(const CacheInfo *cache_info,
   if (cache_info->type == UndefinedCache)
     return((Quantum *) NULL);
   nexus_info->region=(*region);
-  if ((cache_info->type == MemoryCache) || (cache_info->type == MapCache))
+  CacheStatistic(cache_info,nexus_requests,1);
+  if ((mode == ReadMode) && (cache_info->readahead != 0) &&
+      ((cache_info->type == DiskCache) || (cache_info->type == MapCache)))
+    ReadAheadPixelCacheNexus(cache_info,nexus_info);
+  if (((cache_info->type == MemoryCache) || (cache_info->type == MapCache)) &&
+      (cache_info->tile_columns == 0) && (cache_info->storage_depth == 0))
     {
       ssize_t
         x,
@@ -4788,12 +6920,14 @@ static Quantum *SetPixelCacheNexusPixels(const CacheInfo *cache_info,
           PrefetchPixelCacheNexusPixels(nexus_info,mode);
           nexus_info->authentic_pixel_cache=IsPixelCacheAuthentic(cache_info,
             nexus_info);
+          CacheStatistic(cache_info,direct_regions,1);
           return(nexus_info->pixels);
         }
     }
   /*
     Pixels are stored in a staging region until they are synced to the cache.
   */
+  CacheStatistic(cache_info,staged_regions,1);
   number_pixels=(MagickSizeType) nexus_info->region.width*
     nexus_info->region.height;
   length=number_pixels*cache_info->number_channels*sizeof(Quantum);
@@ -4832,6 +6966,65 @@ static Quantum *SetPixelCacheNexusPixels(const CacheInfo *cache_info,
   return(nexus_info->pixels);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   S e t P i x e l C a c h e T y p e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  SetPixelCacheType() selects the storage the pixel cache uses when it is
+%  first opened, for example DiskCache to keep a very large image out of
+%  heap memory, or CompressedCache to keep mostly flat pages in compressed
+%  row bands.  A disk request is still memory-mapped if the map resource
+%  permits.  It returns MagickFalse if the cache already holds pixels.
+%
+%  The format of the SetPixelCacheType() method is:
+%
+%      MagickBooleanType SetPixelCacheType(Image *image,const CacheType type)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o type: the cache type: MemoryCache, MapCache, DiskCache, or
+%      CompressedCache.
+%
+*/
+MagickPrivate MagickBooleanType SetPixelCacheType(Image *image,
+  const CacheType type)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  MagickBooleanType
+    status;
+
+  assert(image != (Image *) NULL);
+  assert(image->signature == MagickCoreSignature);
+  if (image->debug != MagickFalse)
+    (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",image->filename);
+  assert(image->cache != (Cache) NULL);
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  if ((type != MemoryCache) && (type != MapCache) && (type != DiskCache) &&
+      (type != CompressedCache))
+    return(MagickFalse);
+  status=MagickFalse;
+  LockSemaphoreInfo(cache_info->semaphore);
+  if ((cache_info->type == UndefinedCache) || (cache_info->type == type))
+    {
+      cache_info->type=type;
+      status=MagickTrue;
+    }
+  UnlockSemaphoreInfo(cache_info->semaphore);
+  return(status);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -5228,6 +7421,108 @@ MagickPrivate MagickBooleanType SyncImagePixelCache(Image *image,
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   U n l o a d P i x e l C a c h e                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UnloadPixelCache() releases the pixels of a cache filled by its loader so
+%  they are loaded again on next access.  Caches that are shared, pinned by a
+%  cache view (see PinPixelCache()), that were accessed as authentic pixels,
+%  or that are not loaded are left untouched and MagickFalse is returned.
+%  The reference count and the pins are read under the cache semaphore.
+%
+%  Pixels returned by GetVirtualPixels() on the image itself are not pinned:
+%  the caller must ensure no other thread holds such pixels from this cache.
+%
+%  The format of the UnloadPixelCache() method is:
+%
+%      MagickBooleanType UnloadPixelCache(Cache cache)
+%
+%  A description of each parameter follows:
+%
+%    o cache: the pixel cache.
+%
+*/
+MagickPrivate MagickBooleanType UnloadPixelCache(Cache cache)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  MagickBooleanType
+    status;
+
+  assert(cache != (Cache) NULL);
+  cache_info=(CacheInfo *) cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  status=MagickFalse;
+  LockSemaphoreInfo(cache_info->semaphore);
+  if ((cache_info->loader != (LoadPixelHandler) NULL) &&
+      (cache_info->loaded != MagickFalse) &&
+      (cache_info->dirty == MagickFalse) &&
+      (cache_info->reference_count == 1) && (cache_info->pins == 0))
+    {
+      if (cache_info->debug != MagickFalse)
+        (void) LogMagickEvent(CacheEvent,GetMagickModule(),"unload %s",
+          cache_info->filename);
+      RelinquishPixelCachePixels(cache_info);
+      cache_info->loaded=MagickFalse;
+      status=MagickTrue;
+    }
+  UnlockSemaphoreInfo(cache_info->semaphore);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   U n p i n P i x e l C a c h e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UnpinPixelCache() releases a pin taken with PinPixelCache().  The cache is
+%  destroyed if this was the last pin and no image references it any more.
+%
+%  The format of the UnpinPixelCache() method is:
+%
+%      Cache UnpinPixelCache(Cache cache)
+%
+%  A description of each parameter follows:
+%
+%    o cache: the pixel cache.
+%
+*/
+MagickPrivate Cache UnpinPixelCache(Cache cache)
+{
+  CacheInfo
+    *magick_restrict cache_info;
+
+  assert(cache != (Cache) NULL);
+  cache_info=(CacheInfo *) cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  LockSemaphoreInfo(cache_info->semaphore);
+  assert(cache_info->pins > 0);
+  cache_info->pins--;
+  if ((cache_info->reference_count != 0) || (cache_info->pins != 0))
+    {
+      UnlockSemaphoreInfo(cache_info->semaphore);
+      return((Cache) NULL);
+    }
+  UnlockSemaphoreInfo(cache_info->semaphore);
+  RelinquishPixelCacheInfo(cache_info);
+  return((Cache) NULL);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 +   W r i t e P i x e l C a c h e M e t a c o n t e n t                       %
 %                                                                             %
 %                                                                             %
@@ -5287,6 +7582,7 @@ static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
   {
     case MemoryCache:
     case MapCache:
+    case CompressedCache:
     {
       register unsigned char
         *magick_restrict q;
@@ -5315,14 +7611,8 @@ static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
       /*
         Write associated pixels to disk.
       */
-      LockSemaphoreInfo(cache_info->file_semaphore);
-      if (OpenPixelCacheOnDisk(cache_info,IOMode) == MagickFalse)
-        {
-          ThrowFileException(exception,FileOpenError,"UnableToOpenFile",
-            cache_info->cache_filename);
-          UnlockSemaphoreInfo(cache_info->file_semaphore);
-          return(MagickFalse);
-        }
+      if (AcquirePixelCacheOnDisk(cache_info,exception) == MagickFalse)
+        return(MagickFalse);
       if ((cache_info->columns == nexus_info->region.width) &&
           (extent <= MagickMaxBufferExtent))
         {
@@ -5340,9 +7630,7 @@ static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
         p+=cache_info->metacontent_extent*nexus_info->region.width;
         offset+=cache_info->columns;
       }
-      if (IsFileDescriptorLimitExceeded() != MagickFalse)
-        (void) ClosePixelCacheOnDisk(cache_info);
-      UnlockSemaphoreInfo(cache_info->file_semaphore);
+      RelinquishPixelCacheOnDisk(cache_info);
       break;
     }
     case DistributedCache:
@@ -5353,10 +7641,9 @@ static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
       /*
         Write metacontent to distributed cache.
       */
-      LockSemaphoreInfo(cache_info->file_semaphore);
+      LockPixelCacheFile(cache_info);
       region=nexus_info->region;
-      if ((cache_info->columns != nexus_info->region.width) ||
-          (extent > MagickMaxBufferExtent))
+      if (extent > MagickMaxBufferExtent)
         region.height=1UL;
       else
         {
@@ -5384,6 +7671,9 @@ static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
         cache_info->cache_filename);
       return(MagickFalse);
     }
+  CacheStatistic(cache_info,bytes_written,(MagickSizeType)
+    nexus_info->region.width*nexus_info->region.height*
+    cache_info->metacontent_extent);
   if ((cache_info->debug != MagickFalse) &&
       (CacheTick(nexus_info->region.y,cache_info->rows) != MagickFalse))
     (void) LogMagickEvent(CacheEvent,GetMagickModule(),
@@ -5450,6 +7740,21 @@ static MagickBooleanType WritePixelCachePixels(
     sizeof(Quantum);
   extent=length*nexus_info->region.height;
   rows=nexus_info->region.height;
+  if (cache_info->tile_columns != 0)
+    {
+      /*
+        Scatter the region across the cache tiles it overlaps.
+      */
+      if (TransferPixelCacheTiles(cache_info,nexus_info,WriteMode,
+            exception) != MagickFalse)
+        {
+          CacheStatistic(cache_info,bytes_written,extent);
+          return(MagickTrue);
+        }
+      ThrowFileException(exception,CacheError,"UnableToWritePixelCache",
+        cache_info->cache_filename);
+      return(MagickFalse);
+    }
   y=0;
   p=nexus_info->pixels;
   switch (cache_info->type)
@@ -5463,6 +7768,29 @@ static MagickBooleanType WritePixelCachePixels(
       /*
         Write pixels to memory.
       */
+      if (cache_info->storage_depth != 0)
+        {
+          register ssize_t
+            i;
+
+          register unsigned char
+            *magick_restrict r;
+
+          /*
+            Narrow the samples to the 8-bit compact repository.
+          */
+          r=(unsigned char *) cache_info->pixels+offset*
+            cache_info->number_channels;
+          for (y=0; y < (ssize_t) rows; y++)
+          {
+            for (i=0; i < (ssize_t) (nexus_info->region.width*
+                 cache_info->number_channels); i++)
+              r[i]=ScaleQuantumToChar(p[i]);
+            p+=cache_info->number_channels*nexus_info->region.width;
+            r+=cache_info->columns*cache_info->number_channels;
+          }
+          break;
+        }
       if ((cache_info->columns == nexus_info->region.width) &&
           (extent == (MagickSizeType) ((size_t) extent)))
         {
@@ -5483,14 +7811,8 @@ static MagickBooleanType WritePixelCachePixels(
       /*
         Write pixels to disk.
       */
-      LockSemaphoreInfo(cache_info->file_semaphore);
-      if (OpenPixelCacheOnDisk(cache_info,IOMode) == MagickFalse)
-        {
-          ThrowFileException(exception,FileOpenError,"UnableToOpenFile",
-            cache_info->cache_filename);
-          UnlockSemaphoreInfo(cache_info->file_semaphore);
-          return(MagickFalse);
-        }
+      if (AcquirePixelCacheOnDisk(cache_info,exception) == MagickFalse)
+        return(MagickFalse);
       if ((cache_info->columns == nexus_info->region.width) &&
           (extent <= MagickMaxBufferExtent))
         {
@@ -5507,9 +7829,7 @@ static MagickBooleanType WritePixelCachePixels(
         p+=cache_info->number_channels*nexus_info->region.width;
         offset+=cache_info->columns;
       }
-      if (IsFileDescriptorLimitExceeded() != MagickFalse)
-        (void) ClosePixelCacheOnDisk(cache_info);
-      UnlockSemaphoreInfo(cache_info->file_semaphore);
+      RelinquishPixelCacheOnDisk(cache_info);
       break;
     }
     case DistributedCache:
@@ -5520,10 +7840,9 @@ static MagickBooleanType WritePixelCachePixels(
       /*
         Write pixels to distributed cache.
       */
-      LockSemaphoreInfo(cache_info->file_semaphore);
+      LockPixelCacheFile(cache_info);
       region=nexus_info->region;
-      if ((cache_info->columns != nexus_info->region.width) ||
-          (extent > MagickMaxBufferExtent))
+      if (extent > MagickMaxBufferExtent)
         region.height=1UL;
       else
         {
@@ -5542,6 +7861,16 @@ static MagickBooleanType WritePixelCachePixels(
       UnlockSemaphoreInfo(cache_info->file_semaphore);
       break;
     }
+    case CompressedCache:
+    {
+      /*
+        Write pixels to the compressed bands.
+      */
+      if (TransferPixelCacheBands(cache_info,nexus_info,WriteMode,
+            exception) != MagickFalse)
+        y=(ssize_t) rows;
+      break;
+    }
     default:
       break;
   }
@@ -5551,6 +7880,9 @@ static MagickBooleanType WritePixelCachePixels(
         cache_info->cache_filename);
       return(MagickFalse);
     }
+  CacheStatistic(cache_info,bytes_written,(MagickSizeType)
+    nexus_info->region.width*nexus_info->region.height*
+    cache_info->number_channels*sizeof(Quantum));
   if ((cache_info->debug != MagickFalse) &&
       (CacheTick(nexus_info->region.y,cache_info->rows) != MagickFalse))
     (void) LogMagickEvent(CacheEvent,GetMagickModule(),
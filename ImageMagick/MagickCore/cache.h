@@ -31,9 +31,24 @@ typedef enum
   DistributedCache,
   MapCache,
   MemoryCache,
-  PingCache
+  PingCache,
+  CompressedCache
 } CacheType;
 
+typedef struct _CacheStatistics
+{
+  MagickSizeType
+    nexus_requests,
+    direct_regions,
+    staged_regions,
+    virtual_pixels,
+    bytes_read,
+    bytes_written;
+
+  double
+    lock_wait;
+} CacheStatistics;
+
 extern MagickExport CacheType
   GetImagePixelCacheType(const Image *);
 
@@ -46,6 +61,7 @@ extern MagickExport const void
   *GetVirtualMetacontent(const Image *);
 
 extern MagickExport MagickBooleanType
+  GetImagePixelCacheStatistics(const Image *,CacheStatistics *),
   GetOneAuthenticPixel(Image *,const ssize_t,const ssize_t,Quantum *,
     ExceptionInfo *),
   GetOneVirtualPixel(const Image *,const ssize_t,const ssize_t,Quantum *,
@@ -67,7 +83,8 @@ extern MagickExport Quantum
     const size_t,ExceptionInfo *) magick_hot_spot;
 
 extern MagickExport void
-  *GetAuthenticMetacontent(const Image *);
+  *GetAuthenticMetacontent(const Image *),
+  RelinquishPixelCachePool(void);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
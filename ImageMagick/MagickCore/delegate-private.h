@@ -21,6 +21,19 @@
 #if defined(MAGICKCORE_GS_DELEGATE)
 #include "ghostscript/iapi.h"
 #include "ghostscript/ierrors.h"
+/*
+  Not every Ghostscript distribution ships the display device header (the
+  bundled iOS headers do not), so the display device path is optional.
+*/
+#if !defined(MAGICKCORE_HAVE_GHOSTSCRIPT_GDEVDSP_H) && defined(__has_include)
+#if __has_include("ghostscript/gdevdsp.h")
+#define MAGICKCORE_HAVE_GHOSTSCRIPT_GDEVDSP_H  1
+#endif
+#endif
+#if defined(MAGICKCORE_HAVE_GHOSTSCRIPT_GDEVDSP_H)
+#include "ghostscript/gdevdsp.h"
+#define MAGICKCORE_GS_DISPLAY_DELEGATE  1
+#endif
 #else
 typedef struct gsapi_revision_s
 {
@@ -41,6 +54,12 @@ typedef struct gs_main_instance_s
   gs_main_instance;
 #endif
 
+#ifndef display_callback_DEFINED
+# define display_callback_DEFINED
+typedef struct display_callback_s
+  display_callback;
+#endif
+
 #if !defined(MagickDLLCall)
 #  if defined(MAGICKCORE_WINDOWS_SUPPORT)
 #    define MagickDLLCall __stdcall
@@ -73,13 +92,47 @@ typedef struct _GhostInfo
 
   int
     (MagickDLLCall *revision)(gsapi_revision_t *, int);
+
+  int
+    (MagickDLLCall *set_display_callback)(gs_main_instance *,
+      display_callback *);
+
+  int
+    (MagickDLLCall *add_control_path)(gs_main_instance *,int,const char *);
+
+  int
+    (MagickDLLCall *remove_control_path)(gs_main_instance *,int,const char *);
 } GhostInfo;
 
+typedef struct _GhostscriptInstance
+  GhostscriptInstance;
+
+typedef MagickBooleanType
+  (*ListDelegateHandler)(FILE *,ExceptionInfo *);
+
+extern MagickPrivate const GhostInfo
+  *GetGhostscriptInfo(void);
+
+extern MagickPrivate GhostscriptInstance
+  *AcquireGhostscriptInstance(const GhostInfo *,const char *,
+    display_callback *,const MagickBooleanType);
+
+extern MagickPrivate int
+  AcquireGhostscriptInterpreter(const GhostInfo *,gs_main_instance **,void *),
+  RunGhostscriptInstance(GhostscriptInstance *,void *,const char *,
+    const char **,char **);
+
 extern MagickPrivate MagickBooleanType
-  DelegateComponentGenesis(void);
+  DelegateComponentGenesis(void),
+  RegisterDelegateListHandler(ListDelegateHandler),
+  RunGhostscriptCommand(const GhostInfo *,const char *,int *,char **);
 
 extern MagickPrivate void
-  DelegateComponentTerminus(void);
+  DelegateComponentTerminus(void),
+  PurgeGhostscriptInstances(void),
+  RelinquishGhostscriptInstance(GhostscriptInstance *),
+  RelinquishGhostscriptInterpreter(const GhostInfo *,gs_main_instance *),
+  UnregisterDelegateListHandler(ListDelegateHandler);
 
 #if defined(__cplusplus) || defined(c_plusplus)
 }
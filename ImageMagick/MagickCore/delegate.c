@@ -69,6 +69,8 @@
 #include "semaphore.h"
 #include "signature.h"
 #include "string_.h"
+#include "string-private.h"
+#include "timer.h"
 #include "token.h"
 #include "token-private.h"
 #include "utility.h"
@@ -80,6 +82,50 @@
   Define declarations.
 */
 #define DelegateFilename  "delegates.xml"
+#define GhostscriptPermitFileReading  0
+#define GhostscriptPoolSize  0
+#define GhostscriptPoolTimeout  60
+#define MaxDelegateListHandlers  8
+
+/*
+  Typedef declarations.
+*/
+struct _GhostscriptInstance
+{
+  const GhostInfo
+    *ghost_info;
+
+  gs_main_instance
+    *interpreter;
+
+  char
+    *arguments,
+    *errors,
+    *output;
+
+  display_callback
+    *callback;
+
+  void
+    *handle;
+
+  MagickBooleanType
+    leased,
+    stale;
+
+  size_t
+    id,
+    leases,
+    jobs,
+    failures,
+    pages;
+
+  double
+    elapsed;
+
+  time_t
+    timestamp;
+};
 
 /*
   Declare delegate map.
@@ -138,14 +184,39 @@ static const char
 static LinkedListInfo
   *delegate_cache = (LinkedListInfo *) NULL;
 
+static LinkedListInfo
+  *ghostscript_pool = (LinkedListInfo *) NULL;
+
+static ListDelegateHandler
+  delegate_list_handlers[MaxDelegateListHandlers];
+
 static SemaphoreInfo
-  *delegate_semaphore = (SemaphoreInfo *) NULL;
+  *delegate_semaphore = (SemaphoreInfo *) NULL,
+  *ghostscript_semaphore = (SemaphoreInfo *) NULL;
+
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+static pthread_cond_t
+  ghostscript_queue_condition = PTHREAD_COND_INITIALIZER;
+
+static pthread_mutex_t
+  ghostscript_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static size_t
+  ghostscript_instances = 0,
+  ghostscript_interpreters = 0,
+  ghostscript_pool_size = GhostscriptPoolSize,
+  ghostscript_releases = 0;
+
+static time_t
+  ghostscript_pool_timeout = GhostscriptPoolTimeout;
 
 /*
   Forward declaractions.
 */
 static MagickBooleanType
   IsDelegateCacheInstantiated(ExceptionInfo *),
+  IsGhostscriptPoolInstantiated(void),
   LoadDelegateCache(LinkedListInfo *,const char *,const char *,const size_t,
     ExceptionInfo *);
 
@@ -212,6 +283,426 @@ static LinkedListInfo *AcquireDelegateCache(const char *filename,
   return(cache);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   A c q u i r e G h o s t s c r i p t I n s t a n c e                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireGhostscriptInstance() leases an initialized Ghostscript interpreter
+%  from the instance pool.  An idle instance that was initialized with the
+%  same arguments and display callback is reused as is, otherwise a new one
+%  is started if the pool has room.  NULL is returned if the pool is disabled
+%  or every instance is busy; the caller should then fall back to a one-shot
+%  interpreter.  NULL is also returned by Ghostscript 9.50 or later if the
+%  library does not export gsapi_add_control_path(), as -dSAFER would then
+%  refuse to open the documents run on the instance.
+%
+%  Pooling is disabled by default.  A job runs inside save and restore, but
+%  that does not undo every change a document can make to the interpreter,
+%  so only enable the pool for trusted input: set the
+%  MAGICK_GHOSTSCRIPT_POOL_SIZE environment variable or the
+%  delegate:ghostscript-pool-size policy to the number of instances to keep.
+%  Only the PDF coder leases instances, and only for PDF documents.
+%  Instances idle longer than delegate:ghostscript-pool-timeout seconds
+%  (default 60) are shut down.
+%
+%  The format of the AcquireGhostscriptInstance method is:
+%
+%      GhostscriptInstance *AcquireGhostscriptInstance(
+%        const GhostInfo *ghost_info,const char *arguments,
+%        display_callback *callback,const MagickBooleanType output)
+%
+%  A description of each parameter follows:
+%
+%    o ghost_info: the Ghostscript library vectors.
+%
+%    o arguments: the interpreter arguments.  These must not name any input
+%      file nor -dBATCH, documents are run with RunGhostscriptInstance().
+%
+%    o callback: if not NULL, the display device callback.  The display
+%      handle is appended to the arguments by the pool and is set per
+%      document by RunGhostscriptInstance().
+%
+%    o output: if MagickTrue, the pool appends a private -sOutputFile
+%      template to the arguments; the arguments must not name one.  Pages
+%      are collected from it by RunGhostscriptCommand().
+%
+*/
+
+static int MagickDLLCall GhostscriptInstanceMessage(void *handle,
+  const char *message,int length)
+{
+  GhostscriptInstance
+    *instance;
+
+  size_t
+    offset;
+
+  instance=(GhostscriptInstance *) handle;
+  offset=0;
+  if (instance->errors == (char *) NULL)
+    instance->errors=(char *) AcquireQuantumMemory(length+1,sizeof(char));
+  else
+    {
+      offset=strlen(instance->errors);
+      instance->errors=(char *) ResizeQuantumMemory(instance->errors,offset+
+        length+1,sizeof(char));
+    }
+  if (instance->errors == (char *) NULL)
+    return(length);
+  (void) memcpy(instance->errors+offset,message,length);
+  instance->errors[length+offset]='\0';
+  return(length);
+}
+
+static void SignalGhostscriptQueue(void)
+{
+  /*
+    An interpreter was deleted or a pooled one went idle: wake the callers
+    waiting in AcquireGhostscriptInterpreter() to retry.
+  */
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+  (void) pthread_mutex_lock(&ghostscript_queue_mutex);
+  ghostscript_releases++;
+  (void) pthread_cond_broadcast(&ghostscript_queue_condition);
+  (void) pthread_mutex_unlock(&ghostscript_queue_mutex);
+#else
+  ghostscript_releases++;
+#endif
+}
+
+static GhostscriptInstance *DestroyGhostscriptInstance(
+  GhostscriptInstance *instance)
+{
+  if (instance->interpreter != (gs_main_instance *) NULL)
+    {
+      (void) LogMagickEvent(ResourceEvent,GetMagickModule(),
+        "ghostscript instance %.20g: %.20g leases, %.20g jobs, %.20g failures, "
+        "%gs",(double) instance->id,(double) instance->leases,(double)
+        instance->jobs,(double) instance->failures,instance->elapsed);
+      (void) (instance->ghost_info->exit)(instance->interpreter);
+      (instance->ghost_info->delete_instance)(instance->interpreter);
+      SignalGhostscriptQueue();
+    }
+  if (instance->arguments != (char *) NULL)
+    instance->arguments=DestroyString(instance->arguments);
+  if (instance->errors != (char *) NULL)
+    instance->errors=DestroyString(instance->errors);
+  if (instance->output != (char *) NULL)
+    {
+      (void) RelinquishUniqueFileResource(instance->output);
+      instance->output=DestroyString(instance->output);
+    }
+  return((GhostscriptInstance *) RelinquishMagickMemory(instance));
+}
+
+static void *DestroyGhostscriptPoolElement(void *instance)
+{
+  return((void *) DestroyGhostscriptInstance((GhostscriptInstance *)
+    instance));
+}
+
+static void PurgeIdleGhostscriptInstances(const time_t timeout)
+{
+  GhostscriptInstance
+    *instance;
+
+  register ssize_t
+    i;
+
+  time_t
+    now;
+
+  /*
+    Shut down instances idle for at least timeout seconds (lock held).
+  */
+  now=time((time_t *) NULL);
+  for (i=(ssize_t) GetNumberOfElementsInLinkedList(ghostscript_pool)-1; i >= 0;
+       i--)
+  {
+    instance=(GhostscriptInstance *) GetValueFromLinkedList(ghostscript_pool,
+      (size_t) i);
+    if ((instance->leased != MagickFalse) ||
+        ((now-instance->timestamp) < timeout))
+      continue;
+    (void) RemoveElementFromLinkedList(ghostscript_pool,(size_t) i);
+    instance=DestroyGhostscriptInstance(instance);
+  }
+}
+
+MagickPrivate GhostscriptInstance *AcquireGhostscriptInstance(
+  const GhostInfo *ghost_info,const char *arguments,display_callback *callback,
+  const MagickBooleanType output)
+{
+  char
+    **argv,
+    *command;
+
+  GhostscriptInstance
+    *instance,
+    *p;
+
+  gsapi_revision_t
+    revision;
+
+  int
+    argc,
+    status;
+
+  register ssize_t
+    i;
+
+  if ((ghost_info == (const GhostInfo *) NULL) ||
+      (arguments == (const char *) NULL))
+    return((GhostscriptInstance *) NULL);
+  if (IsGhostscriptPoolInstantiated() == MagickFalse)
+    return((GhostscriptInstance *) NULL);
+  if (ghostscript_pool_size == 0)
+    return((GhostscriptInstance *) NULL);
+  if ((callback != (display_callback *) NULL) &&
+      (ghost_info->set_display_callback == NULL))
+    return((GhostscriptInstance *) NULL);
+  if (ghost_info->add_control_path == NULL)
+    {
+      /*
+        Since 9.50 -dSAFER only opens files on the permitted paths.
+      */
+      if ((ghost_info->revision)(&revision,sizeof(revision)) != 0)
+        return((GhostscriptInstance *) NULL);
+      if (revision.revision >= 950)
+        return((GhostscriptInstance *) NULL);
+    }
+  LockSemaphoreInfo(ghostscript_semaphore);
+  PurgeIdleGhostscriptInstances(ghostscript_pool_timeout);
+  instance=(GhostscriptInstance *) NULL;
+  for (i=0; i < (ssize_t) GetNumberOfElementsInLinkedList(ghostscript_pool);
+       i++)
+  {
+    p=(GhostscriptInstance *) GetValueFromLinkedList(ghostscript_pool,
+      (size_t) i);
+    if ((p->leased != MagickFalse) || (p->ghost_info != ghost_info) ||
+        (p->callback != callback) ||
+        ((p->output != (char *) NULL) != (output != MagickFalse)) ||
+        (strcmp(p->arguments,arguments) != 0))
+      continue;
+    instance=p;
+    break;
+  }
+  if (instance != (GhostscriptInstance *) NULL)
+    {
+      instance->leased=MagickTrue;
+      instance->leases++;
+      UnlockSemaphoreInfo(ghostscript_semaphore);
+      return(instance);
+    }
+  if (GetNumberOfElementsInLinkedList(ghostscript_pool) >= ghostscript_pool_size)
+    {
+      GhostscriptInstance
+        *oldest;
+
+      /*
+        Pool is full: make room by retiring the least recently used idle one.
+      */
+      oldest=(GhostscriptInstance *) NULL;
+      for (i=0; i < (ssize_t) GetNumberOfElementsInLinkedList(ghostscript_pool);
+           i++)
+      {
+        p=(GhostscriptInstance *) GetValueFromLinkedList(ghostscript_pool,
+          (size_t) i);
+        if ((p->leased == MagickFalse) &&
+            ((oldest == (GhostscriptInstance *) NULL) ||
+             (p->timestamp < oldest->timestamp)))
+          oldest=p;
+      }
+      if (oldest == (GhostscriptInstance *) NULL)
+        {
+          UnlockSemaphoreInfo(ghostscript_semaphore);
+          return((GhostscriptInstance *) NULL);
+        }
+      (void) RemoveElementByValueFromLinkedList(ghostscript_pool,oldest);
+      oldest=DestroyGhostscriptInstance(oldest);
+    }
+  instance=(GhostscriptInstance *) AcquireMagickMemory(sizeof(*instance));
+  if (instance == (GhostscriptInstance *) NULL)
+    {
+      UnlockSemaphoreInfo(ghostscript_semaphore);
+      return((GhostscriptInstance *) NULL);
+    }
+  (void) ResetMagickMemory(instance,0,sizeof(*instance));
+  instance->ghost_info=ghost_info;
+  instance->arguments=ConstantString(arguments);
+  instance->callback=callback;
+  if (output != MagickFalse)
+    {
+      instance->output=AcquireString((const char *) NULL);
+      if (AcquireUniqueFilename(instance->output) == MagickFalse)
+        {
+          UnlockSemaphoreInfo(ghostscript_semaphore);
+          instance->output=DestroyString(instance->output);
+          instance=DestroyGhostscriptInstance(instance);
+          return((GhostscriptInstance *) NULL);
+        }
+    }
+  instance->leased=MagickTrue;
+  instance->leases=1;
+  instance->id=(++ghostscript_instances);
+  instance->timestamp=time((time_t *) NULL);
+  (void) AppendValueToLinkedList(ghostscript_pool,instance);
+  UnlockSemaphoreInfo(ghostscript_semaphore);
+  /*
+    Start the interpreter outside the pool lock, this is the expensive part.
+  */
+  status=(ghost_info->new_instance)(&instance->interpreter,(void *) instance);
+  if (status < 0)
+    instance->interpreter=(gs_main_instance *) NULL;
+  else
+    {
+      (void) (ghost_info->set_stdio)(instance->interpreter,(int(MagickDLLCall *)
+        (void *,char *,int)) NULL,GhostscriptInstanceMessage,
+        GhostscriptInstanceMessage);
+      if (callback != (display_callback *) NULL)
+        status=(ghost_info->set_display_callback)(instance->interpreter,
+          callback);
+    }
+  if (status >= 0)
+    {
+      command=AcquireString(arguments);
+      if (callback != (display_callback *) NULL)
+        {
+          char
+            handle[MagickPathExtent];
+
+          (void) FormatLocaleString(handle,MagickPathExtent,
+            " -sDisplayHandle=16#%llx",(unsigned long long) (size_t)
+            &instance->handle);
+          (void) ConcatenateString(&command,handle);
+        }
+      if (instance->output != (char *) NULL)
+        {
+          (void) ConcatenateString(&command," \"-sOutputFile=");
+          (void) ConcatenateString(&command,instance->output);
+          (void) ConcatenateString(&command,"%d\"");
+        }
+      argv=StringToArgv(command,&argc);
+      command=DestroyString(command);
+      status=(-1);
+      if (argv != (char **) NULL)
+        {
+          status=(ghost_info->init_with_args)(instance->interpreter,argc-1,
+            argv+1);
+          for (i=0; i < (ssize_t) argc; i++)
+            argv[i]=DestroyString(argv[i]);
+          argv=(char **) RelinquishMagickMemory(argv);
+        }
+    }
+  if (status < 0)
+    {
+      LockSemaphoreInfo(ghostscript_semaphore);
+      (void) RemoveElementByValueFromLinkedList(ghostscript_pool,instance);
+      UnlockSemaphoreInfo(ghostscript_semaphore);
+      instance=DestroyGhostscriptInstance(instance);
+      return((GhostscriptInstance *) NULL);
+    }
+  if (instance->errors != (char *) NULL)
+    instance->errors=DestroyString(instance->errors);
+  return(instance);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   A c q u i r e G h o s t s c r i p t I n t e r p r e t e r                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireGhostscriptInterpreter() creates a one-shot Ghostscript interpreter.
+%  A library built to allow only one instance at a time refuses a second
+%  one: the idle pooled instances are then shut down and, if other
+%  interpreters are still busy, the caller sleeps until one is deleted or
+%  returned to the pool, then retries.  Without thread support there is
+%  nothing to wait for and the failure is returned.
+%  It returns the gsapi_new_instance() status, negative on failure.  Free the
+%  interpreter with RelinquishGhostscriptInterpreter().
+%
+%  The format of the AcquireGhostscriptInterpreter method is:
+%
+%      int AcquireGhostscriptInterpreter(const GhostInfo *ghost_info,
+%        gs_main_instance **interpreter,void *handle)
+%
+%  A description of each parameter follows:
+%
+%    o ghost_info: the Ghostscript library vectors.
+%
+%    o interpreter: return the interpreter.
+%
+%    o handle: the caller handle passed to the stdio callbacks.
+%
+*/
+MagickPrivate int AcquireGhostscriptInterpreter(const GhostInfo *ghost_info,
+  gs_main_instance **interpreter,void *handle)
+{
+  int
+    status;
+
+  size_t
+    busy,
+    releases;
+
+  assert(ghost_info != (const GhostInfo *) NULL);
+  assert(interpreter != (gs_main_instance **) NULL);
+  status=(ghost_info->new_instance)(interpreter,handle);
+  while (status < 0)
+  {
+    /*
+      Note the release count before retrying so a release that lands
+      between the retry and the wait is not missed.
+    */
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+    (void) pthread_mutex_lock(&ghostscript_queue_mutex);
+    releases=ghostscript_releases;
+    (void) pthread_mutex_unlock(&ghostscript_queue_mutex);
+#else
+    releases=ghostscript_releases;
+#endif
+    PurgeGhostscriptInstances();
+    status=(ghost_info->new_instance)(interpreter,handle);
+    if (status >= 0)
+      break;
+    LockSemaphoreInfo(ghostscript_semaphore);
+    busy=ghostscript_interpreters;
+    if (ghostscript_pool != (LinkedListInfo *) NULL)
+      busy+=GetNumberOfElementsInLinkedList(ghostscript_pool);
+    UnlockSemaphoreInfo(ghostscript_semaphore);
+    if (busy == 0)
+      break;  /* nothing to wait for, the library is unusable */
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+    (void) pthread_mutex_lock(&ghostscript_queue_mutex);
+    while (releases == ghostscript_releases)
+      (void) pthread_cond_wait(&ghostscript_queue_condition,
+        &ghostscript_queue_mutex);
+    (void) pthread_mutex_unlock(&ghostscript_queue_mutex);
+#else
+    break;
+#endif
+  }
+  if (status < 0)
+    return(status);
+  LockSemaphoreInfo(ghostscript_semaphore);
+  ghostscript_interpreters++;
+  UnlockSemaphoreInfo(ghostscript_semaphore);
+  return(status);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -234,6 +725,8 @@ MagickPrivate MagickBooleanType DelegateComponentGenesis(void)
 {
   if (delegate_semaphore == (SemaphoreInfo *) NULL)
     delegate_semaphore=AcquireSemaphoreInfo();
+  if (ghostscript_semaphore == (SemaphoreInfo *) NULL)
+    ghostscript_semaphore=AcquireSemaphoreInfo();
   return(MagickTrue);
 }
 
@@ -285,6 +778,14 @@ MagickPrivate void DelegateComponentTerminus(void)
     delegate_cache=DestroyLinkedList(delegate_cache,DestroyDelegate);
   UnlockSemaphoreInfo(delegate_semaphore);
   RelinquishSemaphoreInfo(&delegate_semaphore);
+  if (ghostscript_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&ghostscript_semaphore);
+  LockSemaphoreInfo(ghostscript_semaphore);
+  if (ghostscript_pool != (LinkedListInfo *) NULL)
+    ghostscript_pool=DestroyLinkedList(ghostscript_pool,
+      DestroyGhostscriptPoolElement);
+  UnlockSemaphoreInfo(ghostscript_semaphore);
+  RelinquishSemaphoreInfo(&ghostscript_semaphore);
 }
 
 /*
@@ -1481,6 +1982,59 @@ MagickExport MagickBooleanType GetDelegateThreadSupport(
   return(delegate_info->thread_support);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t G h o s t s c r i p t I n f o                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetGhostscriptInfo() returns the Ghostscript library vectors, or NULL if
+%  the library is not available and the interpreter must be run as an
+%  external command.
+%
+%  The format of the GetGhostscriptInfo method is:
+%
+%      const GhostInfo *GetGhostscriptInfo(void)
+%
+*/
+MagickPrivate const GhostInfo *GetGhostscriptInfo(void)
+{
+#if defined(MAGICKCORE_WINDOWS_SUPPORT)
+  return(NTGhostscriptDLLVectors());
+#elif defined(MAGICKCORE_GS_DELEGATE)
+  static GhostInfo
+    ghost_info =
+    {
+      (void (*)(gs_main_instance *)) gsapi_delete_instance,
+      (int (*)(gs_main_instance *)) gsapi_exit,
+      (int (*)(gs_main_instance *,int,char **)) gsapi_init_with_args,
+      (int (*)(gs_main_instance **,void *)) gsapi_new_instance,
+      (int (*)(gs_main_instance *,const char *,int,int *)) gsapi_run_string,
+      (int (*)(gs_main_instance *,int(*)(void *,char *,int),int(*)(void *,
+        const char *,int),int(*)(void *,const char *,int))) gsapi_set_stdio,
+      (int (*)(gsapi_revision_t *,int)) gsapi_revision,
+      (int (*)(gs_main_instance *,display_callback *))
+        gsapi_set_display_callback,
+#if defined(MAGICKCORE_HAVE_GSAPI_ADD_CONTROL_PATH)
+      (int (*)(gs_main_instance *,int,const char *)) gsapi_add_control_path,
+      (int (*)(gs_main_instance *,int,const char *)) gsapi_remove_control_path
+#else
+      (int (*)(gs_main_instance *,int,const char *)) NULL,
+      (int (*)(gs_main_instance *,int,const char *)) NULL
+#endif
+    };
+
+  return(&ghost_info);
+#else
+  return((const GhostInfo *) NULL);
+#endif
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1517,6 +2071,70 @@ static MagickBooleanType IsDelegateCacheInstantiated(ExceptionInfo *exception)
     }
   return(delegate_cache != (LinkedListInfo *) NULL ? MagickTrue : MagickFalse);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   I s G h o s t s c r i p t P o o l I n s t a n t i a t e d                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  IsGhostscriptPoolInstantiated() determines if the Ghostscript instance
+%  pool is instantiated.  If not, it reads the pool limits and instantiates
+%  the pool.
+%
+%  The format of the IsGhostscriptPoolInstantiated method is:
+%
+%      MagickBooleanType IsGhostscriptPoolInstantiated(void)
+%
+*/
+static MagickBooleanType IsGhostscriptPoolInstantiated(void)
+{
+  if (ghostscript_pool == (LinkedListInfo *) NULL)
+    {
+      if (ghostscript_semaphore == (SemaphoreInfo *) NULL)
+        ActivateSemaphoreInfo(&ghostscript_semaphore);
+      LockSemaphoreInfo(ghostscript_semaphore);
+      if (ghostscript_pool == (LinkedListInfo *) NULL)
+        {
+          char
+            *value;
+
+          value=GetEnvironmentValue("MAGICK_GHOSTSCRIPT_POOL_SIZE");
+          if (value != (char *) NULL)
+            {
+              ghostscript_pool_size=StringToUnsignedLong(value);
+              value=DestroyString(value);
+            }
+          value=GetPolicyValue("delegate:ghostscript-pool-size");
+          if (value != (char *) NULL)
+            {
+              ghostscript_pool_size=StringToUnsignedLong(value);
+              value=DestroyString(value);
+            }
+          value=GetEnvironmentValue("MAGICK_GHOSTSCRIPT_POOL_TIMEOUT");
+          if (value != (char *) NULL)
+            {
+              ghostscript_pool_timeout=(time_t) StringToUnsignedLong(value);
+              value=DestroyString(value);
+            }
+          value=GetPolicyValue("delegate:ghostscript-pool-timeout");
+          if (value != (char *) NULL)
+            {
+              ghostscript_pool_timeout=(time_t) StringToUnsignedLong(value);
+              value=DestroyString(value);
+            }
+          ghostscript_pool=NewLinkedList(0);
+        }
+      UnlockSemaphoreInfo(ghostscript_semaphore);
+    }
+  return(ghostscript_pool != (LinkedListInfo *) NULL ? MagickTrue :
+    MagickFalse);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -1952,6 +2570,56 @@ MagickExport MagickBooleanType ListDelegateInfo(FILE *file,
       commands[j]=DestroyString(commands[j]);
     commands=(char **) RelinquishMagickMemory(commands);
   }
+  if ((ghostscript_pool != (LinkedListInfo *) NULL) &&
+      (IsLinkedListEmpty(ghostscript_pool) == MagickFalse))
+    {
+      time_t
+        now;
+
+      /*
+        Ghostscript instance pool statistics.
+      */
+      (void) FormatLocaleFile(file,"\nGhostscript instances (pool size %.20g, "
+        "timeout %.20gs)\n\n",(double) ghostscript_pool_size,(double)
+        ghostscript_pool_timeout);
+      (void) FormatLocaleFile(file,
+        "Instance  State   Leases    Jobs  Failures   Elapsed     Idle\n");
+      (void) FormatLocaleFile(file,
+        "-------------------------------------------------"
+        "------------------------------\n");
+      now=time((time_t *) NULL);
+      LockSemaphoreInfo(ghostscript_semaphore);
+      for (i=0; i < (ssize_t) GetNumberOfElementsInLinkedList(ghostscript_pool);
+           i++)
+      {
+        const GhostscriptInstance
+          *instance;
+
+        instance=(const GhostscriptInstance *) GetValueFromLinkedList(
+          ghostscript_pool,(size_t) i);
+        (void) FormatLocaleFile(file,"%8.20g  %-6s %7.20g %7.20g %9.20g "
+          "%8.3fs %7.20gs\n",(double) instance->id,instance->leased !=
+          MagickFalse ? "leased" : "idle",(double) instance->leases,(double)
+          instance->jobs,(double) instance->failures,instance->elapsed,
+          instance->leased != MagickFalse ? 0.0 : (double) (now-
+          instance->timestamp));
+      }
+      UnlockSemaphoreInfo(ghostscript_semaphore);
+    }
+  for (i=0; i < MaxDelegateListHandlers; i++)
+  {
+    ListDelegateHandler
+      handler;
+
+    /*
+      Coder state, e.g. the PDF metadata cache.
+    */
+    LockSemaphoreInfo(delegate_semaphore);
+    handler=delegate_list_handlers[i];
+    UnlockSemaphoreInfo(delegate_semaphore);
+    if (handler != (ListDelegateHandler) NULL)
+      (void) handler(file,exception);
+  }
   (void) fflush(file);
   delegate_info=(const DelegateInfo **)
     RelinquishMagickMemory((void *) delegate_info);
@@ -2228,3 +2896,534 @@ static MagickBooleanType LoadDelegateCache(LinkedListInfo *cache,
   token=(char *) RelinquishMagickMemory(token);
   return(status != 0 ? MagickTrue : MagickFalse);
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   P u r g e G h o s t s c r i p t I n s t a n c e s                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  PurgeGhostscriptInstances() shuts down every idle instance in the
+%  Ghostscript pool.  Call it before starting a one-shot interpreter when
+%  the library only supports a single instance per process.
+%
+%  The format of the PurgeGhostscriptInstances method is:
+%
+%      void PurgeGhostscriptInstances(void)
+%
+*/
+MagickPrivate void PurgeGhostscriptInstances(void)
+{
+  if (ghostscript_pool == (LinkedListInfo *) NULL)
+    return;
+  LockSemaphoreInfo(ghostscript_semaphore);
+  PurgeIdleGhostscriptInstances(0);
+  UnlockSemaphoreInfo(ghostscript_semaphore);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e g i s t e r D e l e g a t e L i s t H a n d l e r                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  RegisterDelegateListHandler() registers a method that ListDelegateInfo()
+%  calls to report state kept by a delegate-backed coder.
+%
+%  The format of the RegisterDelegateListHandler method is:
+%
+%      MagickBooleanType RegisterDelegateListHandler(
+%        ListDelegateHandler handler)
+%
+%  A description of each parameter follows:
+%
+%    o handler: the method; it is passed the listing file and an exception.
+%
+*/
+MagickPrivate MagickBooleanType RegisterDelegateListHandler(
+  ListDelegateHandler handler)
+{
+  register ssize_t
+    i;
+
+  assert(handler != (ListDelegateHandler) NULL);
+  if (delegate_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&delegate_semaphore);
+  LockSemaphoreInfo(delegate_semaphore);
+  for (i=0; i < MaxDelegateListHandlers; i++)
+    if (delegate_list_handlers[i] == handler)
+      break;
+  if (i >= MaxDelegateListHandlers)
+    for (i=0; i < MaxDelegateListHandlers; i++)
+      if (delegate_list_handlers[i] == (ListDelegateHandler) NULL)
+        {
+          delegate_list_handlers[i]=handler;
+          break;
+        }
+  UnlockSemaphoreInfo(delegate_semaphore);
+  return(i < MaxDelegateListHandlers ? MagickTrue : MagickFalse);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e l i n q u i s h G h o s t s c r i p t I n s t a n c e                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  RelinquishGhostscriptInstance() returns a leased instance to the
+%  Ghostscript pool.  Instances left unusable by their last document are shut
+%  down instead.
+%
+%  The format of the RelinquishGhostscriptInstance method is:
+%
+%      void RelinquishGhostscriptInstance(GhostscriptInstance *instance)
+%
+%  A description of each parameter follows:
+%
+%    o instance: the leased instance.
+%
+*/
+MagickPrivate void RelinquishGhostscriptInstance(GhostscriptInstance *instance)
+{
+  assert(instance != (GhostscriptInstance *) NULL);
+  LockSemaphoreInfo(ghostscript_semaphore);
+  instance->leased=MagickFalse;
+  instance->handle=(void *) NULL;
+  instance->timestamp=time((time_t *) NULL);
+  if ((instance->stale == MagickFalse) &&
+      (GetNumberOfElementsInLinkedList(ghostscript_pool) <=
+       ghostscript_pool_size))
+    {
+      UnlockSemaphoreInfo(ghostscript_semaphore);
+      SignalGhostscriptQueue();
+      return;
+    }
+  (void) RemoveElementByValueFromLinkedList(ghostscript_pool,instance);
+  UnlockSemaphoreInfo(ghostscript_semaphore);
+  instance=DestroyGhostscriptInstance(instance);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e l i n q u i s h G h o s t s c r i p t I n t e r p r e t e r           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  RelinquishGhostscriptInterpreter() deletes an interpreter created with
+%  AcquireGhostscriptInterpreter(), letting any queued caller proceed.
+%
+%  The format of the RelinquishGhostscriptInterpreter method is:
+%
+%      void RelinquishGhostscriptInterpreter(const GhostInfo *ghost_info,
+%        gs_main_instance *interpreter)
+%
+%  A description of each parameter follows:
+%
+%    o ghost_info: the Ghostscript library vectors.
+%
+%    o interpreter: the interpreter.
+%
+*/
+MagickPrivate void RelinquishGhostscriptInterpreter(const GhostInfo *ghost_info,
+  gs_main_instance *interpreter)
+{
+  assert(ghost_info != (const GhostInfo *) NULL);
+  (ghost_info->delete_instance)(interpreter);
+  LockSemaphoreInfo(ghostscript_semaphore);
+  ghostscript_interpreters--;
+  UnlockSemaphoreInfo(ghostscript_semaphore);
+  SignalGhostscriptQueue();
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R u n G h o s t s c r i p t C o m m a n d                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  RunGhostscriptCommand() runs a Ghostscript delegate command, as formatted
+%  from delegates.xml, on a pooled interpreter.  The input files (-f or bare
+%  arguments) become the job, -dFirstPage and -dLastPage are defined per job,
+%  and the pages written by the instance are renamed to the -sOutputFile
+%  template of the command, numbered from 1.  The remaining arguments select
+%  the instance.
+%
+%  MagickFalse is returned, and nothing is run, if the command cannot be
+%  pooled: the pool is disabled or busy, the output template does not
+%  number its pages with %d, or the command uses -c, -o, or reads standard
+%  input.  The caller should then run the command in a one-shot interpreter.
+%
+%  The format of the RunGhostscriptCommand method is:
+%
+%      MagickBooleanType RunGhostscriptCommand(const GhostInfo *ghost_info,
+%        const char *command,int *status,char **errors)
+%
+%  A description of each parameter follows:
+%
+%    o ghost_info: the Ghostscript library vectors.
+%
+%    o command: the delegate command, the first argument is the program.
+%
+%    o status: return the interpreter status, 0 on success.
+%
+%    o errors: return the interpreter output; free it with DestroyString().
+%
+*/
+
+static void FormatGhostscriptPage(char *filename,const char *output,
+  const size_t page)
+{
+  const char
+    *p;
+
+  /*
+    Substitute the page number for the %d of the output template.
+  */
+  p=strstr(output,"%d");
+  (void) FormatLocaleString(filename,MagickPathExtent,"%.*s%.20g%s",
+    (int) (p-output),output,(double) page,p+2);
+}
+
+static void MoveGhostscriptPages(GhostscriptInstance *instance,
+  const char *output)
+{
+  char
+    filename[MagickPathExtent],
+    source[MagickPathExtent];
+
+  size_t
+    pages;
+
+  register size_t
+    i;
+
+  /*
+    The device numbers pages from its open, which usually spans jobs; it
+    starts again from 1 when a job reopens it with new parameters.
+  */
+  i=instance->pages+1;
+  (void) FormatLocaleString(source,MagickPathExtent,"%s1",instance->output);
+  if (IsPathAccessible(source) != MagickFalse)
+    i=1;
+  for (pages=0; ; i++)
+  {
+    (void) FormatLocaleString(source,MagickPathExtent,"%s%.20g",
+      instance->output,(double) i);
+    if (IsPathAccessible(source) == MagickFalse)
+      break;
+    FormatGhostscriptPage(filename,output,++pages);
+    if (rename_utf8(source,filename) != 0)
+      (void) remove_utf8(source);
+  }
+  instance->pages=i-1;
+}
+
+MagickPrivate MagickBooleanType RunGhostscriptCommand(
+  const GhostInfo *ghost_info,const char *command,int *status,char **errors)
+{
+  char
+    **argv,
+    *arguments,
+    *job,
+    path[MagickPathExtent],
+    pages[MagickPathExtent];
+
+  const char
+    *output,
+    **paths;
+
+  GhostscriptInstance
+    *instance;
+
+  int
+    argc;
+
+  MagickBooleanType
+    pooled;
+
+  register const char
+    *p;
+
+  register ssize_t
+    i,
+    j;
+
+  size_t
+    number_paths;
+
+  assert(status != (int *) NULL);
+  *status=(-1);
+  if (errors != (char **) NULL)
+    *errors=(char *) NULL;
+  if ((ghost_info == (const GhostInfo *) NULL) ||
+      (command == (const char *) NULL))
+    return(MagickFalse);
+  argv=StringToArgv(command,&argc);
+  if (argv == (char **) NULL)
+    return(MagickFalse);
+  paths=(const char **) AcquireQuantumMemory((size_t) argc+1,sizeof(*paths));
+  if ((argc < 2) || (paths == (const char **) NULL))
+    {
+      if (paths != (const char **) NULL)
+        paths=(const char **) RelinquishMagickMemory((void *) paths);
+      for (i=0; i < (ssize_t) argc; i++)
+        argv[i]=DestroyString(argv[i]);
+      argv=(char **) RelinquishMagickMemory(argv);
+      return(MagickFalse);
+    }
+  /*
+    Split the command into instance arguments and a job.
+  */
+  arguments=AcquireString("\"");
+  (void) ConcatenateString(&arguments,argv[1]);
+  (void) ConcatenateString(&arguments,"\"");
+  job=AcquireString((const char *) NULL);
+  *pages='\0';
+  output=(const char *) NULL;
+  number_paths=0;
+  pooled=MagickTrue;
+  for (i=2; (i < (ssize_t) argc) && (pooled != MagickFalse); i++)
+  {
+    p=argv[i];
+    if ((*p != '-') || ((strncmp(p,"-f",2) == 0) && (p[2] != '\0')))
+      {
+        if (*p == '-')
+          p+=2;
+        if ((*p == '@') || (strlen(p) >= (MagickPathExtent/2)))
+          {
+            pooled=MagickFalse;
+            break;
+          }
+        paths[number_paths++]=p;
+        j=0;
+        for ( ; *p != '\0'; p++)
+        {
+          if ((*p == '(') || (*p == ')') || (*p == '\\'))
+            path[j++]='\\';
+          path[j++]=(*p);
+        }
+        path[j]='\0';
+        (void) ConcatenateString(&job,"(");
+        (void) ConcatenateString(&job,path);
+        (void) ConcatenateString(&job,") run\n");
+        continue;
+      }
+    if (strncmp(p,"-sOutputFile=",13) == 0)
+      {
+        output=p+13;
+        continue;
+      }
+    if (strcmp(p,"-dBATCH") == 0)
+      continue;
+    if ((strncmp(p,"-dFirstPage=",12) == 0) ||
+        (strncmp(p,"-dLastPage=",11) == 0))
+      {
+        (void) FormatLocaleString(path,MagickPathExtent,"/%.*s %.20g def ",
+          (int) (strchr(p,'=')-p-2),p+2,(double) StringToLong(
+          strchr(p,'=')+1));
+        (void) ConcatenateMagickString(pages,path,MagickPathExtent);
+        continue;
+      }
+    if ((strcmp(p,"-") == 0) || (strcmp(p,"-_") == 0) ||
+        (strcmp(p,"-c") == 0) || (strcmp(p,"-f") == 0) ||
+        (strcmp(p,"-o") == 0) || (strcmp(p,"--") == 0) ||
+        (strcmp(p,"-+") == 0) || (strchr(p,'"') != (char *) NULL))
+      {
+        pooled=MagickFalse;
+        break;
+      }
+    (void) ConcatenateString(&arguments," \"");
+    (void) ConcatenateString(&arguments,p);
+    (void) ConcatenateString(&arguments,"\"");
+  }
+  paths[number_paths]=(const char *) NULL;
+  if ((output == (const char *) NULL) || (number_paths == 0) ||
+      (strstr(output,"%d") == (char *) NULL) ||
+      (strchr(output,'%') != strstr(output,"%d")) ||
+      (strchr(strstr(output,"%d")+2,'%') != (char *) NULL))
+    pooled=MagickFalse;
+  instance=(GhostscriptInstance *) NULL;
+  if (pooled != MagickFalse)
+    instance=AcquireGhostscriptInstance(ghost_info,arguments,
+      (display_callback *) NULL,MagickTrue);
+  if (instance == (GhostscriptInstance *) NULL)
+    pooled=MagickFalse;
+  else
+    {
+      if (*pages != '\0')
+        {
+          char
+            *text;
+
+          text=AcquireString(pages);
+          (void) ConcatenateString(&text,job);
+          job=DestroyString(job);
+          job=text;
+        }
+      *status=RunGhostscriptInstance(instance,(void *) NULL,job,paths,errors);
+      MoveGhostscriptPages(instance,output);
+      RelinquishGhostscriptInstance(instance);
+    }
+  job=DestroyString(job);
+  arguments=DestroyString(arguments);
+  paths=(const char **) RelinquishMagickMemory((void *) paths);
+  for (i=0; i < (ssize_t) argc; i++)
+    argv[i]=DestroyString(argv[i]);
+  argv=(char **) RelinquishMagickMemory(argv);
+  return(pooled);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R u n G h o s t s c r i p t I n s t a n c e                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  RunGhostscriptInstance() runs one document on a leased instance.  The job
+%  is bracketed by save and restore so the interpreter is returned to its
+%  warm state for the next lease.  It returns the interpreter status, 0 on
+%  success.
+%
+%  The format of the RunGhostscriptInstance method is:
+%
+%      int RunGhostscriptInstance(GhostscriptInstance *instance,void *handle,
+%        const char *job,const char **paths,char **errors)
+%
+%  A description of each parameter follows:
+%
+%    o instance: the leased instance.
+%
+%    o handle: the display handle passed to the display callback.
+%
+%    o job: the PostScript that renders the document, e.g. (file.pdf) run.
+%
+%    o paths: a NULL terminated list of the files the job reads.  They are
+%      permitted for reading under -dSAFER for the duration of the job.
+%
+%    o errors: return the interpreter output; free it with DestroyString().
+%
+*/
+MagickPrivate int RunGhostscriptInstance(GhostscriptInstance *instance,
+  void *handle,const char *job,const char **paths,char **errors)
+{
+  const GhostInfo
+    *ghost_info;
+
+  int
+    code,
+    status;
+
+  register ssize_t
+    i;
+
+  TimerInfo
+    timer;
+
+  assert(instance != (GhostscriptInstance *) NULL);
+  assert(job != (const char *) NULL);
+  GetTimerInfo(&timer);
+  ghost_info=instance->ghost_info;
+  instance->handle=handle;
+  if (instance->errors != (char *) NULL)
+    instance->errors=DestroyString(instance->errors);
+  if ((paths != (const char **) NULL) &&
+      (ghost_info->add_control_path != NULL))
+    for (i=0; paths[i] != (const char *) NULL; i++)
+      (void) (ghost_info->add_control_path)(instance->interpreter,
+        GhostscriptPermitFileReading,paths[i]);
+  code=0;
+  status=(ghost_info->run_string)(instance->interpreter,
+    "/MagickGhostscriptJob save def\n",0,&code);
+  if (status == 0)
+    status=(ghost_info->run_string)(instance->interpreter,job,0,&code);
+  if (status <= -100)
+    instance->stale=MagickTrue;  /* fatal or quit, the interpreter is gone */
+  else
+    if ((ghost_info->run_string)(instance->interpreter,
+         "clear cleardictstack MagickGhostscriptJob restore\n",0,&code) != 0)
+      instance->stale=MagickTrue;
+  if ((paths != (const char **) NULL) && (instance->stale == MagickFalse) &&
+      (ghost_info->remove_control_path != NULL))
+    for (i=0; paths[i] != (const char *) NULL; i++)
+      (void) (ghost_info->remove_control_path)(instance->interpreter,
+        GhostscriptPermitFileReading,paths[i]);
+  instance->jobs++;
+  if (status != 0)
+    instance->failures++;
+  instance->elapsed+=GetElapsedTime(&timer);
+  instance->handle=(void *) NULL;
+  if (errors != (char **) NULL)
+    *errors=instance->errors;
+  else
+    if (instance->errors != (char *) NULL)
+      instance->errors=DestroyString(instance->errors);
+  instance->errors=(char *) NULL;
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   U n r e g i s t e r D e l e g a t e L i s t H a n d l e r                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  UnregisterDelegateListHandler() removes a method registered with
+%  RegisterDelegateListHandler().
+%
+%  The format of the UnregisterDelegateListHandler method is:
+%
+%      void UnregisterDelegateListHandler(ListDelegateHandler handler)
+%
+%  A description of each parameter follows:
+%
+%    o handler: the method.
+%
+*/
+MagickPrivate void UnregisterDelegateListHandler(ListDelegateHandler handler)
+{
+  register ssize_t
+    i;
+
+  if (delegate_semaphore == (SemaphoreInfo *) NULL)
+    return;
+  LockSemaphoreInfo(delegate_semaphore);
+  for (i=0; i < MaxDelegateListHandlers; i++)
+    if (delegate_list_handlers[i] == handler)
+      delegate_list_handlers[i]=(ListDelegateHandler) NULL;
+  UnlockSemaphoreInfo(delegate_semaphore);
+}
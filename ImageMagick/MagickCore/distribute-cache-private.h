@@ -42,6 +42,21 @@ typedef struct _DistributeCacheInfo
   MagickBooleanType
     debug;
 
+  size_t
+    rows;
+
+  unsigned char
+    *read_ahead;
+
+  RectangleInfo
+    read_ahead_region;
+
+  MagickSizeType
+    read_ahead_length;
+
+  ssize_t
+    next_row;
+
   size_t
     signature;
 } DistributeCacheInfo;
@@ -62,6 +77,10 @@ extern MagickPrivate MagickBooleanType
   RelinquishDistributePixelCache(DistributeCacheInfo *);
 
 extern MagickPrivate MagickOffsetType
+  ReadDistributeCacheMetacontentRows(DistributeCacheInfo *,
+    const RectangleInfo *,const size_t,const MagickSizeType,unsigned char *),
+  ReadDistributeCachePixelRows(DistributeCacheInfo *,const RectangleInfo *,
+    const size_t,const MagickSizeType,unsigned char *magick_restrict),
   ReadDistributePixelCacheMetacontent(DistributeCacheInfo *,
     const RectangleInfo *,const MagickSizeType,unsigned char *),
   ReadDistributePixelCachePixels(DistributeCacheInfo *,const RectangleInfo *,
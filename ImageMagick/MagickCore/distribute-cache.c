@@ -77,6 +77,7 @@
 #undef MAGICKCORE_HAVE_DISTRIBUTE_CACHE
 #if defined(MAGICKCORE_HAVE_SOCKET) && defined(MAGICKCORE_THREAD_SUPPORT)
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <netdb.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
@@ -115,7 +116,10 @@
 */
 #define DPCHostname  "127.0.0.1"
 #define DPCPendingConnections  10
+#define DPCPipelineDepth  32
 #define DPCPort  6668
+#define DPCReadAheadExtent  4194304
+#define DPCRequestExtent  64
 #define DPCSessionKeyLength  8
 #ifndef MSG_NOSIGNAL
 #  define MSG_NOSIGNAL 0
@@ -173,6 +177,24 @@ static inline MagickOffsetType dpc_read(int file,const MagickSizeType length,
   return(i);
 }
 
+static inline void SetPixelCacheSocketOptions(SOCKET_TYPE file)
+{
+#if defined(MAGICKCORE_HAVE_DISTRIBUTE_CACHE) && defined(TCP_NODELAY)
+  int
+    one;
+
+  /*
+    Requests are small and answered in order, so do not let Nagle's algorithm
+    hold them back waiting on a delayed acknowledgement.
+  */
+  one=1;
+  (void) setsockopt(file,IPPROTO_TCP,TCP_NODELAY,CHAR_TYPE_CAST &one,
+    (socklen_t) sizeof(one));
+#else
+  magick_unreferenced(file);
+#endif
+}
+
 static int ConnectPixelCacheServer(const char *hostname,const int port,
   size_t *session_key,ExceptionInfo *exception)
 {
@@ -243,6 +265,7 @@ static int ConnectPixelCacheServer(const char *hostname,const int port,
         "DistributedPixelCache","'%s'",hostname);
       return(-1);
     }
+  SetPixelCacheSocketOptions(client_socket);
   count=recv(client_socket,CHAR_TYPE_CAST secret,MagickPathExtent,0);
   if (count != -1)
     {
@@ -355,6 +378,7 @@ MagickPrivate DistributeCacheInfo *AcquireDistributeCacheInfo(
       server_info->session_key=session_key;
       (void) CopyMagickString(server_info->hostname,hostname,MagickPathExtent);
       server_info->debug=IsEventLogging();
+      server_info->next_row=(-1);
     }
   hostname=DestroyString(hostname);
   return(server_info);
@@ -391,6 +415,9 @@ MagickPrivate DistributeCacheInfo *DestroyDistributeCacheInfo(
   assert(server_info->signature == MagickCoreSignature);
   if (server_info->file > 0)
     CLOSE_SOCKET(server_info->file);
+  if (server_info->read_ahead != (unsigned char *) NULL)
+    server_info->read_ahead=(unsigned char *) RelinquishMagickMemory(
+      server_info->read_ahead);
   server_info->signature=(~MagickCoreSignature);
   server_info=(DistributeCacheInfo *) RelinquishMagickMemory(server_info);
   return(server_info);
@@ -983,6 +1010,7 @@ MagickExport void DistributePixelCacheServer(const int port,
     client_socket=accept(server_socket,(struct sockaddr *) &address,&length);
     if (client_socket == -1)
       ThrowFatalException(CacheFatalError,"UnableToEstablishConnection");
+    SetPixelCacheSocketOptions(client_socket);
 #if defined(MAGICKCORE_THREAD_SUPPORT)
     status=pthread_create(&threads,&attributes,DistributePixelCacheClient,
       (void *) &client_socket);
@@ -1181,9 +1209,198 @@ MagickPrivate MagickBooleanType OpenDistributePixelCache(
   count=dpc_read(server_info->file,sizeof(status),(unsigned char *) &status);
   if (count != (MagickOffsetType) sizeof(status))
     return(MagickFalse);
+  server_info->rows=image->rows;
+  server_info->read_ahead_region.height=0;
+  server_info->next_row=(-1);
   return(status);
 }
 
+static MagickOffsetType PipelineDistributePixelCache(
+  DistributeCacheInfo *server_info,const unsigned char command,
+  const RectangleInfo *region,const size_t rows,const MagickSizeType length,
+  unsigned char *magick_restrict buffer)
+{
+  MagickOffsetType
+    count,
+    extent;
+
+  RectangleInfo
+    request;
+
+  register size_t
+    i,
+    j;
+
+  register unsigned char
+    *p;
+
+  size_t
+    number_requests;
+
+  unsigned char
+    message[DPCPipelineDepth*DPCRequestExtent];
+
+  /*
+    Send the requests for up to DPCPipelineDepth consecutive rows before
+    collecting any replies.  The server answers in order, so a run of rows
+    costs one round trip per batch rather than one per row.
+  */
+  request=(*region);
+  request.height=1;
+  extent=0;
+  for (i=0; i < rows; i+=number_requests)
+  {
+    number_requests=MagickMin(rows-i,DPCPipelineDepth);
+    p=message;
+    for (j=0; j < number_requests; j++)
+    {
+      *p++=command;
+      (void) memcpy(p,&server_info->session_key,
+        sizeof(server_info->session_key));
+      p+=sizeof(server_info->session_key);
+      (void) memcpy(p,&request.width,sizeof(request.width));
+      p+=sizeof(request.width);
+      (void) memcpy(p,&request.height,sizeof(request.height));
+      p+=sizeof(request.height);
+      (void) memcpy(p,&request.x,sizeof(request.x));
+      p+=sizeof(request.x);
+      (void) memcpy(p,&request.y,sizeof(request.y));
+      p+=sizeof(request.y);
+      (void) memcpy(p,&length,sizeof(length));
+      p+=sizeof(length);
+      request.y++;
+    }
+    count=dpc_send(server_info->file,p-message,message);
+    if (count != (MagickOffsetType) (p-message))
+      break;
+    for (j=0; j < number_requests; j++)
+    {
+      count=dpc_read(server_info->file,length,buffer+extent);
+      if (count != (MagickOffsetType) length)
+        break;
+      extent+=count;
+    }
+    if (j < number_requests)
+      break;
+  }
+  if (i < rows)
+    {
+      /*
+        Replies to the rest of the batch may still be in flight, so later
+        requests could read them as their own.  The server drops the cache
+        with the connection, so close it rather than reconnect.
+      */
+      if (server_info->file > 0)
+        CLOSE_SOCKET(server_info->file);
+      server_info->file=(-1);
+      return(-1);
+    }
+  return(extent);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e a d D i s t r i b u t e C a c h e M e t a c o n t e n t R o w s       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReadDistributeCacheMetacontentRows() reads metacontent from a run of
+%  rows of the distributed pixel cache, pipelining the row requests.  It
+%  returns the bytes read, or -1 if the run fails, in which case the
+%  connection to the server is closed.
+%
+%  The format of the ReadDistributeCacheMetacontentRows method is:
+%
+%      MagickOffsetType ReadDistributeCacheMetacontentRows(
+%        DistributeCacheInfo *server_info,const RectangleInfo *region,
+%        const size_t rows,const MagickSizeType length,
+%        unsigned char *metacontent)
+%
+%  A description of each parameter follows:
+%
+%    o server_info: the distributed cache info.
+%
+%    o region: the first row to read; its height is ignored.
+%
+%    o rows: the number of rows to read.
+%
+%    o length: the length in bytes of the metacontent of one row.
+%
+%    o metacontent: read the metacontent of each row, one after another, into
+%      this buffer.
+%
+*/
+MagickPrivate MagickOffsetType ReadDistributeCacheMetacontentRows(
+  DistributeCacheInfo *server_info,const RectangleInfo *region,
+  const size_t rows,const MagickSizeType length,unsigned char *metacontent)
+{
+  assert(server_info != (DistributeCacheInfo *) NULL);
+  assert(server_info->signature == MagickCoreSignature);
+  assert(region != (RectangleInfo *) NULL);
+  assert(metacontent != (unsigned char *) NULL);
+  if ((rows*length) > (MagickSizeType) SSIZE_MAX)
+    return(-1);
+  return(PipelineDistributePixelCache(server_info,'R',region,rows,length,
+    metacontent));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e a d D i s t r i b u t e C a c h e P i x e l R o w s                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReadDistributeCachePixelRows() reads pixels from a run of rows of the
+%  distributed pixel cache, pipelining the row requests.  It returns the
+%  bytes read, or -1 if the run fails, in which case the connection to the
+%  server is closed.
+%
+%  The format of the ReadDistributeCachePixelRows method is:
+%
+%      MagickOffsetType ReadDistributeCachePixelRows(
+%        DistributeCacheInfo *server_info,const RectangleInfo *region,
+%        const size_t rows,const MagickSizeType length,
+%        unsigned char *magick_restrict pixels)
+%
+%  A description of each parameter follows:
+%
+%    o server_info: the distributed cache info.
+%
+%    o region: the first row to read; its height is ignored.
+%
+%    o rows: the number of rows to read.
+%
+%    o length: the length in bytes of the pixels of one row.
+%
+%    o pixels: read the pixels of each row, one after another, into this
+%      buffer.
+%
+*/
+MagickPrivate MagickOffsetType ReadDistributeCachePixelRows(
+  DistributeCacheInfo *server_info,const RectangleInfo *region,
+  const size_t rows,const MagickSizeType length,
+  unsigned char *magick_restrict pixels)
+{
+  assert(server_info != (DistributeCacheInfo *) NULL);
+  assert(server_info->signature == MagickCoreSignature);
+  assert(region != (RectangleInfo *) NULL);
+  assert(pixels != (unsigned char *) NULL);
+  if ((rows*length) > (MagickSizeType) SSIZE_MAX)
+    return(-1);
+  return(PipelineDistributePixelCache(server_info,'r',region,rows,length,
+    pixels));
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1259,6 +1476,67 @@ MagickPrivate MagickOffsetType ReadDistributePixelCacheMetacontent(
   return(dpc_read(server_info->file,length,metacontent));
 }
 
+static MagickOffsetType ReadAheadDistributePixelCache(
+  DistributeCacheInfo *server_info,const RectangleInfo *region,
+  const MagickSizeType length,unsigned char *magick_restrict pixels)
+{
+  MagickOffsetType
+    count;
+
+  RectangleInfo
+    request;
+
+  size_t
+    rows;
+
+  ssize_t
+    y;
+
+  /*
+    Serve a single row from the rows read ahead if it is there.  Otherwise,
+    if it follows the row read last, fetch it together with the rows after
+    it in one pipelined batch.  Return 0 if the caller should read the row
+    itself.
+  */
+  y=server_info->next_row;
+  server_info->next_row=region->y+1;
+  request=server_info->read_ahead_region;
+  if ((request.height != 0) && (request.x == region->x) &&
+      (request.width == region->width) &&
+      (server_info->read_ahead_length == length) && (region->y >= request.y) &&
+      (region->y < (ssize_t) (request.y+request.height)))
+    {
+      (void) memcpy(pixels,server_info->read_ahead+(region->y-request.y)*
+        length,(size_t) length);
+      return((MagickOffsetType) length);
+    }
+  if ((region->y != y) || (length == 0) || (region->y < 0) ||
+      (region->y >= (ssize_t) server_info->rows))
+    return(0);
+  rows=(size_t) MagickMin(MagickMin(DPCPipelineDepth,DPCReadAheadExtent/
+    length),server_info->rows-region->y);
+  if (rows < 2)
+    return(0);
+  if (server_info->read_ahead == (unsigned char *) NULL)
+    {
+      server_info->read_ahead=(unsigned char *) AcquireQuantumMemory(1,
+        DPCReadAheadExtent);
+      if (server_info->read_ahead == (unsigned char *) NULL)
+        return(0);
+    }
+  request=(*region);
+  request.height=rows;
+  server_info->read_ahead_region.height=0;
+  count=PipelineDistributePixelCache(server_info,'r',&request,rows,length,
+    server_info->read_ahead);
+  if (count != (MagickOffsetType) (rows*length))
+    return(-1);
+  server_info->read_ahead_region=request;
+  server_info->read_ahead_length=length;
+  (void) memcpy(pixels,server_info->read_ahead,(size_t) length);
+  return((MagickOffsetType) length);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1271,7 +1549,9 @@ MagickPrivate MagickOffsetType ReadDistributePixelCacheMetacontent(
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  ReadDistributePixelCachePixels() reads pixels from the specified region of
-%  the distributed pixel cache.
+%  the distributed pixel cache.  When single rows are read in sequence, the
+%  rows that follow are read ahead in one pipelined batch and served from
+%  memory until the next write to the cache.
 %
 %  The format of the ReadDistributePixelCachePixels method is:
 %
@@ -1314,6 +1594,14 @@ MagickPrivate MagickOffsetType ReadDistributePixelCachePixels(
   assert(pixels != (unsigned char *) NULL);
   if (length > (MagickSizeType) SSIZE_MAX)
     return(-1);
+  if (region->height == 1)
+    {
+      count=ReadAheadDistributePixelCache(server_info,region,length,pixels);
+      if (count != 0)
+        return(count);
+    }
+  else
+    server_info->next_row=(-1);
   p=message;
   *p++='r';
   (void) memcpy(p,&server_info->session_key,sizeof(server_info->session_key));
@@ -1526,6 +1814,7 @@ MagickPrivate MagickOffsetType WriteDistributePixelCachePixels(
   assert(pixels != (const unsigned char *) NULL);
   if (length > (MagickSizeType) SSIZE_MAX)
     return(-1);
+  server_info->read_ahead_region.height=0;
   p=message;
   *p++='w';
   (void) memcpy(p,&server_info->session_key,sizeof(server_info->session_key));
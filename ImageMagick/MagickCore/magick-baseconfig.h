@@ -357,6 +357,9 @@
 #define MAGICKCORE_HAVE_GMTIME_R 1
 #endif
 
+/* Define to 1 if you have the `gsapi_add_control_path' function. */
+/* #undef HAVE_GSAPI_ADD_CONTROL_PATH */
+
 /* Compile with hugepage support */
 /* #undef HAVE_HUGEPAGES */
 
@@ -453,6 +453,7 @@ extern "C" {
 #define GetImageMean  PrependMagickMethod(GetImageMean)
 #define GetImageOption  PrependMagickMethod(GetImageOption)
 #define GetImagePixelCache  PrependMagickMethod(GetImagePixelCache)
+#define GetImagePixelCacheStatistics  PrependMagickMethod(GetImagePixelCacheStatistics)
 #define GetImagePixels  PrependMagickMethod(GetImagePixels)
 #define GetImageProfile  PrependMagickMethod(GetImageProfile)
 #define GetImageProperty  PrependMagickMethod(GetImageProperty)
@@ -982,6 +983,7 @@ extern "C" {
 #define RelinquishMagickMatrix  PrependMagickMethod(RelinquishMagickMatrix)
 #define RelinquishMagickMemory  PrependMagickMethod(RelinquishMagickMemory)
 #define RelinquishMagickResource  PrependMagickMethod(RelinquishMagickResource)
+#define RelinquishPixelCachePool  PrependMagickMethod(RelinquishPixelCachePool)
 #define RelinquishSemaphoreInfo  PrependMagickMethod(RelinquishSemaphoreInfo)
 #define RelinquishUniqueFileResource  PrependMagickMethod(RelinquishUniqueFileResource)
 #define RemapImage  PrependMagickMethod(RemapImage)
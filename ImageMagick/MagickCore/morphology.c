@@ -54,6 +54,7 @@
 #include "cache-view.h"
 #include "channel.h"
 #include "color-private.h"
+#include "effect-private.h"
 #include "enhance.h"
 #include "exception.h"
 #include "exception-private.h"
@@ -2549,6 +2550,563 @@ static void CalcKernelMetaData(KernelInfo *kernel)
 %    o exception: return any errors or warnings in this structure.
 %
 */
+/*
+  Flat erosion and dilation by a rectangle, line, diamond, or octagon.
+
+  A rectangle of set kernel elements (a line is a rectangle one pixel high
+  or wide) separates into a horizontal and a vertical line.  A centered
+  diamond or octagon, the elements within a Chebyshev radius r and a
+  city-block distance m (r <= m < 2r), is a square of radius m-r followed by
+  a diamond of radius 2r-m, and that diamond is in turn a diagonal and an
+  anti-diagonal line followed by one or two 4-connected plus shapes.
+
+  The minimum or maximum along each line is computed with the van Herk/
+  Gil-Werman algorithm: the line is cut into blocks the length of the
+  kernel line, and a forward running extremum within each block is combined
+  with a backward one, about three comparisons per sample whatever the
+  kernel size.  The source is read in bands of rows, each with the virtual
+  pixels its kernel reaches, and each pass shrinks the band buffer until
+  only the band itself remains, so the result matches MorphologyPrimitive()
+  exactly.  Bands overlap by the kernel height, less one.
+*/
+#define FlatMorphologyBandExtent  16777216UL
+#define FlatMorphologyPasses  6
+
+typedef struct _FlatPassInfo
+{
+  ssize_t
+    x,
+    y;
+
+  size_t
+    length;
+} FlatPassInfo;
+
+static inline Quantum FlatMorphologyExtremum(const MagickBooleanType dilate,
+  const Quantum p,const Quantum q)
+{
+  if (dilate != MagickFalse)
+    return(p > q ? p : q);
+  return(p < q ? p : q);
+}
+
+static void FlatMorphologyPass(const Image *image,
+  const Quantum *magick_restrict source,const size_t columns,const size_t rows,
+  Quantum *magick_restrict destination,const FlatPassInfo *pass,
+  const MagickBooleanType dilate,Quantum *magick_restrict scanlines,
+  const size_t extent)
+{
+  size_t
+    channels,
+    number_lines,
+    width;
+
+  ssize_t
+    line;
+
+  channels=GetPixelChannels(image);
+  if ((pass->x == 0) && (pass->y == 0))
+    {
+      /*
+        4-connected plus shape: the pixel and its four neighbors.
+      */
+      width=columns-2;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+      #pragma omp parallel for schedule(static,4) \
+        magick_threads(image,image,rows,1)
+#endif
+      for (line=0; line < (ssize_t) (rows-2); line++)
+      {
+        register const Quantum
+          *magick_restrict above,
+          *magick_restrict below,
+          *magick_restrict p;
+
+        register Quantum
+          *magick_restrict q;
+
+        register ssize_t
+          i;
+
+        above=source+line*columns*channels+channels;
+        p=above+columns*channels-channels;
+        below=p+columns*channels+channels;
+        q=destination+line*width*channels;
+        for (i=0; i < (ssize_t) (width*channels); i++)
+        {
+          Quantum
+            pixel;
+
+          pixel=FlatMorphologyExtremum(dilate,p[i],p[i+channels]);
+          pixel=FlatMorphologyExtremum(dilate,pixel,p[i+2*channels]);
+          pixel=FlatMorphologyExtremum(dilate,pixel,above[i]);
+          q[i]=FlatMorphologyExtremum(dilate,pixel,below[i]);
+        }
+      }
+      return;
+    }
+  width=columns-(pass->x != 0 ? pass->length-1 : 0);
+  if (pass->x == 0)
+    number_lines=columns;
+  else
+    if (pass->y == 0)
+      number_lines=rows;
+    else
+      number_lines=columns+rows-1;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static,4) \
+    magick_threads(image,image,number_lines,1)
+#endif
+  for (line=0; line < (ssize_t) number_lines; line++)
+  {
+    const int
+      id = GetOpenMPThreadId();
+
+    register const Quantum
+      *magick_restrict p;
+
+    register Quantum
+      *magick_restrict backward,
+      *magick_restrict forward,
+      *magick_restrict pixels;
+
+    register ssize_t
+      i,
+      u;
+
+    ssize_t
+      n,
+      stride,
+      x,
+      y;
+
+    /*
+      Gather the line, with all channels of each pixel adjacent.
+    */
+    x=0;
+    y=0;
+    if (pass->x == 0)
+      x=line;
+    else
+      if ((pass->y == 0) || (line < (ssize_t) rows))
+        y=line;
+      else
+        {
+          x=line-(ssize_t) rows+1;
+          y=pass->y > 0 ? 0 : (ssize_t) rows-1;
+        }
+    if (pass->x == 0)
+      n=(ssize_t) rows;
+    else
+      if (pass->y == 0)
+        n=(ssize_t) columns;
+      else
+        n=MagickMin((ssize_t) columns-x,pass->y > 0 ? (ssize_t) rows-y : y+1);
+    if (n < (ssize_t) pass->length)
+      continue;
+    pixels=scanlines+3*id*extent*channels;
+    forward=pixels+extent*channels;
+    backward=forward+extent*channels;
+    stride=(ssize_t) channels*(pass->x+pass->y*(ssize_t) columns);
+    p=source+(y*(ssize_t) columns+x)*(ssize_t) channels;
+    for (u=0; u < n; u++)
+    {
+      for (i=0; i < (ssize_t) channels; i++)
+        pixels[u*channels+i]=p[i];
+      p+=stride;
+    }
+    /*
+      Running extremum forward and backward within each block of the line.
+    */
+    for (u=0; u < n; u++)
+      if ((u % (ssize_t) pass->length) == 0)
+        for (i=0; i < (ssize_t) channels; i++)
+          forward[u*channels+i]=pixels[u*channels+i];
+      else
+        for (i=0; i < (ssize_t) channels; i++)
+          forward[u*channels+i]=FlatMorphologyExtremum(dilate,
+            forward[(u-1)*channels+i],pixels[u*channels+i]);
+    for (u=n-1; u >= 0; u--)
+      if ((u == (n-1)) || (((u+1) % (ssize_t) pass->length) == 0))
+        for (i=0; i < (ssize_t) channels; i++)
+          backward[u*channels+i]=pixels[u*channels+i];
+      else
+        for (i=0; i < (ssize_t) channels; i++)
+          backward[u*channels+i]=FlatMorphologyExtremum(dilate,
+            backward[(u+1)*channels+i],pixels[u*channels+i]);
+    /*
+      Each window spans at most two blocks.
+    */
+    if (pass->y < 0)
+      y-=(ssize_t) pass->length-1;
+    stride=(ssize_t) channels*(pass->x+pass->y*(ssize_t) width);
+    pixels=destination+(y*(ssize_t) width+x)*(ssize_t) channels;
+    for (u=0; u <= (n-(ssize_t) pass->length); u++)
+    {
+      for (i=0; i < (ssize_t) channels; i++)
+        pixels[i]=FlatMorphologyExtremum(dilate,backward[u*channels+i],
+          forward[(u+pass->length-1)*channels+i]);
+      pixels+=stride;
+    }
+  }
+}
+
+static size_t GetFlatKernelPasses(const KernelInfo *kernel,
+  FlatPassInfo *passes)
+{
+  register const MagickRealType
+    *k;
+
+  register ssize_t
+    u;
+
+  size_t
+    n;
+
+  ssize_t
+    diagonal,
+    m,
+    r,
+    square,
+    v;
+
+  /*
+    A rectangle of set elements: a horizontal and a vertical line.  Elements
+    must be above 0.5 to be set for both erosion and dilation.
+  */
+  n=0;
+  k=kernel->values;
+  for (u=0; u < (ssize_t) (kernel->width*kernel->height); u++)
+    if (IsNaN(k[u]) || (k[u] <= 0.5))
+      break;
+  if (u == (ssize_t) (kernel->width*kernel->height))
+    {
+      if (kernel->width > 1)
+        {
+          passes[n].x=1;
+          passes[n].y=0;
+          passes[n++].length=kernel->width;
+        }
+      if (kernel->height > 1)
+        {
+          passes[n].x=0;
+          passes[n].y=1;
+          passes[n++].length=kernel->height;
+        }
+      return(n);
+    }
+  /*
+    A centered diamond or octagon.
+  */
+  if ((kernel->width != kernel->height) || ((kernel->width % 2) == 0) ||
+      (kernel->x != kernel->y) || (kernel->x != (ssize_t) kernel->width/2))
+    return(0);
+  r=kernel->x;
+  m=0;
+  for (v=(-r); v <= r; v++)
+    for (u=(-r); u <= r; u++, k++)
+      if (!IsNaN(*k) && (*k > 0.5))
+        m=MagickMax(m,(ssize_t) (labs((long) u)+labs((long) v)));
+  if (m < r)
+    return(0);
+  k=kernel->values;
+  for (v=(-r); v <= r; v++)
+    for (u=(-r); u <= r; u++, k++)
+      if ((labs((long) u)+labs((long) v)) <= m)
+        {
+          if (IsNaN(*k) || (*k <= 0.5))
+            return(0);
+        }
+      else
+        if (!IsNaN(*k) && (*k >= 0.5))
+          return(0);
+  square=m-r;
+  if (square > 0)
+    {
+      passes[n].x=1;
+      passes[n].y=0;
+      passes[n++].length=(size_t) (2*square+1);
+      passes[n].x=0;
+      passes[n].y=1;
+      passes[n++].length=(size_t) (2*square+1);
+    }
+  diagonal=(2*r-m-1)/2;
+  if (diagonal > 0)
+    {
+      passes[n].x=1;
+      passes[n].y=1;
+      passes[n++].length=(size_t) (2*diagonal+1);
+      passes[n].x=1;
+      passes[n].y=(-1);
+      passes[n++].length=(size_t) (2*diagonal+1);
+    }
+  for (v=0; v < (2-(2*r-m) % 2); v++)
+  {
+    passes[n].x=0;
+    passes[n].y=0;
+    passes[n++].length=3;
+  }
+  return(n);
+}
+
+static ssize_t FlatMorphologyPrimitive(const Image *image,
+  Image *morphology_image,const MorphologyMethod method,
+  const KernelInfo *kernel,const OffsetInfo *offset,const FlatPassInfo *passes,
+  const size_t number_passes,ExceptionInfo *exception)
+{
+#define FlatMorphologyTag  "Morphology/Image"
+
+  CacheView
+    *image_view,
+    *morphology_view;
+
+  MagickBooleanType
+    dilate,
+    status;
+
+  MagickOffsetType
+    progress;
+
+  MagickSizeType
+    span;
+
+  MemoryInfo
+    *buffer_info,
+    *pixel_info;
+
+  Quantum
+    *magick_restrict buffer,
+    *magick_restrict pixels,
+    *magick_restrict scanlines,
+    *magick_restrict swap;
+
+  register ssize_t
+    j;
+
+  size_t
+    band,
+    changed,
+    channels,
+    columns,
+    *changes,
+    extent,
+    number_bands,
+    rows;
+
+  ssize_t
+    v,
+    y;
+
+  /*
+    Work in bands of rows, each read with the virtual pixels the kernel
+    reaches beyond it, so the buffers stay bounded whatever the image size.
+  */
+  channels=GetPixelChannels(image);
+  band=FlatMorphologyBandExtent/((image->columns+kernel->width-1)*channels*
+    sizeof(*pixels));
+  band=MagickMax(band,MagickMax(2*(kernel->height-1),64));
+  band=MagickMin(band,image->rows);
+  columns=image->columns+kernel->width-1;
+  rows=band+kernel->height-1;
+  extent=MagickMax(columns,rows);
+  pixel_info=AcquireVirtualMemory(columns*rows,channels*sizeof(*pixels));
+  buffer_info=AcquireVirtualMemory(columns*rows,channels*sizeof(*buffer));
+  scanlines=(Quantum *) AcquireQuantumMemory(3*extent*channels,
+    GetOpenMPMaximumThreads()*sizeof(*scanlines));
+  changes=(size_t *) AcquireQuantumMemory(GetOpenMPMaximumThreads(),
+    sizeof(*changes));
+  if ((pixel_info == (MemoryInfo *) NULL) ||
+      (buffer_info == (MemoryInfo *) NULL) ||
+      (scanlines == (Quantum *) NULL) || (changes == (size_t *) NULL))
+    {
+      if (changes != (size_t *) NULL)
+        changes=(size_t *) RelinquishMagickMemory(changes);
+      if (scanlines != (Quantum *) NULL)
+        scanlines=(Quantum *) RelinquishMagickMemory(scanlines);
+      if (buffer_info != (MemoryInfo *) NULL)
+        buffer_info=RelinquishVirtualMemory(buffer_info);
+      if (pixel_info != (MemoryInfo *) NULL)
+        pixel_info=RelinquishVirtualMemory(pixel_info);
+      (void) ThrowMagickException(exception,GetMagickModule(),
+        ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
+      return(-1);
+    }
+  for (j=0; j < (ssize_t) GetOpenMPMaximumThreads(); j++)
+    changes[j]=0;
+  dilate=method == DilateMorphology ? MagickTrue : MagickFalse;
+  status=MagickTrue;
+  progress=0;
+  number_bands=(image->rows+band-1)/band;
+  span=(MagickSizeType) (2*image->rows+number_bands*(kernel->height-1));
+  image_view=AcquireVirtualCacheView(image,exception);
+  morphology_view=AcquireAuthenticCacheView(morphology_image,exception);
+  for (y=0; (y < (ssize_t) image->rows) && (status != MagickFalse);
+       y+=(ssize_t) band)
+  {
+    size_t
+      band_rows;
+
+    /*
+      Read the band, and the rows its kernel reaches above and below it.
+    */
+    band_rows=MagickMin(band,image->rows-(size_t) y);
+    columns=image->columns+kernel->width-1;
+    rows=band_rows+kernel->height-1;
+    pixels=(Quantum *) GetVirtualMemoryBlob(pixel_info);
+    buffer=(Quantum *) GetVirtualMemoryBlob(buffer_info);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+    #pragma omp parallel for schedule(static,4) shared(progress,status) \
+      magick_threads(image,image,rows,1)
+#endif
+    for (v=0; v < (ssize_t) rows; v++)
+    {
+      register const Quantum
+        *magick_restrict p;
+
+      if (status == MagickFalse)
+        continue;
+      p=GetCacheViewVirtualPixels(image_view,-offset->x,y+v-offset->y,
+        columns,1,exception);
+      if (p == (const Quantum *) NULL)
+        {
+          status=MagickFalse;
+          continue;
+        }
+      (void) memcpy(pixels+v*columns*channels,p,columns*channels*
+        sizeof(*pixels));
+      if (image->progress_monitor != (MagickProgressMonitor) NULL)
+        {
+          MagickBooleanType
+            proceed;
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+          #pragma omp critical (MagickCore_FlatMorphologyPrimitive)
+#endif
+          proceed=SetImageProgress(image,FlatMorphologyTag,progress++,span);
+          if (proceed == MagickFalse)
+            status=MagickFalse;
+        }
+    }
+    /*
+      Each pass shrinks the buffer by the length of its line, less one.
+    */
+    for (j=0; (j < (ssize_t) number_passes) && (status != MagickFalse); j++)
+    {
+      FlatMorphologyPass(image,pixels,columns,rows,buffer,passes+j,dilate,
+        scanlines,extent);
+      if ((passes[j].x == 0) && (passes[j].y == 0))
+        {
+          columns-=2;
+          rows-=2;
+        }
+      else
+        {
+          if (passes[j].x != 0)
+            columns-=passes[j].length-1;
+          if (passes[j].y != 0)
+            rows-=passes[j].length-1;
+        }
+      swap=pixels;
+      pixels=buffer;
+      buffer=swap;
+    }
+    /*
+      Store the band, counting the changed pixel channels.
+    */
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+    #pragma omp parallel for schedule(static,4) shared(progress,status) \
+      magick_threads(image,morphology_image,band_rows,1)
+#endif
+    for (v=0; v < (ssize_t) band_rows; v++)
+    {
+      const int
+        id = GetOpenMPThreadId();
+
+      register const Quantum
+        *magick_restrict p,
+        *magick_restrict r;
+
+      register Quantum
+        *magick_restrict q;
+
+      register ssize_t
+        x;
+
+      if (status == MagickFalse)
+        continue;
+      p=GetCacheViewVirtualPixels(image_view,0,y+v,image->columns,1,
+        exception);
+      q=GetCacheViewAuthenticPixels(morphology_view,0,y+v,
+        morphology_image->columns,1,exception);
+      if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL))
+        {
+          status=MagickFalse;
+          continue;
+        }
+      r=pixels+v*columns*channels;
+      for (x=0; x < (ssize_t) image->columns; x++)
+      {
+        register ssize_t
+          i;
+
+        for (i=0; i < (ssize_t) channels; i++)
+        {
+          PixelChannel
+            channel;
+
+          PixelTrait
+            morphology_traits,
+            traits;
+
+          channel=GetPixelChannelChannel(image,i);
+          traits=GetPixelChannelTraits(image,channel);
+          morphology_traits=GetPixelChannelTraits(morphology_image,channel);
+          if ((traits == UndefinedPixelTrait) ||
+              (morphology_traits == UndefinedPixelTrait))
+            continue;
+          if ((traits & CopyPixelTrait) != 0)
+            {
+              SetPixelChannel(morphology_image,channel,p[i],q);
+              continue;
+            }
+          if (fabs((double) r[i]-p[i]) > MagickEpsilon)
+            changes[id]++;
+          SetPixelChannel(morphology_image,channel,ClampToQuantum(
+            (MagickRealType) r[i]),q);
+        }
+        p+=channels;
+        q+=GetPixelChannels(morphology_image);
+        r+=channels;
+      }
+      if (SyncCacheViewAuthenticPixels(morphology_view,exception) ==
+          MagickFalse)
+        status=MagickFalse;
+      if (image->progress_monitor != (MagickProgressMonitor) NULL)
+        {
+          MagickBooleanType
+            proceed;
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+          #pragma omp critical (MagickCore_FlatMorphologyPrimitive)
+#endif
+          proceed=SetImageProgress(image,FlatMorphologyTag,progress++,span);
+          if (proceed == MagickFalse)
+            status=MagickFalse;
+        }
+    }
+  }
+  morphology_view=DestroyCacheView(morphology_view);
+  image_view=DestroyCacheView(image_view);
+  changed=0;
+  for (j=0; j < (ssize_t) GetOpenMPMaximumThreads(); j++)
+    changed+=changes[j];
+  changes=(size_t *) RelinquishMagickMemory(changes);
+  scanlines=(Quantum *) RelinquishMagickMemory(scanlines);
+  buffer_info=RelinquishVirtualMemory(buffer_info);
+  pixel_info=RelinquishVirtualMemory(pixel_info);
+  return(status ? (ssize_t) changed : -1);
+}
+
 static ssize_t MorphologyPrimitive(const Image *image,Image *morphology_image,
   const MorphologyMethod method,const KernelInfo *kernel,const double bias,
   ExceptionInfo *exception)
@@ -2622,6 +3180,27 @@ static ssize_t MorphologyPrimitive(const Image *image,Image *morphology_image,
       break;
     }
   }
+  if (((method == ErodeMorphology) || (method == DilateMorphology)) &&
+      (image->write_mask == MagickFalse))
+    {
+      FlatPassInfo
+        passes[FlatMorphologyPasses];
+
+      size_t
+        number_passes;
+
+      /*
+        Flat rectangle, line, diamond, or octagon kernels (van Herk/Gil-Werman).
+      */
+      number_passes=GetFlatKernelPasses(kernel,passes);
+      if (number_passes != 0)
+        {
+          morphology_view=DestroyCacheView(morphology_view);
+          image_view=DestroyCacheView(image_view);
+          return(FlatMorphologyPrimitive(image,morphology_image,method,kernel,
+            &offset,passes,number_passes,exception));
+        }
+    }
   changed=0;
   changes=(size_t *) AcquireQuantumMemory(GetOpenMPMaximumThreads(),
     sizeof(*changes));
@@ -3598,6 +4177,78 @@ static ssize_t MorphologyPrimitiveDirect(Image *image,
   return(status ? (ssize_t) changed : -1);
 }
 
+/*
+  Return the standard deviation of a normalized Gaussian kernel, or of a
+  horizontal Blur kernel followed by its vertical rotation, together with
+  its radius.  Any other kernel returns 0.0.  Such a convolution can be
+  handed to the running box filters of BoxBlurImage().
+*/
+static double GetBlurKernelSigma(const KernelInfo *kernel,size_t *radius)
+{
+  const KernelInfo
+    *k;
+
+  double
+    sigma[2];
+
+  register ssize_t
+    i;
+
+  *radius=0;
+  if ((kernel->type == GaussianKernel) && (kernel->next == (KernelInfo *) NULL))
+    {
+      if ((kernel->width != kernel->height) || (kernel->x != kernel->y))
+        return(0.0);
+    }
+  else
+    if ((kernel->type != BlurKernel) || (kernel->height != 1) ||
+        (kernel->next == (KernelInfo *) NULL) ||
+        (kernel->next->type != BlurKernel) || (kernel->next->width != 1) ||
+        (kernel->next->height != kernel->width) ||
+        (kernel->next->y != kernel->x) ||
+        (kernel->next->next != (KernelInfo *) NULL))
+      return(0.0);
+  if ((kernel->x != (ssize_t) (kernel->width-1)/2) ||
+      ((kernel->width % 2) == 0))
+    return(0.0);
+  sigma[1]=0.0;
+  for (k=kernel, i=0; k != (KernelInfo *) NULL; k=k->next, i++)
+  {
+    double
+      sum,
+      variance;
+
+    register ssize_t
+      u,
+      v;
+
+    sum=0.0;
+    variance=0.0;
+    for (v=0; v < (ssize_t) k->height; v++)
+      for (u=0; u < (ssize_t) k->width; u++)
+      {
+        double
+          value;
+
+        value=(double) k->values[v*k->width+u];
+        if ((IsNaN(value) != 0) || (value < 0.0))
+          return(0.0);
+        sum+=value;
+        variance+=value*((u-k->x)*(u-k->x)+(v-k->y)*(v-k->y));
+      }
+    if (fabs(sum-1.0) > 1.0e-4)
+      return(0.0);
+    if ((k->width > 1) && (k->height > 1))
+      variance/=2.0;
+    sigma[i]=sqrt(variance);
+  }
+  if ((kernel->next != (KernelInfo *) NULL) &&
+      (fabs(sigma[0]-sigma[1]) > (1.0e-3*sigma[0])))
+    return(0.0);
+  *radius=(size_t) kernel->x;
+  return(sigma[0]);
+}
+
 /*
   Apply a Morphology by calling one of the above low level primitive
   application functions.  This function handles any iteration loops,
@@ -3666,6 +4317,23 @@ MagickPrivate Image *MorphologyApply(const Image *image,
   if ( iterations == 0 )
     return((Image *) NULL);   /* null operation - nothing to do! */
 
+  /* A single wide Gaussian blur costs the same whatever its radius with
+  ** running box filters (see BlurImage()).
+  */
+  if ( ( method == ConvolveMorphology || method == CorrelateMorphology ) &&
+       iterations == 1 && bias == 0.0 &&
+       ( compose == UndefinedCompositeOp || compose == NoCompositeOp ) ) {
+    double
+      sigma;
+
+    size_t
+      radius;
+
+    sigma=GetBlurKernelSigma(kernel,&radius);
+    if ( sigma > 0.0 && IsBoxBlurImage(image,radius,sigma) != MagickFalse )
+      return(BoxBlurImage(image,sigma,exception));
+  }
+
   kernel_limit = (size_t) iterations;
   if ( iterations < 0 )  /* negative interations = infinite (well alomst) */
      kernel_limit = image->columns>image->rows ? image->columns : image->rows;
@@ -1567,6 +1567,12 @@ MagickPrivate int NTGhostscriptLoadDLL(void)
     (lt_dlsym(ghost_handle,"gsapi_set_stdio"));
   ghost_info.revision=(int (MagickDLLCall *)(gsapi_revision_t *,int)) (
     lt_dlsym(ghost_handle,"gsapi_revision"));
+  ghost_info.set_display_callback=(int (MagickDLLCall *)(gs_main_instance *,
+    display_callback *)) (lt_dlsym(ghost_handle,"gsapi_set_display_callback"));
+  ghost_info.add_control_path=(int (MagickDLLCall *)(gs_main_instance *,int,
+    const char *)) (lt_dlsym(ghost_handle,"gsapi_add_control_path"));
+  ghost_info.remove_control_path=(int (MagickDLLCall *)(gs_main_instance *,
+    int,const char *)) (lt_dlsym(ghost_handle,"gsapi_remove_control_path"));
   UnlockSemaphoreInfo(ghost_semaphore);
   return(NTGhostscriptHasValidHandle());
 }
@@ -124,6 +124,7 @@ static const OptionInfo
   },
   CacheOptions[] =
   {
+    { "Compressed", CompressedCache, UndefinedOptionFlag, MagickFalse },
     { "Disk", DiskCache, UndefinedOptionFlag, MagickFalse },
     { "Distributed", DistributedCache, UndefinedOptionFlag, MagickFalse },
     { "Map", MapCache, UndefinedOptionFlag, MagickFalse },
@@ -506,6 +506,101 @@ MagickExport MagickRealType EncodePixelGamma(const MagickRealType pixel)
 %
 */
 
+static MagickBooleanType ExportCompactCharPixel(const Image *image,
+  const RectangleInfo *roi,const char *magick_restrict map,
+  const QuantumType *quantum_map,void *pixels)
+{
+  register const unsigned char
+    *magick_restrict p;
+
+  register ssize_t
+    i,
+    x;
+
+  register unsigned char
+    *magick_restrict q;
+
+  size_t
+    length,
+    number_channels;
+
+  ssize_t
+    offsets[MaxPixelChannels],
+    y;
+
+  /*
+    A cache:depth=8 cache already holds the 8-bit samples, copy them out
+    without the round trip through Quantum.  An offset of -1 exports 0.
+  */
+  length=strlen(map);
+  if (length > MaxPixelChannels)
+    return(MagickFalse);
+  for (i=0; i < (ssize_t) length; i++)
+  {
+    offsets[i]=(-1);
+    switch (quantum_map[i])
+    {
+      case RedQuantum:
+      case CyanQuantum:
+      {
+        offsets[i]=GetPixelChannelOffset(image,RedPixelChannel);
+        break;
+      }
+      case GreenQuantum:
+      case MagentaQuantum:
+      {
+        offsets[i]=GetPixelChannelOffset(image,GreenPixelChannel);
+        break;
+      }
+      case BlueQuantum:
+      case YellowQuantum:
+      {
+        offsets[i]=GetPixelChannelOffset(image,BluePixelChannel);
+        break;
+      }
+      case AlphaQuantum:
+      case OpacityQuantum:
+      {
+        if (GetPixelAlphaTraits(image) == UndefinedPixelTrait)
+          return(MagickFalse);
+        offsets[i]=GetPixelChannelOffset(image,AlphaPixelChannel);
+        break;
+      }
+      case BlackQuantum:
+      {
+        if (image->colorspace == CMYKColorspace)
+          offsets[i]=GetPixelChannelOffset(image,BlackPixelChannel);
+        break;
+      }
+      case IndexQuantum:
+        return(MagickFalse);
+      default:
+        break;
+    }
+  }
+  if ((roi->height == 0) ||
+      (GetVirtualCharPixels(image,roi->x,roi->y,roi->width) ==
+       (const unsigned char *) NULL) ||
+      (GetVirtualCharPixels(image,roi->x,roi->y+roi->height-1,roi->width) ==
+       (const unsigned char *) NULL))
+    return(MagickFalse);
+  number_channels=GetPixelChannels(image);
+  q=(unsigned char *) pixels;
+  for (y=0; y < (ssize_t) roi->height; y++)
+  {
+    p=GetVirtualCharPixels(image,roi->x,roi->y+y,roi->width);
+    if (p == (const unsigned char *) NULL)
+      break;
+    for (x=0; x < (ssize_t) roi->width; x++)
+    {
+      for (i=0; i < (ssize_t) length; i++)
+        *q++=offsets[i] < 0 ? 0 : p[offsets[i]];
+      p+=number_channels;
+    }
+  }
+  return(MagickTrue);
+}
+
 static void ExportCharPixel(const Image *image,const RectangleInfo *roi,
   const char *magick_restrict map,const QuantumType *quantum_map,void *pixels,
   ExceptionInfo *exception)
@@ -525,6 +620,8 @@ static void ExportCharPixel(const Image *image,const RectangleInfo *roi,
   ssize_t
     y;
 
+  if (ExportCompactCharPixel(image,roi,map,quantum_map,pixels) != MagickFalse)
+    return;
   q=(unsigned char *) pixels;
   if (LocaleCompare(map,"BGR") == 0)
     {
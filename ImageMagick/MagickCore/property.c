@@ -2791,6 +2791,24 @@ MagickExport const char *GetMagickProperty(ImageInfo *image_info,
     }
     case 'c':
     {
+      if (LocaleCompare("cache:statistics",property) == 0)
+        {
+          CacheStatistics
+            statistics;
+
+          WarnNoImageReturn("\"%%[%s]\"",property);
+          if (GetImagePixelCacheStatistics(image,&statistics) == MagickFalse)
+            break;
+          (void) FormatLocaleString(value,MagickPathExtent,
+            "type=%s requests=%.20g direct=%.20g staged=%.20g virtual=%.20g "
+            "read=%.20g written=%.20g lock-wait=%g",CommandOptionToMnemonic(
+            MagickCacheOptions,(ssize_t) GetImagePixelCacheType(image)),
+            (double) statistics.nexus_requests,(double)
+            statistics.direct_regions,(double) statistics.staged_regions,
+            (double) statistics.virtual_pixels,(double) statistics.bytes_read,
+            (double) statistics.bytes_written,statistics.lock_wait);
+          break;
+        }
       if (LocaleCompare("channels",property) == 0)
         {
           WarnNoImageReturn("\"%%[%s]\"",property);
@@ -52,6 +52,7 @@
 #include "exception.h"
 #include "exception-private.h"
 #include "cache.h"
+#include "cache-private.h"
 #include "constitute.h"
 #include "delegate.h"
 #include "geometry.h"
@@ -3863,6 +3864,92 @@ static void ExportRGBOQuantum(const Image *image,QuantumInfo *quantum_info,
   }
 }
 
+static MagickBooleanType ExportCharQuantum(const Image *image,
+  const QuantumType quantum_type,const MagickSizeType number_pixels,
+  unsigned char *magick_restrict q)
+{
+  PixelChannel
+    channels[5];
+
+  register const unsigned char
+    *magick_restrict p;
+
+  register ssize_t
+    i,
+    x;
+
+  size_t
+    number_channels;
+
+  ssize_t
+    count,
+    offsets[5];
+
+  /*
+    Copy the 8-bit samples a cache:depth=8 cache keeps straight into the
+    8-bit quantum buffer, without the round trip through Quantum.
+  */
+  count=0;
+  switch (quantum_type)
+  {
+    case BGRQuantum:
+    case BGRAQuantum:
+    {
+      channels[count++]=BluePixelChannel;
+      channels[count++]=GreenPixelChannel;
+      channels[count++]=RedPixelChannel;
+      if (quantum_type == BGRAQuantum)
+        channels[count++]=AlphaPixelChannel;
+      break;
+    }
+    case CMYKQuantum:
+    case CMYKAQuantum:
+    {
+      if (image->colorspace != CMYKColorspace)
+        return(MagickFalse);
+      channels[count++]=CyanPixelChannel;
+      channels[count++]=MagentaPixelChannel;
+      channels[count++]=YellowPixelChannel;
+      channels[count++]=BlackPixelChannel;
+      if (quantum_type == CMYKAQuantum)
+        channels[count++]=AlphaPixelChannel;
+      break;
+    }
+    case RGBQuantum:
+    case RGBAQuantum:
+    {
+      channels[count++]=RedPixelChannel;
+      channels[count++]=GreenPixelChannel;
+      channels[count++]=BluePixelChannel;
+      if (quantum_type == RGBAQuantum)
+        channels[count++]=AlphaPixelChannel;
+      break;
+    }
+    default:
+      return(MagickFalse);
+  }
+  for (i=0; i < count; i++)
+  {
+    /*
+      A missing channel exports a default value, leave it to the slow path.
+    */
+    if (GetPixelChannelTraits(image,channels[i]) == UndefinedPixelTrait)
+      return(MagickFalse);
+    offsets[i]=GetPixelChannelOffset(image,channels[i]);
+  }
+  p=GetVirtualCharPixelQueue(image);
+  if (p == (const unsigned char *) NULL)
+    return(MagickFalse);
+  number_channels=GetPixelChannels(image);
+  for (x=0; x < (ssize_t) number_pixels; x++)
+  {
+    for (i=0; i < count; i++)
+      *q++=p[offsets[i]];
+    p+=number_channels;
+  }
+  return(MagickTrue);
+}
+
 MagickExport size_t ExportQuantumPixels(const Image *image,
   CacheView *image_view,QuantumInfo *quantum_info,
   const QuantumType quantum_type,unsigned char *magick_restrict pixels,
@@ -3960,6 +4047,12 @@ MagickExport size_t ExportQuantumPixels(const Image *image,
   q=pixels;
   ResetQuantumState(quantum_info);
   extent=GetQuantumExtent(image,quantum_info,quantum_type);
+  if ((image_view == (CacheView *) NULL) && (quantum_info->depth == 8) &&
+      (quantum_info->pad == 0) &&
+      (quantum_info->format != FloatingPointQuantumFormat) &&
+      (quantum_info->alpha_type != AssociatedQuantumAlpha) &&
+      (ExportCharQuantum(image,quantum_type,number_pixels,q) != MagickFalse))
+    return(extent);
   switch (quantum_type)
   {
     case AlphaQuantum:
@@ -2338,54 +2338,127 @@ MagickExport Image *ResampleImage(const Image *image,const double x_resolution,
 typedef struct _ContributionInfo
 {
   double
-    weight;
+    *weight;
 
   ssize_t
-    pixel;
+    start,
+    stop,
+    nearest;
 } ContributionInfo;
 
-static ContributionInfo **DestroyContributionThreadSet(
-  ContributionInfo **contribution)
+static ContributionInfo *DestroyContributionTable(
+  ContributionInfo *contribution)
 {
-  register ssize_t
-    i;
-
-  assert(contribution != (ContributionInfo **) NULL);
-  for (i=0; i < (ssize_t) GetMagickResourceLimit(ThreadResource); i++)
-    if (contribution[i] != (ContributionInfo *) NULL)
-      contribution[i]=(ContributionInfo *) RelinquishAlignedMemory(
-        contribution[i]);
-  contribution=(ContributionInfo **) RelinquishMagickMemory(contribution);
+  assert(contribution != (ContributionInfo *) NULL);
+  if (contribution[0].weight != (double *) NULL)
+    contribution[0].weight=(double *) RelinquishAlignedMemory(
+      contribution[0].weight);
+  contribution=(ContributionInfo *) RelinquishMagickMemory(contribution);
   return(contribution);
 }
 
-static ContributionInfo **AcquireContributionThreadSet(const size_t count)
+static ContributionInfo *AcquireContributionTable(
+  const ResizeFilter *resize_filter,const double factor,const double support,
+  const double scale,const size_t extent,const size_t number_contributions)
 {
-  register ssize_t
-    i;
-
   ContributionInfo
-    **contribution;
+    *contribution;
+
+  double
+    *weights;
+
+  register ssize_t
+    x;
 
   size_t
-    number_threads;
+    stride;
 
-  number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
-  contribution=(ContributionInfo **) AcquireQuantumMemory(number_threads,
+  /*
+    The filter weights only depend on the output position, so compute them
+    once for every output column (or row) rather than once per pixel.
+  */
+  contribution=(ContributionInfo *) AcquireQuantumMemory(number_contributions,
     sizeof(*contribution));
-  if (contribution == (ContributionInfo **) NULL)
-    return((ContributionInfo **) NULL);
-  (void) ResetMagickMemory(contribution,0,number_threads*sizeof(*contribution));
-  for (i=0; i < (ssize_t) number_threads; i++)
+  if (contribution == (ContributionInfo *) NULL)
+    return((ContributionInfo *) NULL);
+  stride=(size_t) (2.0*support+3.0);
+  weights=(double *) MagickAssumeAligned(AcquireAlignedMemory(
+    number_contributions,stride*sizeof(*weights)));
+  if (weights == (double *) NULL)
+    {
+      contribution=(ContributionInfo *) RelinquishMagickMemory(contribution);
+      return((ContributionInfo *) NULL);
+    }
+  for (x=0; x < (ssize_t) number_contributions; x++)
   {
-    contribution[i]=(ContributionInfo *) MagickAssumeAligned(
-      AcquireAlignedMemory(count,sizeof(**contribution)));
-    if (contribution[i] == (ContributionInfo *) NULL)
-      return(DestroyContributionThreadSet(contribution));
+    double
+      bisect,
+      density;
+
+    register ssize_t
+      i;
+
+    bisect=(double) (x+0.5)/factor+MagickEpsilon;
+    contribution[x].weight=weights+x*stride;
+    contribution[x].start=(ssize_t) MagickMax(bisect-support+0.5,0.0);
+    contribution[x].stop=(ssize_t) MagickMin(bisect+support+0.5,(double)
+      extent);
+    contribution[x].nearest=(ssize_t) (MagickMin(MagickMax(bisect,(double)
+      contribution[x].start),(double) contribution[x].stop-1.0)+0.5);
+    density=0.0;
+    for (i=0; i < (contribution[x].stop-contribution[x].start); i++)
+    {
+      contribution[x].weight[i]=GetResizeFilterWeight(resize_filter,scale*
+        ((double) (contribution[x].start+i)-bisect+0.5));
+      density+=contribution[x].weight[i];
+    }
+    if ((density != 0.0) && (density != 1.0))
+      {
+        /*
+          Normalize.
+        */
+        density=PerceptibleReciprocal(density);
+        for (i=0; i < (contribution[x].stop-contribution[x].start); i++)
+          contribution[x].weight[i]*=density;
+      }
   }
   return(contribution);
 }
 
+static MagickBooleanType IsUnblendedResize(const Image *image,
+  const Image *resize_image)
+{
+  register ssize_t
+    i;
+
+  /*
+    Every channel is a plain weighted sum at the same offset in both images:
+    no alpha blending, copied channels, or write mask to honor per pixel.
+  */
+  if ((resize_image->write_mask != MagickFalse) ||
+      (GetPixelChannels(image) != GetPixelChannels(resize_image)))
+    return(MagickFalse);
+  for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+  {
+    PixelChannel
+      channel;
+
+    PixelTrait
+      resize_traits,
+      traits;
+
+    channel=GetPixelChannelChannel(image,i);
+    traits=GetPixelChannelTraits(image,channel);
+    resize_traits=GetPixelChannelTraits(resize_image,channel);
+    if ((traits == UndefinedPixelTrait) ||
+        (resize_traits == UndefinedPixelTrait) ||
+        ((resize_traits & (BlendPixelTrait | CopyPixelTrait)) != 0) ||
+        (GetPixelChannelOffset(resize_image,channel) != i))
+      return(MagickFalse);
+  }
+  return(MagickTrue);
+}
+
 static MagickBooleanType HorizontalFilter(const ResizeFilter *resize_filter,
   const Image *image,Image *resize_image,const double x_factor,
   const MagickSizeType span,MagickOffsetType *offset,ExceptionInfo *exception)
@@ -2400,17 +2473,18 @@ static MagickBooleanType HorizontalFilter(const ResizeFilter *resize_filter,
     storage_class;
 
   ContributionInfo
-    **magick_restrict contributions;
+    *magick_restrict contribution;
 
   MagickBooleanType
-    status;
+    status,
+    unblended;
 
   double
     scale,
     support;
 
   ssize_t
-    x;
+    y;
 
   /*
     Apply filter to resize horizontally from image to resize image.
@@ -2428,89 +2502,90 @@ static MagickBooleanType HorizontalFilter(const ResizeFilter *resize_filter,
       support=(double) 0.5;
       scale=1.0;
     }
-  contributions=AcquireContributionThreadSet((size_t) (2.0*support+3.0));
-  if (contributions == (ContributionInfo **) NULL)
+  scale=PerceptibleReciprocal(scale);
+  contribution=AcquireContributionTable(resize_filter,x_factor,support,scale,
+    image->columns,resize_image->columns);
+  if (contribution == (ContributionInfo *) NULL)
     {
       (void) ThrowMagickException(exception,GetMagickModule(),
         ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
       return(MagickFalse);
     }
   status=MagickTrue;
-  scale=PerceptibleReciprocal(scale);
+  unblended=IsUnblendedResize(image,resize_image);
   image_view=AcquireVirtualCacheView(image,exception);
   resize_view=AcquireAuthenticCacheView(resize_image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
   #pragma omp parallel for schedule(static,4) shared(status) \
-    magick_threads(image,resize_image,resize_image->columns,1)
+    magick_threads(image,resize_image,resize_image->rows,1)
 #endif
-  for (x=0; x < (ssize_t) resize_image->columns; x++)
+  for (y=0; y < (ssize_t) resize_image->rows; y++)
   {
-    const int
-      id = GetOpenMPThreadId();
-
-    double
-      bisect,
-      density;
-
     register const Quantum
       *magick_restrict p;
 
-    register ContributionInfo
-      *magick_restrict contribution;
-
     register Quantum
       *magick_restrict q;
 
     register ssize_t
-      y;
-
-    ssize_t
-      n,
-      start,
-      stop;
+      x;
 
     if (status == MagickFalse)
       continue;
-    bisect=(double) (x+0.5)/x_factor+MagickEpsilon;
-    start=(ssize_t) MagickMax(bisect-support+0.5,0.0);
-    stop=(ssize_t) MagickMin(bisect+support+0.5,(double) image->columns);
-    density=0.0;
-    contribution=contributions[id];
-    for (n=0; n < (stop-start); n++)
-    {
-      contribution[n].pixel=start+n;
-      contribution[n].weight=GetResizeFilterWeight(resize_filter,scale*
-        ((double) (start+n)-bisect+0.5));
-      density+=contribution[n].weight;
-    }
-    if (n == 0)
-      continue;
-    if ((density != 0.0) && (density != 1.0))
-      {
-        register ssize_t
-          i;
-
-        /*
-          Normalize.
-        */
-        density=PerceptibleReciprocal(density);
-        for (i=0; i < n; i++)
-          contribution[i].weight*=density;
-      }
-    p=GetCacheViewVirtualPixels(image_view,contribution[0].pixel,0,(size_t)
-      (contribution[n-1].pixel-contribution[0].pixel+1),image->rows,exception);
-    q=QueueCacheViewAuthenticPixels(resize_view,x,0,1,resize_image->rows,
+    p=GetCacheViewVirtualPixels(image_view,0,y,image->columns,1,exception);
+    q=QueueCacheViewAuthenticPixels(resize_view,0,y,resize_image->columns,1,
       exception);
     if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL))
       {
         status=MagickFalse;
         continue;
       }
-    for (y=0; y < (ssize_t) resize_image->rows; y++)
+    for (x=0; x < (ssize_t) resize_image->columns; x++)
     {
       register ssize_t
         i;
 
+      ssize_t
+        n;
+
+      n=contribution[x].stop-contribution[x].start;
+      if (n <= 0)
+        {
+          q+=GetPixelChannels(resize_image);
+          continue;
+        }
+      if (unblended != MagickFalse)
+        {
+          double
+            pixel[MaxPixelChannels];
+
+          register const double
+            *magick_restrict weight;
+
+          register const Quantum
+            *magick_restrict r;
+
+          register ssize_t
+            j;
+
+          /*
+            Weighted sum of adjacent source pixels, all channels at once.
+          */
+          for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+            pixel[i]=0.0;
+          weight=contribution[x].weight;
+          r=p+contribution[x].start*GetPixelChannels(image);
+          for (j=0; j < n; j++)
+          {
+            for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+              pixel[i]+=weight[j]*r[i];
+            r+=GetPixelChannels(image);
+          }
+          for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+            q[i]=ClampToQuantum(pixel[i]);
+          q+=GetPixelChannels(resize_image);
+          continue;
+        }
       for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
       {
         double
@@ -2540,10 +2615,7 @@ static MagickBooleanType HorizontalFilter(const ResizeFilter *resize_filter,
         if (((resize_traits & CopyPixelTrait) != 0) ||
             (GetPixelWriteMask(resize_image,q) == 0))
           {
-            j=(ssize_t) (MagickMin(MagickMax(bisect,(double) start),(double)
-              stop-1.0)+0.5);
-            k=y*(contribution[n-1].pixel-contribution[0].pixel+1)+
-              (contribution[j-start].pixel-contribution[0].pixel);
+            k=contribution[x].nearest;
             SetPixelChannel(resize_image,channel,p[k*GetPixelChannels(image)+i],
               q);
             continue;
@@ -2556,9 +2628,8 @@ static MagickBooleanType HorizontalFilter(const ResizeFilter *resize_filter,
             */
             for (j=0; j < n; j++)
             {
-              k=y*(contribution[n-1].pixel-contribution[0].pixel+1)+
-                (contribution[j].pixel-contribution[0].pixel);
-              alpha=contribution[j].weight;
+              k=contribution[x].start+j;
+              alpha=contribution[x].weight[j];
               pixel+=alpha*p[k*GetPixelChannels(image)+i];
             }
             SetPixelChannel(resize_image,channel,ClampToQuantum(pixel),q);
@@ -2570,9 +2641,8 @@ static MagickBooleanType HorizontalFilter(const ResizeFilter *resize_filter,
         gamma=0.0;
         for (j=0; j < n; j++)
         {
-          k=y*(contribution[n-1].pixel-contribution[0].pixel+1)+
-            (contribution[j].pixel-contribution[0].pixel);
-          alpha=contribution[j].weight*QuantumScale*
+          k=contribution[x].start+j;
+          alpha=contribution[x].weight[j]*QuantumScale*
             GetPixelAlpha(image,p+k*GetPixelChannels(image));
           pixel+=alpha*p[k*GetPixelChannels(image)+i];
           gamma+=alpha;
@@ -2599,7 +2669,7 @@ static MagickBooleanType HorizontalFilter(const ResizeFilter *resize_filter,
   }
   resize_view=DestroyCacheView(resize_view);
   image_view=DestroyCacheView(image_view);
-  contributions=DestroyContributionThreadSet(contributions);
+  contribution=DestroyContributionTable(contribution);
   return(status);
 }
 
@@ -2615,14 +2685,15 @@ static MagickBooleanType VerticalFilter(const ResizeFilter *resize_filter,
     storage_class;
 
   ContributionInfo
-    **magick_restrict contributions;
+    *magick_restrict contribution;
 
   double
     scale,
     support;
 
   MagickBooleanType
-    status;
+    status,
+    unblended;
 
   ssize_t
     y;
@@ -2643,15 +2714,17 @@ static MagickBooleanType VerticalFilter(const ResizeFilter *resize_filter,
       support=(double) 0.5;
       scale=1.0;
     }
-  contributions=AcquireContributionThreadSet((size_t) (2.0*support+3.0));
-  if (contributions == (ContributionInfo **) NULL)
+  scale=PerceptibleReciprocal(scale);
+  contribution=AcquireContributionTable(resize_filter,y_factor,support,scale,
+    image->rows,resize_image->rows);
+  if (contribution == (ContributionInfo *) NULL)
     {
       (void) ThrowMagickException(exception,GetMagickModule(),
         ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
       return(MagickFalse);
     }
   status=MagickTrue;
-  scale=PerceptibleReciprocal(scale);
+  unblended=IsUnblendedResize(image,resize_image);
   image_view=AcquireVirtualCacheView(image,exception);
   resize_view=AcquireAuthenticCacheView(resize_image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
@@ -2660,19 +2733,9 @@ static MagickBooleanType VerticalFilter(const ResizeFilter *resize_filter,
 #endif
   for (y=0; y < (ssize_t) resize_image->rows; y++)
   {
-    const int
-      id = GetOpenMPThreadId();
-
-    double
-      bisect,
-      density;
-
     register const Quantum
       *magick_restrict p;
 
-    register ContributionInfo
-      *magick_restrict contribution;
-
     register Quantum
       *magick_restrict q;
 
@@ -2680,41 +2743,15 @@ static MagickBooleanType VerticalFilter(const ResizeFilter *resize_filter,
       x;
 
     ssize_t
-      n,
-      start,
-      stop;
+      n;
 
     if (status == MagickFalse)
       continue;
-    bisect=(double) (y+0.5)/y_factor+MagickEpsilon;
-    start=(ssize_t) MagickMax(bisect-support+0.5,0.0);
-    stop=(ssize_t) MagickMin(bisect+support+0.5,(double) image->rows);
-    density=0.0;
-    contribution=contributions[id];
-    for (n=0; n < (stop-start); n++)
-    {
-      contribution[n].pixel=start+n;
-      contribution[n].weight=GetResizeFilterWeight(resize_filter,scale*
-        ((double) (start+n)-bisect+0.5));
-      density+=contribution[n].weight;
-    }
-    if (n == 0)
+    n=contribution[y].stop-contribution[y].start;
+    if (n <= 0)
       continue;
-    if ((density != 0.0) && (density != 1.0))
-      {
-        register ssize_t
-          i;
-
-        /*
-          Normalize.
-        */
-        density=PerceptibleReciprocal(density);
-        for (i=0; i < n; i++)
-          contribution[i].weight*=density;
-      }
-    p=GetCacheViewVirtualPixels(image_view,0,contribution[0].pixel,
-      image->columns,(size_t) (contribution[n-1].pixel-contribution[0].pixel+1),
-      exception);
+    p=GetCacheViewVirtualPixels(image_view,0,contribution[y].start,
+      image->columns,(size_t) n,exception);
     q=QueueCacheViewAuthenticPixels(resize_view,0,y,resize_image->columns,1,
       exception);
     if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL))
@@ -2727,6 +2764,38 @@ static MagickBooleanType VerticalFilter(const ResizeFilter *resize_filter,
       register ssize_t
         i;
 
+      if (unblended != MagickFalse)
+        {
+          double
+            pixel[MaxPixelChannels];
+
+          register const double
+            *magick_restrict weight;
+
+          register const Quantum
+            *magick_restrict r;
+
+          register ssize_t
+            j;
+
+          /*
+            Weighted sum of the source rows, all channels at once.
+          */
+          for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+            pixel[i]=0.0;
+          weight=contribution[y].weight;
+          r=p+x*GetPixelChannels(image);
+          for (j=0; j < n; j++)
+          {
+            for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+              pixel[i]+=weight[j]*r[i];
+            r+=image->columns*GetPixelChannels(image);
+          }
+          for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+            q[i]=ClampToQuantum(pixel[i]);
+          q+=GetPixelChannels(resize_image);
+          continue;
+        }
       for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
       {
         double
@@ -2756,9 +2825,7 @@ static MagickBooleanType VerticalFilter(const ResizeFilter *resize_filter,
         if (((resize_traits & CopyPixelTrait) != 0) ||
             (GetPixelWriteMask(resize_image,q) == 0))
           {
-            j=(ssize_t) (MagickMin(MagickMax(bisect,(double) start),(double)
-              stop-1.0)+0.5);
-            k=(ssize_t) ((contribution[j-start].pixel-contribution[0].pixel)*
+            k=(ssize_t) ((contribution[y].nearest-contribution[y].start)*
               image->columns+x);
             SetPixelChannel(resize_image,channel,p[k*GetPixelChannels(image)+i],
               q);
@@ -2772,9 +2839,8 @@ static MagickBooleanType VerticalFilter(const ResizeFilter *resize_filter,
             */
             for (j=0; j < n; j++)
             {
-              k=(ssize_t) ((contribution[j].pixel-contribution[0].pixel)*
-                image->columns+x);
-              alpha=contribution[j].weight;
+              k=(ssize_t) (j*image->columns+x);
+              alpha=contribution[y].weight[j];
               pixel+=alpha*p[k*GetPixelChannels(image)+i];
             }
             SetPixelChannel(resize_image,channel,ClampToQuantum(pixel),q);
@@ -2783,9 +2849,8 @@ static MagickBooleanType VerticalFilter(const ResizeFilter *resize_filter,
         gamma=0.0;
         for (j=0; j < n; j++)
         {
-          k=(ssize_t) ((contribution[j].pixel-contribution[0].pixel)*
-            image->columns+x);
-          alpha=contribution[j].weight*QuantumScale*GetPixelAlpha(image,p+k*
+          k=(ssize_t) (j*image->columns+x);
+          alpha=contribution[y].weight[j]*QuantumScale*GetPixelAlpha(image,p+k*
             GetPixelChannels(image));
           pixel+=alpha*p[k*GetPixelChannels(image)+i];
           gamma+=alpha;
@@ -2812,7 +2877,7 @@ static MagickBooleanType VerticalFilter(const ResizeFilter *resize_filter,
   }
   resize_view=DestroyCacheView(resize_view);
   image_view=DestroyCacheView(image_view);
-  contributions=DestroyContributionThreadSet(contributions);
+  contribution=DestroyContributionTable(contribution);
   return(status);
 }
 
@@ -2903,7 +2968,7 @@ MagickExport Image *ResizeImage(const Image *image,const size_t columns,
   offset=0;
   if (x_factor > y_factor)
     {
-      span=(MagickSizeType) (filter_image->columns+rows);
+      span=(MagickSizeType) (filter_image->rows+rows);
       status=HorizontalFilter(resize_filter,image,filter_image,x_factor,span,
         &offset,exception);
       status&=VerticalFilter(resize_filter,filter_image,resize_image,y_factor,
@@ -2911,7 +2976,7 @@ MagickExport Image *ResizeImage(const Image *image,const size_t columns,
     }
   else
     {
-      span=(MagickSizeType) (filter_image->rows+columns);
+      span=(MagickSizeType) (filter_image->rows+rows);
       status=VerticalFilter(resize_filter,image,filter_image,y_factor,span,
         &offset,exception);
       status&=HorizontalFilter(resize_filter,filter_image,resize_image,x_factor,
@@ -3624,6 +3689,311 @@ MagickExport Image *ScaleImage(const Image *image,const size_t columns,
 %    o exception: return any errors or warnings in this structure.
 %
 */
+static double **DestroyThumbnailThreadSet(double **scanline)
+{
+  register ssize_t
+    i;
+
+  assert(scanline != (double **) NULL);
+  for (i=0; i < (ssize_t) GetMagickResourceLimit(ThreadResource); i++)
+    if (scanline[i] != (double *) NULL)
+      scanline[i]=(double *) RelinquishAlignedMemory(scanline[i]);
+  scanline=(double **) RelinquishMagickMemory(scanline);
+  return(scanline);
+}
+
+static double **AcquireThumbnailThreadSet(const size_t count)
+{
+  double
+    **scanline;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_threads;
+
+  number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
+  scanline=(double **) AcquireQuantumMemory(number_threads,sizeof(*scanline));
+  if (scanline == (double **) NULL)
+    return((double **) NULL);
+  (void) ResetMagickMemory(scanline,0,number_threads*sizeof(*scanline));
+  for (i=0; i < (ssize_t) number_threads; i++)
+  {
+    scanline[i]=(double *) MagickAssumeAligned(AcquireAlignedMemory(count,
+      sizeof(**scanline)));
+    if (scanline[i] == (double *) NULL)
+      return(DestroyThumbnailThreadSet(scanline));
+  }
+  return(scanline);
+}
+
+static Image *FilterThumbnailImage(const Image *image,const size_t columns,
+  const size_t rows,ExceptionInfo *exception)
+{
+  CacheView
+    *image_view,
+    *thumbnail_view;
+
+  ContributionInfo
+    *magick_restrict x_contribution,
+    *magick_restrict y_contribution;
+
+  double
+    **magick_restrict rings,
+    x_factor,
+    x_scale,
+    x_support,
+    y_factor,
+    y_scale,
+    y_support;
+
+  FilterType
+    filter_type;
+
+  Image
+    *thumbnail_image;
+
+  MagickBooleanType
+    status;
+
+  MagickOffsetType
+    progress;
+
+  ResizeFilter
+    *resize_filter;
+
+  size_t
+    band_rows,
+    length,
+    number_bands,
+    number_channels,
+    window;
+
+  ssize_t
+    alpha_offset,
+    band,
+    offsets[MaxPixelChannels],
+    y;
+
+  /*
+    Resize, add an opaque alpha channel, and reduce to 8-bit samples in a
+    single sweep, with no intermediate image.  Each source row is read and
+    filtered horizontally once, into a ring that holds the rows the vertical
+    filter window spans.  Each thumbnail row is then filtered vertically from
+    the ring straight into 8-bit samples.  The thumbnail rows are split into
+    one contiguous band per thread, each with its own ring, so only the
+    source rows a window straddles at a band edge are filtered twice.  Only
+    images whose channels are plain weighted sums qualify (see
+    ThumbnailImage()).
+  */
+  x_factor=(double) columns/(double) image->columns;
+  y_factor=(double) rows/(double) image->rows;
+  filter_type=LanczosFilter;
+  if (image->filter != UndefinedFilter)
+    filter_type=image->filter;
+  else
+    if ((x_factor == 1.0) && (y_factor == 1.0))
+      filter_type=PointFilter;
+    else
+      if ((image->storage_class == PseudoClass) || ((x_factor*y_factor) > 1.0))
+        filter_type=MitchellFilter;
+  resize_filter=AcquireResizeFilter(image,filter_type,MagickFalse,exception);
+  x_scale=MagickMax(1.0/x_factor+MagickEpsilon,1.0);
+  x_support=x_scale*GetResizeFilterSupport(resize_filter);
+  if (x_support < 0.5)
+    {
+      x_support=(double) 0.5;
+      x_scale=1.0;
+    }
+  y_scale=MagickMax(1.0/y_factor+MagickEpsilon,1.0);
+  y_support=y_scale*GetResizeFilterSupport(resize_filter);
+  if (y_support < 0.5)
+    {
+      y_support=(double) 0.5;
+      y_scale=1.0;
+    }
+  x_contribution=AcquireContributionTable(resize_filter,x_factor,x_support,
+    PerceptibleReciprocal(x_scale),image->columns,columns);
+  y_contribution=AcquireContributionTable(resize_filter,y_factor,y_support,
+    PerceptibleReciprocal(y_scale),image->rows,rows);
+  resize_filter=DestroyResizeFilter(resize_filter);
+  number_channels=GetPixelChannels(image);
+  length=columns*number_channels;
+  window=1;
+  if (y_contribution != (ContributionInfo *) NULL)
+    for (y=0; y < (ssize_t) rows; y++)
+      window=MagickMax(window,(size_t) MagickMax(y_contribution[y].stop-
+        y_contribution[y].start,0));
+  rings=AcquireThumbnailThreadSet(window*length);
+  thumbnail_image=CloneImage(image,columns,rows,MagickTrue,exception);
+  if ((x_contribution == (ContributionInfo *) NULL) ||
+      (y_contribution == (ContributionInfo *) NULL) ||
+      (rings == (double **) NULL) || (thumbnail_image == (Image *) NULL))
+    {
+      if (thumbnail_image != (Image *) NULL)
+        thumbnail_image=DestroyImage(thumbnail_image);
+      if (rings != (double **) NULL)
+        rings=DestroyThumbnailThreadSet(rings);
+      if (y_contribution != (ContributionInfo *) NULL)
+        y_contribution=DestroyContributionTable(y_contribution);
+      if (x_contribution != (ContributionInfo *) NULL)
+        x_contribution=DestroyContributionTable(x_contribution);
+      (void) ThrowMagickException(exception,GetMagickModule(),
+        ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
+      return((Image *) NULL);
+    }
+  thumbnail_image->alpha_trait=BlendPixelTrait;
+  status=SetImageStorageClass(thumbnail_image,DirectClass,exception);
+  progress=0;
+  image_view=AcquireVirtualCacheView(image,exception);
+  thumbnail_view=AcquireAuthenticCacheView(thumbnail_image,exception);
+  for (y=0; y < (ssize_t) number_channels; y++)
+    offsets[y]=GetPixelChannelOffset(thumbnail_image,
+      GetPixelChannelChannel(image,y));
+  alpha_offset=GetPixelChannelOffset(thumbnail_image,AlphaPixelChannel);
+  number_bands=(size_t) GetMagickResourceLimit(ThreadResource);
+  band_rows=(rows+number_bands-1)/number_bands;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static,1) shared(progress,status) \
+    magick_threads(image,thumbnail_image,thumbnail_image->rows,1)
+#endif
+  for (band=0; band < (ssize_t) number_bands; band++)
+  {
+    const int
+      id = GetOpenMPThreadId();
+
+    register double
+      *magick_restrict ring;
+
+    ssize_t
+      next,
+      row;
+
+    ring=rings[id];
+    next=0;
+    for (row=band*(ssize_t) band_rows; row < (ssize_t) MagickMin((band+1)*
+         band_rows,rows); row++)
+    {
+      register Quantum
+        *magick_restrict q;
+
+      register ssize_t
+        i,
+        j,
+        x;
+
+      ssize_t
+        n,
+        start;
+
+      if (status == MagickFalse)
+        break;
+      start=y_contribution[row].start;
+      n=y_contribution[row].stop-start;
+      if (n <= 0)
+        continue;
+      if ((row == (band*(ssize_t) band_rows)) || (next < start))
+        next=start;
+      /*
+        Horizontal pass: filter each source row the window has not seen yet
+        into its slot of the ring.
+      */
+      for ( ; next < y_contribution[row].stop; next++)
+      {
+        register const Quantum
+          *magick_restrict p;
+
+        register double
+          *magick_restrict r;
+
+        p=GetCacheViewVirtualPixels(image_view,0,next,image->columns,1,
+          exception);
+        if (p == (const Quantum *) NULL)
+          {
+            status=MagickFalse;
+            break;
+          }
+        r=ring+(next % (ssize_t) window)*length;
+        for (x=0; x < (ssize_t) columns; x++)
+        {
+          register const Quantum
+            *magick_restrict k;
+
+          for (i=0; i < (ssize_t) number_channels; i++)
+            r[i]=0.0;
+          k=p+x_contribution[x].start*number_channels;
+          for (j=0; j < (x_contribution[x].stop-x_contribution[x].start); j++)
+          {
+            for (i=0; i < (ssize_t) number_channels; i++)
+              r[i]+=x_contribution[x].weight[j]*k[i];
+            k+=number_channels;
+          }
+          r+=number_channels;
+        }
+      }
+      if (status == MagickFalse)
+        break;
+      q=QueueCacheViewAuthenticPixels(thumbnail_view,0,row,columns,1,
+        exception);
+      if (q == (Quantum *) NULL)
+        {
+          status=MagickFalse;
+          break;
+        }
+      /*
+        Vertical pass from the ring into 8-bit thumbnail samples.
+      */
+      for (x=0; x < (ssize_t) columns; x++)
+      {
+        double
+          pixel[MaxPixelChannels];
+
+        for (i=0; i < (ssize_t) number_channels; i++)
+          pixel[i]=0.0;
+        for (j=0; j < n; j++)
+        {
+          register const double
+            *magick_restrict r;
+
+          r=ring+((start+j) % (ssize_t) window)*length+x*number_channels;
+          for (i=0; i < (ssize_t) number_channels; i++)
+            pixel[i]+=y_contribution[row].weight[j]*r[i];
+        }
+        for (i=0; i < (ssize_t) number_channels; i++)
+          q[offsets[i]]=ScaleCharToQuantum(ScaleQuantumToChar(ClampToQuantum(
+            pixel[i])));
+        q[alpha_offset]=OpaqueAlpha;
+        q+=GetPixelChannels(thumbnail_image);
+      }
+      if (SyncCacheViewAuthenticPixels(thumbnail_view,exception) == MagickFalse)
+        status=MagickFalse;
+      if (image->progress_monitor != (MagickProgressMonitor) NULL)
+        {
+          MagickBooleanType
+            proceed;
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+          #pragma omp critical (MagickCore_FilterThumbnailImage)
+#endif
+          proceed=SetImageProgress(image,ResizeImageTag,progress++,
+            thumbnail_image->rows);
+          if (proceed == MagickFalse)
+            status=MagickFalse;
+        }
+    }
+  }
+  thumbnail_view=DestroyCacheView(thumbnail_view);
+  image_view=DestroyCacheView(image_view);
+  rings=DestroyThumbnailThreadSet(rings);
+  y_contribution=DestroyContributionTable(y_contribution);
+  x_contribution=DestroyContributionTable(x_contribution);
+  thumbnail_image->type=image->type;
+  if (status == MagickFalse)
+    thumbnail_image=DestroyImage(thumbnail_image);
+  return(thumbnail_image);
+}
+
 MagickExport Image *ThumbnailImage(const Image *image,const size_t columns,
   const size_t rows,ExceptionInfo *exception)
 {
@@ -3643,6 +4013,9 @@ MagickExport Image *ThumbnailImage(const Image *image,const size_t columns,
     x_factor,
     y_factor;
 
+  MagickBooleanType
+    filter;
+
   struct stat
     attributes;
 
@@ -3654,11 +4027,19 @@ MagickExport Image *ThumbnailImage(const Image *image,const size_t columns,
   assert(exception->signature == MagickCoreSignature);
   x_factor=(double) columns/(double) image->columns;
   y_factor=(double) rows/(double) image->rows;
+  filter=MagickFalse;
+  if ((image->alpha_trait == UndefinedPixelTrait) &&
+      (image->read_mask == MagickFalse) &&
+      (IsUnblendedResize(image,image) != MagickFalse))
+    filter=MagickTrue;
   if ((x_factor*y_factor) > 0.1)
-    thumbnail_image=ResizeImage(image,columns,rows,image->filter,exception);
+    thumbnail_image=filter != MagickFalse ? FilterThumbnailImage(image,columns,
+      rows,exception) : ResizeImage(image,columns,rows,image->filter,exception);
   else
     if (((SampleFactor*columns) < 128) || ((SampleFactor*rows) < 128))
-      thumbnail_image=ResizeImage(image,columns,rows,image->filter,exception);
+      thumbnail_image=filter != MagickFalse ? FilterThumbnailImage(image,
+        columns,rows,exception) : ResizeImage(image,columns,rows,image->filter,
+        exception);
     else
       {
         Image
@@ -3668,8 +4049,9 @@ MagickExport Image *ThumbnailImage(const Image *image,const size_t columns,
           exception);
         if (sample_image == (Image *) NULL)
           return((Image *) NULL);
-        thumbnail_image=ResizeImage(sample_image,columns,rows,image->filter,
-          exception);
+        thumbnail_image=filter != MagickFalse ? FilterThumbnailImage(
+          sample_image,columns,rows,exception) : ResizeImage(sample_image,
+          columns,rows,image->filter,exception);
         sample_image=DestroyImage(sample_image);
       }
   if (thumbnail_image == (Image *) NULL)
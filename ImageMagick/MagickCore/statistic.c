@@ -2834,6 +2834,429 @@ static void ResetPixelList(PixelList *pixel_list)
   pixel_list->seed=pixel_list->signature++;
 }
 
+/*
+  Order statistics (gradient, maximum, median, minimum, mode, and nonpeak)
+  over larger neighborhoods use a histogram of the 16-bit pixel values
+  instead of a skip list.  Each thread takes a strip of rows and slides the
+  neighborhood through it in a snake order, right along one row and left
+  along the next, so each step only adds and removes a column (or a row) of
+  the neighborhood.  The histogram has 65536 fine bins and 256 coarse bins,
+  so any rank is found with at most 256 coarse and 256 fine steps whatever
+  the neighborhood size.
+*/
+#define StatisticHistogramBins  65536UL
+#define StatisticHistogramExtent  (StatisticHistogramBins+256UL)
+#define StatisticHistogramThreshold  49
+#define StatisticStripExtent  32
+
+static unsigned int **DestroyHistogramThreadSet(unsigned int **histograms)
+{
+  register ssize_t
+    i;
+
+  assert(histograms != (unsigned int **) NULL);
+  for (i=0; i < (ssize_t) GetMagickResourceLimit(ThreadResource); i++)
+    if (histograms[i] != (unsigned int *) NULL)
+      histograms[i]=(unsigned int *) RelinquishMagickMemory(histograms[i]);
+  histograms=(unsigned int **) RelinquishMagickMemory(histograms);
+  return(histograms);
+}
+
+static unsigned int **AcquireHistogramThreadSet(const size_t channels)
+{
+  register ssize_t
+    i;
+
+  size_t
+    number_threads;
+
+  unsigned int
+    **histograms;
+
+  number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
+  histograms=(unsigned int **) AcquireQuantumMemory(number_threads,
+    sizeof(*histograms));
+  if (histograms == (unsigned int **) NULL)
+    return((unsigned int **) NULL);
+  (void) ResetMagickMemory(histograms,0,number_threads*sizeof(*histograms));
+  for (i=0; i < (ssize_t) number_threads; i++)
+  {
+    histograms[i]=(unsigned int *) AcquireQuantumMemory(channels,
+      StatisticHistogramExtent*sizeof(**histograms));
+    if (histograms[i] == (unsigned int *) NULL)
+      return(DestroyHistogramThreadSet(histograms));
+    (void) ResetMagickMemory(histograms[i],0,channels*
+      StatisticHistogramExtent*sizeof(**histograms));
+  }
+  return(histograms);
+}
+
+static inline void UpdatePixelHistogram(unsigned int *magick_restrict histogram,
+  const Quantum *magick_restrict p,const size_t channels,const size_t stride,
+  const size_t columns,const size_t rows,const int delta)
+{
+  register ssize_t
+    i,
+    u;
+
+  ssize_t
+    v;
+
+  /*
+    Add (or remove) a rectangle of pixels, stride pixels per row.
+  */
+  for (v=0; v < (ssize_t) rows; v++)
+  {
+    for (u=0; u < (ssize_t) (columns*channels); u+=(ssize_t) channels)
+      for (i=0; i < (ssize_t) channels; i++)
+      {
+        register unsigned int
+          *magick_restrict bins;
+
+        unsigned short
+          index;
+
+        bins=histogram+i*StatisticHistogramExtent;
+        index=ScaleQuantumToShort(p[u+i]);
+        bins[index]+=delta;
+        bins[StatisticHistogramBins+(index >> 8)]+=delta;
+      }
+    p+=stride*channels;
+  }
+}
+
+static inline size_t GetModePixelHistogram(const unsigned int *histogram)
+{
+  register ssize_t
+    color,
+    i;
+
+  size_t
+    mode;
+
+  unsigned int
+    count;
+
+  /*
+    The lowest color of the highest count; a coarse bin can only hold a
+    higher count if its total is higher.
+  */
+  mode=StatisticHistogramBins;
+  count=0;
+  for (i=0; i < 256; i++)
+    if (histogram[StatisticHistogramBins+i] > count)
+      for (color=i << 8; color < ((i+1) << 8); color++)
+        if (histogram[color] > count)
+          {
+            mode=(size_t) color;
+            count=histogram[color];
+          }
+  return(mode);
+}
+
+static inline size_t GetNextPixelHistogram(const unsigned int *histogram,
+  size_t color)
+{
+  /*
+    The lowest color above this one, or StatisticHistogramBins if none.
+  */
+  for (color++; color < StatisticHistogramBins; color++)
+  {
+    if (((color & 0xff) == 0) &&
+        (histogram[StatisticHistogramBins+(color >> 8)] == 0))
+      {
+        color+=255;
+        continue;
+      }
+    if (histogram[color] != 0)
+      return(color);
+  }
+  return(StatisticHistogramBins);
+}
+
+static inline size_t GetPreviousPixelHistogram(const unsigned int *histogram,
+  size_t color)
+{
+  /*
+    The highest color below this one, or StatisticHistogramBins if none.
+  */
+  while (color > 0)
+  {
+    color--;
+    if (((color & 0xff) == 0xff) &&
+        (histogram[StatisticHistogramBins+(color >> 8)] == 0))
+      {
+        color-=255;
+        continue;
+      }
+    if (histogram[color] != 0)
+      return(color);
+  }
+  return(StatisticHistogramBins);
+}
+
+static inline size_t GetRankPixelHistogram(const unsigned int *histogram,
+  const size_t rank)
+{
+  register size_t
+    color,
+    count;
+
+  /*
+    The lowest color with more than rank samples at or below it.
+  */
+  count=0;
+  for (color=0; color < 255; color++)
+  {
+    if ((count+histogram[StatisticHistogramBins+color]) > rank)
+      break;
+    count+=histogram[StatisticHistogramBins+color];
+  }
+  for (color<<=8; color < (StatisticHistogramBins-1); color++)
+  {
+    count+=histogram[color];
+    if (count > rank)
+      break;
+  }
+  return(color);
+}
+
+static MagickBooleanType HistogramStatisticImage(const Image *image,
+  Image *statistic_image,const StatisticType type,const size_t width,
+  const size_t height,ExceptionInfo *exception)
+{
+#define StatisticImageTag  "Statistic/Image"
+
+  CacheView
+    *image_view,
+    *statistic_view;
+
+  MagickBooleanType
+    status;
+
+  MagickOffsetType
+    progress;
+
+  size_t
+    channels,
+    length,
+    stride;
+
+  ssize_t
+    center,
+    strip;
+
+  unsigned int
+    **magick_restrict histograms;
+
+  channels=GetPixelChannels(image);
+  histograms=AcquireHistogramThreadSet(channels);
+  if (histograms == (unsigned int **) NULL)
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),
+        ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
+      return(MagickFalse);
+    }
+  length=width*height;
+  stride=image->columns+width;
+  center=(ssize_t) (channels*(stride*(height/2L)+width/2L));
+  status=MagickTrue;
+  progress=0;
+  image_view=AcquireVirtualCacheView(image,exception);
+  statistic_view=AcquireAuthenticCacheView(statistic_image,exception);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static,1) shared(progress,status) \
+    magick_threads(image,statistic_image,statistic_image->rows,1)
+#endif
+  for (strip=0; strip < (ssize_t) statistic_image->rows; strip+=
+       StatisticStripExtent)
+  {
+    const int
+      id = GetOpenMPThreadId();
+
+    register const Quantum
+      *magick_restrict p;
+
+    register ssize_t
+      x;
+
+    ssize_t
+      direction,
+      y;
+
+    if (status == MagickFalse)
+      continue;
+    p=(const Quantum *) NULL;
+    x=0;
+    direction=1;
+    for (y=strip; y < MagickMin(strip+StatisticStripExtent,
+         (ssize_t) statistic_image->rows); y++)
+    {
+      register Quantum
+        *magick_restrict q;
+
+      register ssize_t
+        n;
+
+      /*
+        Move the neighborhood down a row, then along it.
+      */
+      if (p != (const Quantum *) NULL)
+        UpdatePixelHistogram(histograms[id],p+x*channels,channels,stride,
+          width,1,-1);
+      p=GetCacheViewVirtualPixels(image_view,-((ssize_t) width/2L),y-
+        (ssize_t) (height/2L),stride,height,exception);
+      q=QueueCacheViewAuthenticPixels(statistic_view,0,y,
+        statistic_image->columns,1,exception);
+      if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL))
+        {
+          status=MagickFalse;
+          break;
+        }
+      if (y == strip)
+        UpdatePixelHistogram(histograms[id],p,channels,stride,width,height,1);
+      else
+        UpdatePixelHistogram(histograms[id],p+((height-1)*stride+x)*channels,
+          channels,stride,width,1,1);
+      for (n=0; n < (ssize_t) statistic_image->columns; n++)
+      {
+        register ssize_t
+          i;
+
+        for (i=0; i < (ssize_t) channels; i++)
+        {
+          register const unsigned int
+            *magick_restrict histogram;
+
+          size_t
+            color;
+
+          PixelChannel channel=GetPixelChannelChannel(image,i);
+          PixelTrait traits=GetPixelChannelTraits(image,channel);
+          PixelTrait statistic_traits=GetPixelChannelTraits(statistic_image,
+            channel);
+          if ((traits == UndefinedPixelTrait) ||
+              (statistic_traits == UndefinedPixelTrait))
+            continue;
+          if ((statistic_traits & CopyPixelTrait) != 0)
+            {
+              SetPixelChannel(statistic_image,channel,p[center+x*channels+i],
+                q+x*GetPixelChannels(statistic_image));
+              continue;
+            }
+          if ((statistic_traits & UpdatePixelTrait) == 0)
+            continue;
+          histogram=histograms[id]+i*StatisticHistogramExtent;
+          switch (type)
+          {
+            case GradientStatistic:
+            {
+              double
+                maximum,
+                minimum;
+
+              minimum=(double) ScaleShortToQuantum((unsigned short)
+                GetRankPixelHistogram(histogram,0));
+              maximum=(double) ScaleShortToQuantum((unsigned short)
+                GetRankPixelHistogram(histogram,length-1));
+              SetPixelChannel(statistic_image,channel,ClampToQuantum(
+                MagickAbsoluteValue(maximum-minimum)),q+x*
+                GetPixelChannels(statistic_image));
+              continue;
+            }
+            case MaximumStatistic:
+            {
+              color=GetRankPixelHistogram(histogram,length-1);
+              break;
+            }
+            case MedianStatistic:
+            default:
+            {
+              color=GetRankPixelHistogram(histogram,length >> 1);
+              break;
+            }
+            case MinimumStatistic:
+            {
+              color=GetRankPixelHistogram(histogram,0);
+              break;
+            }
+            case ModeStatistic:
+            {
+              color=GetModePixelHistogram(histogram);
+              break;
+            }
+            case NonpeakStatistic:
+            {
+              size_t
+                next,
+                previous;
+
+              color=GetRankPixelHistogram(histogram,length >> 1);
+              previous=GetPreviousPixelHistogram(histogram,color);
+              next=GetNextPixelHistogram(histogram,color);
+              if ((previous == StatisticHistogramBins) &&
+                  (next != StatisticHistogramBins))
+                color=next;
+              else
+                if ((previous != StatisticHistogramBins) &&
+                    (next == StatisticHistogramBins))
+                  color=previous;
+              break;
+            }
+          }
+          SetPixelChannel(statistic_image,channel,ScaleShortToQuantum(
+            (unsigned short) color),q+x*GetPixelChannels(statistic_image));
+        }
+        if (n == (ssize_t) (statistic_image->columns-1))
+          break;
+        if (direction > 0)
+          {
+            UpdatePixelHistogram(histograms[id],p+x*channels,channels,stride,
+              1,height,-1);
+            UpdatePixelHistogram(histograms[id],p+(x+width)*channels,channels,
+              stride,1,height,1);
+          }
+        else
+          {
+            UpdatePixelHistogram(histograms[id],p+(x+width-1)*channels,
+              channels,stride,1,height,-1);
+            UpdatePixelHistogram(histograms[id],p+(x-1)*channels,channels,
+              stride,1,height,1);
+          }
+        x+=direction;
+      }
+      direction=(-direction);
+      if (SyncCacheViewAuthenticPixels(statistic_view,exception) == MagickFalse)
+        status=MagickFalse;
+      if (image->progress_monitor != (MagickProgressMonitor) NULL)
+        {
+          MagickBooleanType
+            proceed;
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+          #pragma omp critical (MagickCore_StatisticImage)
+#endif
+          proceed=SetImageProgress(image,StatisticImageTag,progress++,
+            image->rows);
+          if (proceed == MagickFalse)
+            status=MagickFalse;
+        }
+      if (status == MagickFalse)
+        break;
+    }
+    /*
+      Empty the histogram for the next strip.
+    */
+    if ((status != MagickFalse) && (p != (const Quantum *) NULL))
+      UpdatePixelHistogram(histograms[id],p+x*channels,channels,stride,width,
+        height,-1);
+  }
+  statistic_view=DestroyCacheView(statistic_view);
+  image_view=DestroyCacheView(image_view);
+  histograms=DestroyHistogramThreadSet(histograms);
+  return(status);
+}
+
 MagickExport Image *StatisticImage(const Image *image,const StatisticType type,
   const size_t width,const size_t height,ExceptionInfo *exception)
 {
@@ -2878,6 +3301,27 @@ MagickExport Image *StatisticImage(const Image *image,const StatisticType type,
       statistic_image=DestroyImage(statistic_image);
       return((Image *) NULL);
     }
+  if ((image->write_mask == MagickFalse) &&
+      ((MagickMax(width,1)*MagickMax(height,1)) >=
+        StatisticHistogramThreshold))
+    switch (type)
+    {
+      case GradientStatistic:
+      case MaximumStatistic:
+      case MedianStatistic:
+      case MinimumStatistic:
+      case ModeStatistic:
+      case NonpeakStatistic:
+      {
+        status=HistogramStatisticImage(image,statistic_image,type,
+          MagickMax(width,1),MagickMax(height,1),exception);
+        if (status == MagickFalse)
+          statistic_image=DestroyImage(statistic_image);
+        return(statistic_image);
+      }
+      default:
+        break;
+    }
   pixel_list=AcquirePixelListThreadSet(MagickMax(width,1),MagickMax(height,1));
   if (pixel_list == (PixelList **) NULL)
     {
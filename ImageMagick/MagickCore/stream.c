@@ -51,6 +51,7 @@
 #include "exception.h"
 #include "exception-private.h"
 #include "geometry.h"
+#include "list.h"
 #include "memory_.h"
 #include "memory-private.h"
 #include "pixel.h"
@@ -89,6 +90,9 @@ struct _StreamInfo
   unsigned char
     *pixels;
 
+  size_t
+    extent;
+
   RectangleInfo
     extract_info;
 
@@ -1149,6 +1153,261 @@ MagickExport void SetStreamInfoStorageType(StreamInfo *stream_info,
   stream_info->storage_type=storage_type;
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   S t r e a m B M P I m a g e                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  StreamBMPImage() streams pixels from an image straight into an
+%  uncompressed BMP file.  Rows are written to their place in the bottom-up
+%  BMP raster as soon as the decoder delivers them, so the writer holds no
+%  more than the rows of one delivery.  Whether the whole image is held
+%  elsewhere depends on the decoder: the PDF coder renders streamed pages
+%  in bands with the Ghostscript display device, or without it from a PNM
+%  file on disk that is read a row at a time.  The stream must be opened
+%  with OpenStream() on a seekable file.  Only the first frame is written
+%  and the decoder must deliver rows top to bottom.
+%
+%  The format of the StreamBMPImage() method is:
+%
+%      Image *StreamBMPImage(const ImageInfo *image_info,
+%        StreamInfo *stream_info,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o image_info: the image info.
+%
+%    o stream_info: the stream info.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+static size_t WriteStreamBMPImage(const Image *image,const void *pixels,
+  const size_t columns)
+{
+  static const unsigned char
+    padding[4] = { 0, 0, 0, 0 };
+
+  CacheInfo
+    *cache_info;
+
+  MagickOffsetType
+    offset;
+
+  MagickSizeType
+    image_size;
+
+  size_t
+    bits_per_pixel,
+    length,
+    offset_bits,
+    stride;
+
+  ssize_t
+    count,
+    y;
+
+  StreamInfo
+    *stream_info;
+
+  stream_info=(StreamInfo *) image->client_data;
+  if ((stream_info->image != (const Image *) NULL) &&
+      (image != stream_info->image))
+    return(columns);
+  bits_per_pixel=image->alpha_trait != UndefinedPixelTrait ? 32 : 24;
+  if (stream_info->image == (const Image *) NULL)
+    {
+      double
+        x_pixels,
+        y_pixels;
+
+      size_t
+        size;
+
+      /*
+        Write the BMP header; a V4 header describes the alpha mask.
+      */
+      stream_info->image=image;
+      stream_info->y=0;
+      (void) CloneString(&stream_info->map,bits_per_pixel == 32 ? "BGRA" :
+        "BGR");
+      stride=4*((image->columns*bits_per_pixel+31)/32);
+      image_size=(MagickSizeType) stride*image->rows;
+      size=bits_per_pixel == 32 ? 108 : 40;
+      offset_bits=14+size;
+      if ((image->columns == 0) || (image->rows == 0) ||
+          (image->columns > 0x7fffffffUL) || (image->rows > 0x7fffffffUL) ||
+          ((image_size+offset_bits) > 0xffffffffUL))
+        {
+          (void) ThrowMagickException(stream_info->exception,
+            GetMagickModule(),StreamError,"WidthOrHeightExceedsLimit","`%s'",
+            image->filename);
+          return(0);
+        }
+      x_pixels=image->resolution.x;
+      y_pixels=image->resolution.y;
+      if (image->units == PixelsPerInchResolution)
+        {
+          x_pixels*=100.0/2.54;
+          y_pixels*=100.0/2.54;
+        }
+      else
+        if (image->units == PixelsPerCentimeterResolution)
+          {
+            x_pixels*=100.0;
+            y_pixels*=100.0;
+          }
+        else
+          {
+            x_pixels=0.0;
+            y_pixels=0.0;
+          }
+      (void) SeekBlob(stream_info->stream,0,SEEK_SET);
+      (void) WriteBlob(stream_info->stream,2,(const unsigned char *) "BM");
+      (void) WriteBlobLSBLong(stream_info->stream,(unsigned int)
+        (image_size+offset_bits));
+      (void) WriteBlobLSBLong(stream_info->stream,0);
+      (void) WriteBlobLSBLong(stream_info->stream,(unsigned int) offset_bits);
+      (void) WriteBlobLSBLong(stream_info->stream,(unsigned int) size);
+      (void) WriteBlobLSBSignedLong(stream_info->stream,(signed int)
+        image->columns);
+      (void) WriteBlobLSBSignedLong(stream_info->stream,(signed int)
+        image->rows);
+      (void) WriteBlobLSBShort(stream_info->stream,1);
+      (void) WriteBlobLSBShort(stream_info->stream,(unsigned short)
+        bits_per_pixel);
+      (void) WriteBlobLSBLong(stream_info->stream,bits_per_pixel == 32 ? 3U :
+        0U);
+      (void) WriteBlobLSBLong(stream_info->stream,(unsigned int) image_size);
+      (void) WriteBlobLSBLong(stream_info->stream,(unsigned int)
+        (x_pixels+0.5));
+      (void) WriteBlobLSBLong(stream_info->stream,(unsigned int)
+        (y_pixels+0.5));
+      (void) WriteBlobLSBLong(stream_info->stream,0);
+      (void) WriteBlobLSBLong(stream_info->stream,0);
+      if (bits_per_pixel == 32)
+        {
+          register ssize_t
+            i;
+
+          (void) WriteBlobLSBLong(stream_info->stream,0x00ff0000U);
+          (void) WriteBlobLSBLong(stream_info->stream,0x0000ff00U);
+          (void) WriteBlobLSBLong(stream_info->stream,0x000000ffU);
+          (void) WriteBlobLSBLong(stream_info->stream,0xff000000U);
+          (void) WriteBlobLSBLong(stream_info->stream,0x73524742U);  /* sRGB */
+          for (i=0; i < 12; i++)
+            (void) WriteBlobLSBLong(stream_info->stream,0);  /* endpoints */
+        }
+    }
+  if (pixels == (const void *) NULL)
+    return(columns);
+  cache_info=(CacheInfo *) image->cache;
+  assert(cache_info->signature == MagickCoreSignature);
+  if (cache_info->columns != image->columns)
+    {
+      (void) ThrowMagickException(stream_info->exception,GetMagickModule(),
+        StreamError,"ImageDoesNotContainTheStreamGeometry","`%s'",
+        image->filename);
+      return(0);
+    }
+  length=strlen(stream_info->map)*cache_info->columns;
+  if (stream_info->extent < (length*cache_info->rows))
+    {
+      stream_info->pixels=(unsigned char *) RelinquishAlignedMemory(
+        stream_info->pixels);
+      stream_info->extent=length*cache_info->rows;
+      stream_info->pixels=(unsigned char *) AcquireAlignedMemory(1,
+        stream_info->extent);
+      if (stream_info->pixels == (unsigned char *) NULL)
+        {
+          stream_info->extent=0;
+          return(0);
+        }
+    }
+  if (StreamImagePixels(stream_info,image,stream_info->exception) ==
+      MagickFalse)
+    return(0);
+  /*
+    Seek to each row's place in the bottom-up raster.
+  */
+  stride=4*((image->columns*bits_per_pixel+31)/32);
+  offset_bits=14+(bits_per_pixel == 32 ? 108 : 40);
+  for (y=0; y < (ssize_t) cache_info->rows; y++)
+  {
+    if (stream_info->y >= (ssize_t) image->rows)
+      break;
+    offset=(MagickOffsetType) (offset_bits+(image->rows-stream_info->y-1)*
+      stride);
+    if (SeekBlob(stream_info->stream,offset,SEEK_SET) != offset)
+      return(0);
+    count=WriteBlob(stream_info->stream,length,stream_info->pixels+y*length);
+    if (count != (ssize_t) length)
+      return(0);
+    if ((stride > length) && (WriteBlob(stream_info->stream,stride-length,
+         padding) != (ssize_t) (stride-length)))
+      return(0);
+    stream_info->y++;
+  }
+  return(columns);
+}
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+MagickExport Image *StreamBMPImage(const ImageInfo *image_info,
+  StreamInfo *stream_info,ExceptionInfo *exception)
+{
+  Image
+    *image;
+
+  ImageInfo
+    *read_info;
+
+  assert(image_info != (const ImageInfo *) NULL);
+  assert(image_info->signature == MagickCoreSignature);
+  if (image_info->debug != MagickFalse)
+    (void) LogMagickEvent(TraceEvent,GetMagickModule(),"%s",
+      image_info->filename);
+  assert(stream_info != (StreamInfo *) NULL);
+  assert(stream_info->signature == MagickCoreSignature);
+  assert(exception != (ExceptionInfo *) NULL);
+  if (IsBlobSeekable(stream_info->stream) == MagickFalse)
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),StreamError,
+        "UnableToSeekStream","`%s'",stream_info->stream->filename);
+      return((Image *) NULL);
+    }
+  read_info=CloneImageInfo(image_info);
+  stream_info->image_info=image_info;
+  stream_info->image=(const Image *) NULL;
+  stream_info->storage_type=CharPixel;
+  stream_info->quantum_info=AcquireQuantumInfo(image_info,(Image *) NULL);
+  stream_info->exception=exception;
+  read_info->client_data=(void *) stream_info;
+  image=ReadStream(read_info,&WriteStreamBMPImage,exception);
+  read_info=DestroyImageInfo(read_info);
+  stream_info->quantum_info=DestroyQuantumInfo(stream_info->quantum_info);
+  if ((image != (Image *) NULL) && (stream_info->y < (ssize_t) image->rows))
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),CorruptImageError,
+        "InsufficientImageDataInFile","`%s'",image->filename);
+      image=DestroyImageList(image);
+    }
+  return(image);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
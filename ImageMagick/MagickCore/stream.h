@@ -32,6 +32,7 @@ typedef size_t
 
 extern MagickExport Image
   *ReadStream(const ImageInfo *,StreamHandler,ExceptionInfo *),
+  *StreamBMPImage(const ImageInfo *,StreamInfo *,ExceptionInfo *),
   *StreamImage(const ImageInfo *,StreamInfo *,ExceptionInfo *);
 
 extern MagickExport MagickBooleanType
@@ -27,15 +27,33 @@
 extern "C" {
 #endif
 
+/*
+  Disk caches use positional I/O and may be shared by threads when the
+  platform supports it; transfers then hold the cache file lock shared and
+  opening or closing the file holds it exclusively.
+*/
+#if defined(MAGICKCORE_HAVE_PREAD) && defined(MAGICKCORE_HAVE_PWRITE) && \
+    defined(MAGICKCORE_THREAD_SUPPORT)
+#define MagickConcurrentDiskCache  1
+#endif
+
+#if defined(MagickConcurrentDiskCache)
+#define IsConcurrentPixelCache(image) \
+  ((GetImagePixelCacheType(image) == MemoryCache) || \
+   (GetImagePixelCacheType(image) == MapCache) || \
+   (GetImagePixelCacheType(image) == DiskCache))
+#else
+#define IsConcurrentPixelCache(image) \
+  ((GetImagePixelCacheType(image) == MemoryCache) || \
+   (GetImagePixelCacheType(image) == MapCache))
+#endif
+
 /*
   Single threaded unless workload justifies the threading overhead.
 */
 #define magick_threads(source,destination,chunk,expression) \
-  num_threads((((expression) != 0) && \
-    ((GetImagePixelCacheType(source) == MemoryCache) || \
-     (GetImagePixelCacheType(source) == MapCache)) && \
-    ((GetImagePixelCacheType(destination) == MemoryCache) || \
-     (GetImagePixelCacheType(destination) == MapCache))) ? \
+  num_threads((((expression) != 0) && IsConcurrentPixelCache(source) && \
+    IsConcurrentPixelCache(destination)) ? \
     MagickMax(1,MagickMin(GetMagickResourceLimit(ThreadResource),(chunk)/16)) : 1)
 
 #if defined(__clang__) || (__GNUC__ > 3) || ((__GNUC__ == 3) && (__GNUC_MINOR__ > 10))
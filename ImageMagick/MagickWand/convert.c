@@ -508,6 +508,106 @@ static MagickBooleanType ConvertUsage(void)
   return(MagickFalse);
 }
 
+static MagickBooleanType StreamImages(const ImageInfo *image_info,
+  const int argc,char **argv,MagickStatusType *status,
+  ExceptionInfo *exception)
+{
+  const char
+    *input,
+    *output;
+
+  const OptionInfo
+    *option_info;
+
+  Image
+    *image;
+
+  ImageInfo
+    *read_info,
+    *write_info;
+
+  MagickBooleanType
+    streamable;
+
+  register ssize_t
+    i;
+
+  StreamInfo
+    *stream_info;
+
+  /*
+    One page of a PDF to a BMP file: stream the rows, never hold the page.
+    Only settings stored in the image info, such as -density or -define,
+    may precede the input filename.  Any image operator needs the whole
+    image, so such a command line takes the usual read/write path.
+  */
+  if (argc < 3)
+    return(MagickFalse);
+  input=argv[argc-2];
+  output=argv[argc-1];
+  if ((IsCommandOption(input) != MagickFalse) ||
+      (IsCommandOption(output) != MagickFalse))
+    return(MagickFalse);
+  for (i=1; i < (ssize_t) (argc-2); i+=option_info->type+1)
+  {
+    if (IsCommandOption(argv[i]) == MagickFalse)
+      return(MagickFalse);
+    option_info=GetCommandOptionInfo(argv[i]);
+    if ((option_info->mnemonic == (const char *) NULL) ||
+        ((option_info->flags & ImageInfoOptionFlag) == 0) ||
+        ((option_info->flags & (SimpleOperatorFlag | ListOperatorFlag |
+          GenesisOptionFlag | SpecialOptionFlag | NonMagickOptionFlag |
+          DeprecateOptionFlag)) != 0) ||
+        ((i+option_info->type) >= (ssize_t) (argc-2)))
+      return(MagickFalse);
+  }
+  read_info=CloneImageInfo(image_info);
+  if ((argc > 3) && (MogrifyImageInfo(read_info,argc-3,(const char **)
+       argv+1,exception) == MagickFalse))
+    {
+      read_info=DestroyImageInfo(read_info);
+      return(MagickFalse);
+    }
+  write_info=CloneImageInfo(read_info);
+  (void) CopyMagickString(read_info->filename,input,MagickPathExtent);
+  (void) SetImageInfo(read_info,0,exception);
+  (void) CopyMagickString(write_info->filename,output,MagickPathExtent);
+  (void) SetImageInfo(write_info,1,exception);
+  streamable=MagickFalse;
+  if ((read_info->number_scenes == 1) &&
+      ((LocaleCompare(read_info->magick,"AI") == 0) ||
+       (LocaleCompare(read_info->magick,"EPDF") == 0) ||
+       (LocaleCompare(read_info->magick,"PDF") == 0) ||
+       (LocaleCompare(read_info->magick,"PDFA") == 0)) &&
+      (LocaleCompare(write_info->magick,"BMP") == 0) &&
+      (LocaleCompare(write_info->filename,"-") != 0) &&
+      (strchr(write_info->filename,'%') == (char *) NULL))
+    streamable=MagickTrue;
+  if (streamable == MagickFalse)
+    {
+      write_info=DestroyImageInfo(write_info);
+      read_info=DestroyImageInfo(read_info);
+      return(MagickFalse);
+    }
+  (void) CopyMagickString(read_info->filename,input,MagickPathExtent);
+  stream_info=AcquireStreamInfo(write_info,exception);
+  *status=OpenStream(write_info,stream_info,write_info->filename,exception);
+  if (*status != MagickFalse)
+    {
+      image=StreamBMPImage(read_info,stream_info,exception);
+      *status=(image != (Image *) NULL) &&
+        (exception->severity < ErrorException);
+      if (image != (Image *) NULL)
+        image=DestroyImageList(image);
+    }
+  stream_info=DestroyStreamInfo(stream_info);
+  if (*status == 0)
+    (void) remove_utf8(write_info->filename);
+  write_info=DestroyImageInfo(write_info);
+  read_info=DestroyImageInfo(read_info);
+  return(MagickTrue);
+}
+
 WandExport MagickBooleanType ConvertImageCommand(ImageInfo *image_info,
   int argc,char **argv,char **metadata,ExceptionInfo *exception)
 {
@@ -539,7 +639,8 @@ WandExport MagickBooleanType ConvertImageCommand(ImageInfo *image_info,
     *option;
 
   const char
-    *format;
+    *format,
+    *thumbnail;
 
   Image
     *image;
@@ -559,8 +660,10 @@ WandExport MagickBooleanType ConvertImageCommand(ImageInfo *image_info,
     i;
 
   ssize_t
+    count,
     j,
-    k;
+    k,
+    l;
 
   /*
     Set defaults.
@@ -601,6 +704,8 @@ WandExport MagickBooleanType ConvertImageCommand(ImageInfo *image_info,
       GetExceptionMessage(errno));
   if ((argc > 2) && (LocaleCompare("-concatenate",argv[1]) == 0))
     return(ConcatenateImages(argc,argv,exception));
+  if (StreamImages(image_info,argc,argv,&status,exception) != MagickFalse)
+    return(status != 0 ? MagickTrue : MagickFalse);
   for (i=1; i < (ssize_t) (argc-1); i++)
   {
     option=argv[i];
@@ -633,10 +738,48 @@ WandExport MagickBooleanType ConvertImageCommand(ImageInfo *image_info,
         filename=argv[i];
         if ((LocaleCompare(filename,"--") == 0) && (i < (ssize_t) (argc-1)))
           filename=argv[++i];
+        thumbnail=(const char *) NULL;
+        if ((image == (Image *) NULL) &&
+            (GetImageOption(image_info,"pdf:thumbnail") == (const char *) NULL))
+          {
+            /*
+              A pending -thumbnail lets the PDF coder render near that size.
+            */
+            for (l=j; l < (i-1); l++)
+              if (LocaleCompare("-thumbnail",argv[l]) == 0)
+                thumbnail=argv[l+1];
+            for (l=i+1; (thumbnail == (const char *) NULL) &&
+                 (l < (ssize_t) (argc-2)); l+=count+1)
+            {
+              /*
+                So does a -thumbnail that directly follows the filename,
+                with only settings in between.
+              */
+              if (IsCommandOption(argv[l]) == MagickFalse)
+                break;
+              if (LocaleCompare("-thumbnail",argv[l]) == 0)
+                {
+                  thumbnail=argv[l+1];
+                  break;
+                }
+              if ((GetCommandOptionFlags(MagickCommandOptions,MagickFalse,
+                   argv[l]) & (SimpleOperatorFlag | ListOperatorFlag |
+                   FireOptionFlag)) != 0)
+                break;
+              count=ParseCommandOption(MagickCommandOptions,MagickFalse,
+                argv[l]);
+              if (count < 0)
+                count=0;
+            }
+          }
+        if (thumbnail != (const char *) NULL)
+          (void) SetImageOption(image_info,"pdf:thumbnail",thumbnail);
         if (image_info->ping != MagickFalse)
           images=PingImages(image_info,filename,exception);
         else
           images=ReadImages(image_info,filename,exception);
+        if (thumbnail != (const char *) NULL)
+          (void) DeleteImageOption(image_info,"pdf:thumbnail");
         status&=(images != (Image *) NULL) &&
           (exception->severity < ErrorException);
         if (images == (Image *) NULL)
@@ -44,6 +44,7 @@
 #include "blob.h"
 #include "blob-private.h"
 #include "cache.h"
+#include "cache-private.h"
 #include "colormap-private.h"
 #include "color-private.h"
 #include "colormap.h"
@@ -1496,6 +1497,78 @@ ModuleExport void UnregisterBMPImage(void)
   (void) UnregisterMagickInfo("BMP3");
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   E x p o r t B G R C h a r P i x e l s                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExportBGRCharPixels() copies one row of a cache:depth=8 pixel cache into a
+%  BGR888 or BGRA8888 scanline.  It returns MagickFalse if the cache does not
+%  keep 8-bit samples, in which case the caller scales each Quantum instead.
+%
+%  The format of the ExportBGRCharPixels method is:
+%
+%      MagickBooleanType ExportBGRCharPixels(const Image *image,
+%        const ssize_t y,const MagickBooleanType alpha,unsigned char *q)
+%
+%  A description of each parameter follows.
+%
+%    o image: the image.
+%
+%    o y: the row.
+%
+%    o alpha: export an alpha sample after blue, green, and red.
+%
+%    o q: the scanline.
+%
+*/
+static MagickBooleanType ExportBGRCharPixels(const Image *image,
+  const ssize_t y,const MagickBooleanType alpha,unsigned char *q)
+{
+  register const unsigned char
+    *p;
+
+  register ssize_t
+    x;
+
+  size_t
+    number_channels;
+
+  ssize_t
+    alpha_offset,
+    blue_offset,
+    green_offset,
+    red_offset;
+
+  if ((alpha != MagickFalse) &&
+      (GetPixelAlphaTraits(image) == UndefinedPixelTrait))
+    return(MagickFalse);
+  p=GetVirtualCharPixels(image,0,y,image->columns);
+  if (p == (const unsigned char *) NULL)
+    return(MagickFalse);
+  number_channels=GetPixelChannels(image);
+  red_offset=GetPixelChannelOffset(image,RedPixelChannel);
+  green_offset=GetPixelChannelOffset(image,GreenPixelChannel);
+  blue_offset=GetPixelChannelOffset(image,BluePixelChannel);
+  alpha_offset=GetPixelChannelOffset(image,AlphaPixelChannel);
+  for (x=0; x < (ssize_t) image->columns; x++)
+  {
+    *q++=p[blue_offset];
+    *q++=p[green_offset];
+    *q++=p[red_offset];
+    if (alpha != MagickFalse)
+      *q++=p[alpha_offset];
+    p+=number_channels;
+  }
+  return(MagickTrue);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1997,17 +2070,22 @@ static MagickBooleanType WriteBMPImage(const ImageInfo *image_info,Image *image,
         */
         for (y=0; y < (ssize_t) image->rows; y++)
         {
-          p=GetVirtualPixels(image,0,y,image->columns,1,exception);
-          if (p == (const Quantum *) NULL)
-            break;
           q=pixels+(image->rows-y-1)*bytes_per_line;
-          for (x=0; x < (ssize_t) image->columns; x++)
-          {
-            *q++=ScaleQuantumToChar(GetPixelBlue(image,p));
-            *q++=ScaleQuantumToChar(GetPixelGreen(image,p));
-            *q++=ScaleQuantumToChar(GetPixelRed(image,p));
-            p+=GetPixelChannels(image);
-          }
+          if (ExportBGRCharPixels(image,y,MagickFalse,q) != MagickFalse)
+            q+=3*image->columns;
+          else
+            {
+              p=GetVirtualPixels(image,0,y,image->columns,1,exception);
+              if (p == (const Quantum *) NULL)
+                break;
+              for (x=0; x < (ssize_t) image->columns; x++)
+              {
+                *q++=ScaleQuantumToChar(GetPixelBlue(image,p));
+                *q++=ScaleQuantumToChar(GetPixelGreen(image,p));
+                *q++=ScaleQuantumToChar(GetPixelRed(image,p));
+                p+=GetPixelChannels(image);
+              }
+            }
           for (x=3L*(ssize_t) image->columns; x < (ssize_t) bytes_per_line; x++)
             *q++=0x00;
           if (image->previous == (Image *) NULL)
@@ -2027,18 +2105,21 @@ static MagickBooleanType WriteBMPImage(const ImageInfo *image_info,Image *image,
         */
         for (y=0; y < (ssize_t) image->rows; y++)
         {
-          p=GetVirtualPixels(image,0,y,image->columns,1,exception);
-          if (p == (const Quantum *) NULL)
-            break;
           q=pixels+(image->rows-y-1)*bytes_per_line;
-          for (x=0; x < (ssize_t) image->columns; x++)
-          {
-            *q++=ScaleQuantumToChar(GetPixelBlue(image,p));
-            *q++=ScaleQuantumToChar(GetPixelGreen(image,p));
-            *q++=ScaleQuantumToChar(GetPixelRed(image,p));
-            *q++=ScaleQuantumToChar(GetPixelAlpha(image,p));
-            p+=GetPixelChannels(image);
-          }
+          if (ExportBGRCharPixels(image,y,MagickTrue,q) == MagickFalse)
+            {
+              p=GetVirtualPixels(image,0,y,image->columns,1,exception);
+              if (p == (const Quantum *) NULL)
+                break;
+              for (x=0; x < (ssize_t) image->columns; x++)
+              {
+                *q++=ScaleQuantumToChar(GetPixelBlue(image,p));
+                *q++=ScaleQuantumToChar(GetPixelGreen(image,p));
+                *q++=ScaleQuantumToChar(GetPixelRed(image,p));
+                *q++=ScaleQuantumToChar(GetPixelAlpha(image,p));
+                p+=GetPixelChannels(image);
+              }
+            }
           if (image->previous == (Image *) NULL)
             {
               status=SetImageProgress(image,SaveImageTag,(MagickOffsetType) y,
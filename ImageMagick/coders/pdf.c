@@ -45,6 +45,7 @@
 #include "blob.h"
 #include "blob-private.h"
 #include "cache.h"
+#include "cache-private.h"
 #include "color.h"
 #include "color-private.h"
 #include "colorspace.h"
@@ -59,6 +60,7 @@
 #include "geometry.h"
 #include "image.h"
 #include "image-private.h"
+#include "linked-list.h"
 #include "list.h"
 #include "magick.h"
 #include "memory_.h"
@@ -67,19 +69,26 @@
 #include "nt-base-private.h"
 #include "option.h"
 #include "pixel-accessor.h"
+#include "policy.h"
 #include "profile.h"
 #include "property.h"
 #include "quantum-private.h"
 #include "resource_.h"
 #include "resize.h"
+#include "semaphore.h"
 #include "signature.h"
 #include "static.h"
 #include "string_.h"
+#include "string-private.h"
 #include "module.h"
 #include "token.h"
 #include "transform.h"
 #include "utility.h"
+#include "utility-private.h"
 #include "module.h"
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+#include "zlib.h"
+#endif
 
 /*
   Define declarations.
@@ -89,6 +98,206 @@
 #else
 #define CCITTParam  "0"
 #endif
+#define PDFMaxObjects  8388607
+#define PDFMetadataEntries  64
+#define PDFMaxStreamExtent  268435456
+#define PDFStreamBandHeight  256
+#define PDFDisplayArguments  "gs -q -dQUIET -dSAFER -dNOPAUSE -dNOPROMPT " \
+  "-dMaxBitmap=500000000 -dAlignToPixels=0 -dGridFitTT=2 " \
+  "-dTextAlphaBits=%u -dGraphicsAlphaBits=%u \"-r%s\" %s"
+
+/*
+  Typedef declarations.
+*/
+typedef struct _PDFDisplayInfo
+{
+  const ImageInfo
+    *image_info;
+
+  PointInfo
+    resolution;
+
+  unsigned char
+    *pixels;
+
+  size_t
+    columns,
+    rows,
+    stride;
+
+  unsigned int
+    format;
+
+  Image
+    *images,
+    *canvas;
+
+  ssize_t
+    band_offset;
+
+  ExceptionInfo
+    *exception;
+} PDFDisplayInfo;
+
+typedef struct _PDFDocumentInfo
+{
+  ImageInfo
+    *image_info;
+
+  const DelegateInfo
+    *delegate_info;
+
+  char
+    *density,
+    *options,
+    postscript_filename[MagickPathExtent],
+    input_filename[MagickPathExtent];
+
+  size_t
+    resident_pages;
+
+  LinkedListInfo
+    *pages;
+
+  SemaphoreInfo
+    *semaphore;
+
+  ssize_t
+    reference_count;
+} PDFDocumentInfo;
+
+typedef struct _PDFInfo
+{
+  double
+    angle;
+
+  SegmentInfo
+    bounds;
+
+  MagickBooleanType
+    cmyk;
+
+  size_t
+    number_pages;
+} PDFInfo;
+
+typedef struct _PDFMetadataInfo
+{
+  char
+    *path,
+    *version,
+    **spot_colors;
+
+  size_t
+    number_spot_colors,
+    hits;
+
+  MagickSizeType
+    extent;
+
+  time_t
+    modify_time;
+
+  MagickBooleanType
+    cropbox,
+    trimbox;
+
+  PDFInfo
+    pdf_info;
+} PDFMetadataInfo;
+
+typedef struct _PDFPageInfo
+{
+  PDFDocumentInfo
+    *document;
+
+  size_t
+    page;
+
+  Cache
+    cache;
+} PDFPageInfo;
+
+typedef struct _PDFStreamInfo
+{
+  size_t
+    number;
+
+  unsigned char
+    *data;
+
+  size_t
+    length,
+    first;
+} PDFStreamInfo;
+
+typedef struct _PDFTimingInfo
+{
+  double
+    scan,
+    startup,
+    render,
+    read,
+    consolidate;
+} PDFTimingInfo;
+
+typedef struct _PDFXrefInfo
+{
+  int
+    type;
+
+  MagickOffsetType
+    offset;
+
+  size_t
+    index;
+} PDFXrefInfo;
+
+typedef struct _PDFScanInfo
+{
+  const unsigned char
+    *data;
+
+  size_t
+    length;
+
+  PDFXrefInfo
+    *xref;
+
+  size_t
+    number_objects;
+
+  PDFStreamInfo
+    *streams;
+
+  size_t
+    number_streams,
+    root,
+    pages,
+    visits;
+
+  PointInfo
+    *extents;
+
+  size_t
+    number_extents;
+
+  MagickBooleanType
+    cropbox,
+    trimbox;
+} PDFScanInfo;
+
+/*
+  Global declarations.
+*/
+static LinkedListInfo
+  *pdf_metadata = (LinkedListInfo *) NULL;
+
+static SemaphoreInfo
+  *pdf_semaphore = (SemaphoreInfo *) NULL;
+
+static size_t
+  pdf_metadata_entries = PDFMetadataEntries;
 
 /*
   Forward declarations.
@@ -96,6 +305,33 @@
 static MagickBooleanType
   WritePDFImage(const ImageInfo *,Image *,ExceptionInfo *);
 
+static MagickBooleanType IsPDFDocument(const char *path)
+{
+  FILE
+    *file;
+
+  size_t
+    count;
+
+  unsigned char
+    magick[5];
+
+  /*
+    Only documents run by the PDF interpreter go to a pooled interpreter.  A
+    PostScript job can change state that save and restore do not undo, and
+    the next document leased the same interpreter would see it.
+  */
+  file=fopen_utf8(path,"rb");
+  if (file == (FILE *) NULL)
+    return(MagickFalse);
+  count=fread(magick,1,sizeof(magick),file);
+  (void) fclose(file);
+  if (count != sizeof(magick))
+    return(MagickFalse);
+  return(LocaleNCompare((const char *) magick,"%PDF-",5) == 0 ? MagickTrue :
+    MagickFalse);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -112,7 +348,9 @@ static MagickBooleanType
 %  The format of the InvokePDFDelegate method is:
 %
 %      MagickBooleanType InvokePDFDelegate(const MagickBooleanType verbose,
-%        const char *command,ExceptionInfo *exception)
+%        const char *command,PDFDisplayInfo *display_info,
+%        const MagickBooleanType pool,PDFTimingInfo *timing,char *message,
+%        ExceptionInfo *exception)
 %
 %  A description of each parameter follows:
 %
@@ -122,6 +360,20 @@ static MagickBooleanType
 %    o command: the address of a character string containing the command to
 %      execute.
 %
+%    o display_info: if not NULL, the interpreter renders through the
+%      Ghostscript display device and each page is imported directly into
+%      the display_info->images list rather than written to a file.  The
+%      command -sDisplayHandle must then be the address of a pointer to
+%      display_info.
+%
+%    o pool: run the command on a pooled interpreter if the pool is enabled;
+%      only pass MagickTrue for a PDF document.
+%
+%    o timing: if not NULL, the time spent starting the interpreter and
+%      running the command is added to timing->startup and timing->render.
+%
+%    o message: return the interpreter message if it quits prematurely.
+%
 %    o exception: return any errors or warnings in this structure.
 %
 */
@@ -151,12 +403,238 @@ static int MagickDLLCall PDFDelegateMessage(void *handle,const char *message,
 }
 #endif
 
+#if defined(MAGICKCORE_GS_DISPLAY_DELEGATE)
+static int MagickDLLCall PDFDisplayNoop(void *handle,void *device)
+{
+  magick_unreferenced(handle);
+  magick_unreferenced(device);
+  return(0);
+}
+
+static int MagickDLLCall PDFDisplayPresize(void *handle,void *device,
+  int width,int height,int raster,unsigned int format)
+{
+  magick_unreferenced(handle);
+  magick_unreferenced(device);
+  magick_unreferenced(width);
+  magick_unreferenced(height);
+  magick_unreferenced(raster);
+  switch (format & DISPLAY_COLORS_MASK)
+  {
+    case DISPLAY_COLORS_NATIVE:
+    {
+      if ((format & DISPLAY_DEPTH_MASK) != DISPLAY_DEPTH_1)
+        return(-1);
+      return(0);
+    }
+    case DISPLAY_COLORS_GRAY:
+    case DISPLAY_COLORS_RGB:
+    case DISPLAY_COLORS_CMYK:
+      break;
+    default:
+      return(-1);
+  }
+  if ((format & DISPLAY_DEPTH_MASK) != DISPLAY_DEPTH_8)
+    return(-1);
+  return(0);
+}
+
+static int MagickDLLCall PDFDisplaySize(void *handle,void *device,int width,
+  int height,int raster,unsigned int format,unsigned char *pimage)
+{
+  PDFDisplayInfo
+    *display_info;
+
+  magick_unreferenced(device);
+  display_info=(PDFDisplayInfo *) (*(void **) handle);
+  display_info->pixels=pimage;
+  display_info->columns=(size_t) MagickMax(width,0);
+  display_info->rows=(size_t) MagickMax(height,0);
+  display_info->stride=(size_t) MagickMax(raster,0);
+  display_info->format=format;
+  return(0);
+}
+
+static MagickBooleanType ImportPDFDisplayPixels(
+  const PDFDisplayInfo *display_info,Image *image,const ssize_t offset,
+  ExceptionInfo *exception)
+{
+  register const unsigned char
+    *p;
+
+  register Quantum
+    *q;
+
+  register ssize_t
+    x;
+
+  size_t
+    columns;
+
+  ssize_t
+    y;
+
+  switch (display_info->format & DISPLAY_COLORS_MASK)
+  {
+    case DISPLAY_COLORS_CMYK:
+    {
+      (void) SetImageColorspace(image,CMYKColorspace,exception);
+      break;
+    }
+    case DISPLAY_COLORS_GRAY:
+    case DISPLAY_COLORS_NATIVE:
+    {
+      (void) SetImageColorspace(image,GRAYColorspace,exception);
+      break;
+    }
+    default:
+      break;
+  }
+  columns=MagickMin(image->columns,display_info->columns);
+  for (y=0; y < (ssize_t) display_info->rows; y++)
+  {
+    if ((offset+y) >= (ssize_t) image->rows)
+      break;
+    p=display_info->pixels+y*display_info->stride;
+    q=QueueAuthenticPixels(image,0,offset+y,columns,1,exception);
+    if (q == (Quantum *) NULL)
+      return(MagickFalse);
+    for (x=0; x < (ssize_t) columns; x++)
+    {
+      switch (display_info->format & DISPLAY_COLORS_MASK)
+      {
+        case DISPLAY_COLORS_CMYK:
+        {
+          SetPixelCyan(image,ScaleCharToQuantum(*p++),q);
+          SetPixelMagenta(image,ScaleCharToQuantum(*p++),q);
+          SetPixelYellow(image,ScaleCharToQuantum(*p++),q);
+          SetPixelBlack(image,ScaleCharToQuantum(*p++),q);
+          break;
+        }
+        case DISPLAY_COLORS_GRAY:
+        {
+          SetPixelGray(image,ScaleCharToQuantum(*p++),q);
+          break;
+        }
+        case DISPLAY_COLORS_NATIVE:
+        {
+          /*
+            One bit per pixel, most significant bit first, black is 1.
+          */
+          SetPixelGray(image,((p[x >> 3] >> (7-(x & 0x07))) & 0x01) != 0 ?
+            0 : QuantumRange,q);
+          break;
+        }
+        default:
+        {
+          SetPixelRed(image,ScaleCharToQuantum(*p++),q);
+          SetPixelGreen(image,ScaleCharToQuantum(*p++),q);
+          SetPixelBlue(image,ScaleCharToQuantum(*p++),q);
+          break;
+        }
+      }
+      q+=GetPixelChannels(image);
+    }
+    if (SyncAuthenticPixels(image,exception) == MagickFalse)
+      return(MagickFalse);
+  }
+  return(MagickTrue);
+}
+
+static int MagickDLLCall PDFDisplayPage(void *handle,void *device,int copies,
+  int flush)
+{
+  ExceptionInfo
+    *exception;
+
+  Image
+    *image;
+
+  PDFDisplayInfo
+    *display_info;
+
+  magick_unreferenced(device);
+  magick_unreferenced(copies);
+  magick_unreferenced(flush);
+  display_info=(PDFDisplayInfo *) (*(void **) handle);
+  if ((display_info->pixels == (unsigned char *) NULL) ||
+      (display_info->columns == 0) || (display_info->rows == 0))
+    return(-1);
+  exception=display_info->exception;
+  if (display_info->canvas != (Image *) NULL)
+    {
+      /*
+        A band of a larger page, stream it into the page canvas.
+      */
+      if (ImportPDFDisplayPixels(display_info,display_info->canvas,
+            display_info->band_offset,exception) == MagickFalse)
+        return(-1);
+      return(0);
+    }
+  /*
+    Import the rendered page straight into the pixel cache.
+  */
+  image=AcquireImage(display_info->image_info,exception);
+  image->resolution=display_info->resolution;
+  if (SetImageExtent(image,display_info->columns,display_info->rows,
+      exception) == MagickFalse)
+    {
+      image=DestroyImage(image);
+      return(-1);
+    }
+  if (ImportPDFDisplayPixels(display_info,image,0,exception) == MagickFalse)
+    {
+      image=DestroyImage(image);
+      return(-1);
+    }
+  AppendImageToList(&display_info->images,image);
+  return(0);
+}
+
+static int MagickDLLCall PDFDisplayUpdate(void *handle,void *device,int x,
+  int y,int width,int height)
+{
+  magick_unreferenced(handle);
+  magick_unreferenced(device);
+  magick_unreferenced(x);
+  magick_unreferenced(y);
+  magick_unreferenced(width);
+  magick_unreferenced(height);
+  return(0);
+}
+
+static display_callback
+  PDFDisplayCallback =
+  {
+    sizeof(display_callback),
+    DISPLAY_VERSION_MAJOR,
+    DISPLAY_VERSION_MINOR,
+    PDFDisplayNoop,     /* open */
+    PDFDisplayNoop,     /* preclose */
+    PDFDisplayNoop,     /* close */
+    PDFDisplayPresize,
+    PDFDisplaySize,
+    PDFDisplayNoop,     /* sync */
+    PDFDisplayPage,
+    PDFDisplayUpdate,
+    NULL,               /* memalloc: Ghostscript owns the page bitmap */
+    NULL,               /* memfree */
+    NULL                /* separation */
+  };
+#endif
+
 static MagickBooleanType InvokePDFDelegate(const MagickBooleanType verbose,
-  const char *command,char *message,ExceptionInfo *exception)
+  const char *command,PDFDisplayInfo *display_info,const MagickBooleanType pool,
+  PDFTimingInfo *timing,char *message,ExceptionInfo *exception)
 {
   int
     status;
 
+  TimerInfo
+    timer;
+
+  GetTimerInfo(&timer);
+
 #if defined(MAGICKCORE_GS_DELEGATE) || defined(MAGICKCORE_WINDOWS_SUPPORT)
 #define SetArgsStart(command,args_start) \
   if (args_start == (const char *) NULL) \
@@ -175,6 +653,8 @@ static MagickBooleanType InvokePDFDelegate(const MagickBooleanType verbose,
 { \
   status=ExternalDelegateCommand(MagickFalse,verbose,command,message, \
     exception); \
+  if (timing != (PDFTimingInfo *) NULL) \
+    timing->render+=GetElapsedTime(&timer); \
   if (status == 0) \
     return(MagickTrue); \
   if (status < 0) \
@@ -207,30 +687,13 @@ static MagickBooleanType InvokePDFDelegate(const MagickBooleanType verbose,
   register ssize_t
     i;
 
-#if defined(MAGICKCORE_WINDOWS_SUPPORT)
-  ghost_info=NTGhostscriptDLLVectors();
-#else
-  GhostInfo
-    ghost_info_struct;
-
-  ghost_info=(&ghost_info_struct);
-  (void) ResetMagickMemory(&ghost_info_struct,0,sizeof(ghost_info_struct));
-  ghost_info_struct.delete_instance=(void (*)(gs_main_instance *))
-    gsapi_delete_instance;
-  ghost_info_struct.exit=(int (*)(gs_main_instance *)) gsapi_exit;
-  ghost_info_struct.new_instance=(int (*)(gs_main_instance **,void *))
-    gsapi_new_instance;
-  ghost_info_struct.init_with_args=(int (*)(gs_main_instance *,int,char **))
-    gsapi_init_with_args;
-  ghost_info_struct.run_string=(int (*)(gs_main_instance *,const char *,int,
-    int *)) gsapi_run_string;
-  ghost_info_struct.set_stdio=(int (*)(gs_main_instance *,int(*)(void *,char *,
-    int),int(*)(void *,const char *,int),int(*)(void *, const char *, int)))
-    gsapi_set_stdio;
-  ghost_info_struct.revision=(int (*)(gsapi_revision_t *,int)) gsapi_revision;
-#endif
+  ghost_info=GetGhostscriptInfo();
   if (ghost_info == (GhostInfo *) NULL)
-    ExecuteGhostscriptCommand(command,status);
+    {
+      if (display_info != (PDFDisplayInfo *) NULL)
+        return(MagickFalse);
+      ExecuteGhostscriptCommand(command,status);
+    }
   if ((ghost_info->revision)(&revision,sizeof(revision)) != 0)
     revision.revision=0;
   if (verbose != MagickFalse)
@@ -241,27 +704,71 @@ static MagickBooleanType InvokePDFDelegate(const MagickBooleanType verbose,
       (void) fputs(args_start,stdout);
     }
   errors=(char *) NULL;
-  status=(ghost_info->new_instance)(&interpreter,(void *) &errors);
-  if (status < 0)
-    ExecuteGhostscriptCommand(command,status);
-  code=0;
-  argv=StringToArgv(command,&argc);
-  if (argv == (char **) NULL)
-    {
-      (ghost_info->delete_instance)(interpreter);
-      return(MagickFalse);
+  if ((display_info == (PDFDisplayInfo *) NULL) && (pool != MagickFalse) &&
+      (RunGhostscriptCommand(ghost_info,command,&status,&errors) !=
+       MagickFalse))
+    {
+      /*
+        Rendered on a pooled interpreter.
+      */
+      code=0;
+      if (timing != (PDFTimingInfo *) NULL)
+        timing->render+=GetElapsedTime(&timer);
+    }
+  else
+    {
+      status=AcquireGhostscriptInterpreter(ghost_info,&interpreter,
+        (void *) &errors);
+      if (status < 0)
+        {
+          if (display_info != (PDFDisplayInfo *) NULL)
+            return(MagickFalse);
+          ExecuteGhostscriptCommand(command,status);
+        }
+      code=0;
+      argv=StringToArgv(command,&argc);
+      if (argv == (char **) NULL)
+        {
+          RelinquishGhostscriptInterpreter(ghost_info,interpreter);
+          return(MagickFalse);
+        }
+      (void) (ghost_info->set_stdio)(interpreter,(int(MagickDLLCall *)(
+        void *,char *,int)) NULL,PDFDelegateMessage,PDFDelegateMessage);
+      if (timing != (PDFTimingInfo *) NULL)
+        {
+          timing->startup+=GetElapsedTime(&timer);
+          GetTimerInfo(&timer);
+        }
+      if (display_info != (PDFDisplayInfo *) NULL)
+        {
+#if defined(MAGICKCORE_GS_DISPLAY_DELEGATE)
+          if (ghost_info->set_display_callback != NULL)
+            status=(ghost_info->set_display_callback)(interpreter,
+              &PDFDisplayCallback);
+          else
+#endif
+            status=(-1);
+          if (status < 0)
+            {
+              RelinquishGhostscriptInterpreter(ghost_info,interpreter);
+              for (i=0; i < (ssize_t) argc; i++)
+                argv[i]=DestroyString(argv[i]);
+              argv=(char **) RelinquishMagickMemory(argv);
+              return(MagickFalse);
+            }
+        }
+      status=(ghost_info->init_with_args)(interpreter,argc-1,argv+1);
+      if (status == 0)
+        status=(ghost_info->run_string)(interpreter,
+          "systemdict /start get exec\n",0,&code);
+      (ghost_info->exit)(interpreter);
+      RelinquishGhostscriptInterpreter(ghost_info,interpreter);
+      if (timing != (PDFTimingInfo *) NULL)
+        timing->render+=GetElapsedTime(&timer);
+      for (i=0; i < (ssize_t) argc; i++)
+        argv[i]=DestroyString(argv[i]);
+      argv=(char **) RelinquishMagickMemory(argv);
     }
-  (void) (ghost_info->set_stdio)(interpreter,(int(MagickDLLCall *)(void *,
-    char *,int)) NULL,PDFDelegateMessage,PDFDelegateMessage);
-  status=(ghost_info->init_with_args)(interpreter,argc-1,argv+1);
-  if (status == 0)
-    status=(ghost_info->run_string)(interpreter,"systemdict /start get exec\n",
-      0,&code);
-  (ghost_info->exit)(interpreter);
-  (ghost_info->delete_instance)(interpreter);
-  for (i=0; i < (ssize_t) argc; i++)
-    argv[i]=DestroyString(argv[i]);
-  argv=(char **) RelinquishMagickMemory(argv);
   if (status != 0)
     {
       SetArgsStart(command,args_start);
@@ -286,23 +793,139 @@ static MagickBooleanType InvokePDFDelegate(const MagickBooleanType verbose,
     errors=DestroyString(errors);
   return(MagickTrue);
 #else
+  magick_unreferenced(pool);
+  if (display_info != (PDFDisplayInfo *) NULL)
+    return(MagickFalse);
   status=ExternalDelegateCommand(MagickFalse,verbose,command,message,exception);
+  if (timing != (PDFTimingInfo *) NULL)
+    timing->render+=GetElapsedTime(&timer);
   return(status == 0 ? MagickTrue : MagickFalse);
 #endif
 }
-
-/*
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%                                                                             %
-%                                                                             %
-%                                                                             %
-%   I s P D F                                                                 %
-%                                                                             %
-%                                                                             %
-%                                                                             %
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%
-%  IsPDF() returns MagickTrue if the image format type, identified by the
+
+#if defined(MAGICKCORE_GS_DISPLAY_DELEGATE)
+static MagickBooleanType InvokePDFDisplay(const MagickBooleanType verbose,
+  const char *arguments,const char *prologue,const size_t first_page,
+  const size_t last_page,const char *input_filename,
+  PDFDisplayInfo *display_info,char *message,ExceptionInfo *exception)
+{
+  char
+    command[MagickPathExtent],
+    *errors,
+    job[MagickPathExtent],
+    path[MagickPathExtent];
+
+  const char
+    *paths[2];
+
+  GhostscriptInstance
+    *instance;
+
+  int
+    status;
+
+  register const char
+    *p;
+
+  register ssize_t
+    i;
+
+  void
+    *handle;
+
+  instance=(GhostscriptInstance *) NULL;
+  if (IsPDFDocument(input_filename) != MagickFalse)
+    instance=AcquireGhostscriptInstance(GetGhostscriptInfo(),arguments,
+      &PDFDisplayCallback,MagickFalse);
+  if (instance == (GhostscriptInstance *) NULL)
+    {
+      /*
+        No warm interpreter available or the document is not a PDF, run a
+        one-shot instance.
+      */
+      handle=(void *) display_info;
+      (void) FormatLocaleString(command,MagickPathExtent,
+        "%s -dBATCH -sDisplayHandle=16#%llx",arguments,(unsigned long long)
+        (size_t) &handle);
+      if (first_page != 0)
+        {
+          char
+            pages[MagickPathExtent];
+
+          (void) FormatLocaleString(pages,MagickPathExtent,
+            " -dFirstPage=%.20g -dLastPage=%.20g",(double) first_page,
+            (double) last_page);
+          (void) ConcatenateMagickString(command,pages,MagickPathExtent);
+        }
+      if (prologue != (const char *) NULL)
+        {
+          (void) ConcatenateMagickString(command," -c \"",MagickPathExtent);
+          (void) ConcatenateMagickString(command,prologue,MagickPathExtent);
+          (void) ConcatenateMagickString(command,"\"",MagickPathExtent);
+        }
+      (void) ConcatenateMagickString(command," \"-f",MagickPathExtent);
+      (void) ConcatenateMagickString(command,input_filename,MagickPathExtent);
+      (void) ConcatenateMagickString(command,"\"",MagickPathExtent);
+      return(InvokePDFDelegate(verbose,command,display_info,MagickFalse,
+        (PDFTimingInfo *) NULL,message,exception));
+    }
+  /*
+    Run the document on a pooled interpreter, escaping the PostScript string.
+  */
+  i=0;
+  for (p=input_filename; (*p != '\0') && (i < (MagickPathExtent-2)); p++)
+  {
+    if ((*p == '(') || (*p == ')') || (*p == '\\'))
+      path[i++]='\\';
+    path[i++]=(*p);
+  }
+  path[i]='\0';
+  *job='\0';
+  if (first_page != 0)
+    (void) FormatLocaleString(job,MagickPathExtent,"/FirstPage %.20g def "
+      "/LastPage %.20g def ",(double) first_page,(double) last_page);
+  if (prologue != (const char *) NULL)
+    {
+      (void) ConcatenateMagickString(job,prologue,MagickPathExtent);
+      (void) ConcatenateMagickString(job," ",MagickPathExtent);
+    }
+  (void) ConcatenateMagickString(job,"(",MagickPathExtent);
+  (void) ConcatenateMagickString(job,path,MagickPathExtent);
+  (void) ConcatenateMagickString(job,") run\n",MagickPathExtent);
+  if (verbose != MagickFalse)
+    (void) fprintf(stdout,"[ghostscript instance] %s",job);
+  errors=(char *) NULL;
+  paths[0]=input_filename;
+  paths[1]=(const char *) NULL;
+  status=RunGhostscriptInstance(instance,(void *) display_info,job,paths,
+    &errors);
+  RelinquishGhostscriptInstance(instance);
+  if (status == -101) /* quit */
+    (void) FormatLocaleString(message,MagickPathExtent,
+      "[ghostscript instance] %s",errors != (char *) NULL ? errors : "");
+  else
+    if (status != 0)
+      (void) ThrowMagickException(exception,GetMagickModule(),DelegateError,
+        "PDFDelegateFailed","`[ghostscript instance] %s': %s",path,
+        errors != (char *) NULL ? errors : "");
+  if (errors != (char *) NULL)
+    errors=DestroyString(errors);
+  return(status == 0 ? MagickTrue : MagickFalse);
+}
+#endif
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   I s P D F                                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  IsPDF() returns MagickTrue if the image format type, identified by the
 %  magick string, is PDF.
 %
 %  The format of the IsPDF method is:
@@ -324,49 +947,2021 @@ static MagickBooleanType IsPDF(const unsigned char *magick,const size_t offset)
     return(MagickTrue);
   return(MagickFalse);
 }
-
-/*
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%                                                                             %
-%                                                                             %
-%                                                                             %
-%   R e a d P D F I m a g e                                                   %
-%                                                                             %
-%                                                                             %
-%                                                                             %
-%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
-%
-%  ReadPDFImage() reads a Portable Document Format image file and
-%  returns it.  It allocates the memory necessary for the new Image structure
-%  and returns a pointer to the new image.
-%
-%  The format of the ReadPDFImage method is:
-%
-%      Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
-%
-%  A description of each parameter follows:
-%
-%    o image_info: the image info.
-%
-%    o exception: return any errors or warnings in this structure.
-%
-*/
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%   R e a d P D F I m a g e                                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReadPDFImage() reads a Portable Document Format image file and
+%  returns it.  It allocates the memory necessary for the new Image structure
+%  and returns a pointer to the new image.
+%
+%  The format of the ReadPDFImage method is:
+%
+%      Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o image_info: the image info.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType IsPDFRendered(const char *path)
+{
+  MagickBooleanType
+    status;
+
+  struct stat
+    attributes;
+
+  if ((path == (const char *) NULL) || (*path == '\0'))
+    return(MagickFalse);
+  status=GetPathAttributes(path,&attributes);
+  if ((status != MagickFalse) && S_ISREG(attributes.st_mode) &&
+      (attributes.st_size > 0))
+    return(MagickTrue);
+  return(MagickFalse);
+}
+
+/*
+  The PDF structure scanner locates page objects through the cross-reference
+  table or stream and reads their dictionaries directly from a memory map of
+  the document; content streams are never decoded.
+*/
+static inline MagickBooleanType IsPDFWhitespace(const int c)
+{
+  if ((c == 0) || (c == 9) || (c == 10) || (c == 12) || (c == 13) ||
+      (c == 32))
+    return(MagickTrue);
+  return(MagickFalse);
+}
+
+static inline MagickBooleanType IsPDFDelimiter(const int c)
+{
+  if ((c == '(') || (c == ')') || (c == '<') || (c == '>') || (c == '[') ||
+      (c == ']') || (c == '{') || (c == '}') || (c == '/') || (c == '%'))
+    return(MagickTrue);
+  return(MagickFalse);
+}
+
+static inline MagickBooleanType IsPDFRegular(const int c)
+{
+  if ((IsPDFWhitespace(c) == MagickFalse) && (IsPDFDelimiter(c) == MagickFalse))
+    return(MagickTrue);
+  return(MagickFalse);
+}
+
+static const unsigned char *SkipPDFWhitespace(const unsigned char *p,
+  const unsigned char *q)
+{
+  while (p < q)
+  {
+    if (*p == '%')
+      {
+        while ((p < q) && (*p != '\n') && (*p != '\r'))
+          p++;
+        continue;
+      }
+    if (IsPDFWhitespace((int) *p) == MagickFalse)
+      break;
+    p++;
+  }
+  return(p);
+}
+
+static inline MagickBooleanType IsPDFKeyword(const unsigned char *p,
+  const unsigned char *q,const char *keyword)
+{
+  size_t
+    length;
+
+  length=strlen(keyword);
+  if (((size_t) (q-p) < length) || (memcmp(p,keyword,length) != 0))
+    return(MagickFalse);
+  if (((p+length) < q) && (IsPDFRegular((int) p[length]) != MagickFalse))
+    return(MagickFalse);
+  return(MagickTrue);
+}
+
+static const unsigned char *SkipPDFValue(const unsigned char *p,
+  const unsigned char *q,const size_t depth)
+{
+  ssize_t
+    level;
+
+  /*
+    Skip one PDF object: a string, dictionary, array, name, or number.
+  */
+  p=SkipPDFWhitespace(p,q);
+  if ((p >= q) || (depth > 64))
+    return(q);
+  switch (*p)
+  {
+    case '(':
+    {
+      level=0;
+      for ( ; p < q; p++)
+      {
+        if (*p == '\\')
+          {
+            p++;
+            continue;
+          }
+        if (*p == '(')
+          level++;
+        if ((*p == ')') && (--level == 0))
+          return(p+1);
+      }
+      return(q);
+    }
+    case '<':
+    {
+      if (((p+1) < q) && (p[1] == '<'))
+        {
+          for (p+=2; ; )
+          {
+            p=SkipPDFWhitespace(p,q);
+            if (p >= q)
+              return(q);
+            if ((*p == '>') && ((p+1) < q) && (p[1] == '>'))
+              return(p+2);
+            p=SkipPDFValue(p,q,depth+1);
+          }
+        }
+      while ((p < q) && (*p != '>'))
+        p++;
+      return(p < q ? p+1 : q);
+    }
+    case '[':
+    {
+      for (p++; ; )
+      {
+        p=SkipPDFWhitespace(p,q);
+        if (p >= q)
+          return(q);
+        if (*p == ']')
+          return(p+1);
+        p=SkipPDFValue(p,q,depth+1);
+      }
+    }
+    case '/':
+    {
+      for (p++; (p < q) && (IsPDFRegular((int) *p) != MagickFalse); p++) ;
+      return(p);
+    }
+    case ')':
+    case '>':
+    case ']':
+    case '{':
+    case '}':
+      return(p+1);
+    default:
+      break;
+  }
+  while ((p < q) && (IsPDFRegular((int) *p) != MagickFalse))
+    p++;
+  return(p);
+}
+
+static const unsigned char *ReadPDFInteger(const unsigned char *p,
+  const unsigned char *q,MagickOffsetType *value)
+{
+  const unsigned char
+    *r;
+
+  *value=0;
+  p=SkipPDFWhitespace(p,q);
+  for (r=p; (r < q) && (isdigit((int) *r) != 0); r++)
+  {
+    if (*value > ((MagickOffsetType) 1 << 58))
+      return((const unsigned char *) NULL);
+    *value=10*(*value)+(*r-'0');
+  }
+  if ((r == p) || ((r < q) && (IsPDFRegular((int) *r) != MagickFalse)))
+    return((const unsigned char *) NULL);
+  return(r);
+}
+
+static const unsigned char *ReadPDFNumber(const unsigned char *p,
+  const unsigned char *q,double *value)
+{
+  char
+    token[MagickPathExtent];
+
+  register size_t
+    i;
+
+  *value=0.0;
+  p=SkipPDFWhitespace(p,q);
+  for (i=0; (p < q) && (i < 64); i++, p++)
+  {
+    if ((isdigit((int) *p) == 0) && (*p != '-') && (*p != '+') &&
+        (*p != '.'))
+      break;
+    token[i]=(char) *p;
+  }
+  if (i == 0)
+    return((const unsigned char *) NULL);
+  token[i]='\0';
+  *value=StringToDouble(token,(char **) NULL);
+  return(p);
+}
+
+static const unsigned char *ReadPDFReference(const unsigned char *p,
+  const unsigned char *q,size_t *number)
+{
+  MagickOffsetType
+    generation,
+    value;
+
+  /*
+    Parse an indirect reference: "number generation R".
+  */
+  p=ReadPDFInteger(p,q,&value);
+  if (p == (const unsigned char *) NULL)
+    return((const unsigned char *) NULL);
+  p=ReadPDFInteger(p,q,&generation);
+  if (p == (const unsigned char *) NULL)
+    return((const unsigned char *) NULL);
+  p=SkipPDFWhitespace(p,q);
+  if (IsPDFKeyword(p,q,"R") == MagickFalse)
+    return((const unsigned char *) NULL);
+  *number=(size_t) value;
+  return(p+1);
+}
+
+static const unsigned char *GetPDFValue(const unsigned char *p,
+  const unsigned char *q,const char *key)
+{
+  const unsigned char
+    *r;
+
+  size_t
+    length,
+    number;
+
+  /*
+    Return the value of a key in the dictionary at p.
+  */
+  length=strlen(key);
+  p=SkipPDFWhitespace(p,q);
+  if (((q-p) < 2) || (p[0] != '<') || (p[1] != '<'))
+    return((const unsigned char *) NULL);
+  for (p+=2; ; )
+  {
+    p=SkipPDFWhitespace(p,q);
+    if ((p >= q) || (*p == '>'))
+      return((const unsigned char *) NULL);
+    if (*p != '/')
+      {
+        p=SkipPDFValue(p,q,0);
+        continue;
+      }
+    r=SkipPDFValue(p,q,0);
+    if (((size_t) (r-p-1) == length) && (memcmp(p+1,key,length) == 0))
+      {
+        r=SkipPDFWhitespace(r,q);
+        return(r < q ? r : (const unsigned char *) NULL);
+      }
+    p=ReadPDFReference(r,q,&number);
+    if (p == (const unsigned char *) NULL)
+      p=SkipPDFValue(r,q,0);
+  }
+}
+
+static void SetPDFXrefEntry(PDFScanInfo *scan_info,const size_t number,
+  const int type,const MagickOffsetType offset,const size_t index)
+{
+  /*
+    Newer revisions are read first, so an entry is only set once.
+  */
+  if (number >= scan_info->number_objects)
+    {
+      size_t
+        extent;
+
+      if (number >= PDFMaxObjects)
+        return;
+      extent=MagickMax(2*scan_info->number_objects,number+1);
+      scan_info->xref=(PDFXrefInfo *) ResizeQuantumMemory(scan_info->xref,
+        extent,sizeof(*scan_info->xref));
+      if (scan_info->xref == (PDFXrefInfo *) NULL)
+        {
+          scan_info->number_objects=0;
+          return;
+        }
+      (void) ResetMagickMemory(scan_info->xref+scan_info->number_objects,0,
+        (extent-scan_info->number_objects)*sizeof(*scan_info->xref));
+      scan_info->number_objects=extent;
+    }
+  if (scan_info->xref[number].type != 0)
+    return;
+  scan_info->xref[number].type=type;
+  scan_info->xref[number].offset=offset;
+  scan_info->xref[number].index=index;
+}
+
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+static unsigned char *InflatePDFStream(const unsigned char *data,
+  const size_t length,size_t *extent)
+{
+  int
+    status;
+
+  size_t
+    size;
+
+  unsigned char
+    *buffer;
+
+  z_stream
+    stream;
+
+  *extent=0;
+  if (length > (size_t) UINT_MAX)
+    return((unsigned char *) NULL);
+  size=MagickMax(4*length,4096);
+  buffer=(unsigned char *) AcquireQuantumMemory(size,sizeof(*buffer));
+  if (buffer == (unsigned char *) NULL)
+    return((unsigned char *) NULL);
+  (void) ResetMagickMemory(&stream,0,sizeof(stream));
+  if (inflateInit(&stream) != Z_OK)
+    {
+      buffer=(unsigned char *) RelinquishMagickMemory(buffer);
+      return((unsigned char *) NULL);
+    }
+  stream.next_in=(Bytef *) data;
+  stream.avail_in=(uInt) length;
+  for ( ; ; )
+  {
+    stream.next_out=buffer+stream.total_out;
+    stream.avail_out=(uInt) (size-stream.total_out);
+    status=inflate(&stream,Z_NO_FLUSH);
+    if (status == Z_STREAM_END)
+      break;
+    if ((status != Z_OK) && (status != Z_BUF_ERROR))
+      break;
+    if (stream.avail_out != 0)
+      break;
+    if (size >= PDFMaxStreamExtent)
+      {
+        status=Z_MEM_ERROR;
+        break;
+      }
+    size<<=1;
+    buffer=(unsigned char *) ResizeQuantumMemory(buffer,size,sizeof(*buffer));
+    if (buffer == (unsigned char *) NULL)
+      {
+        status=Z_MEM_ERROR;
+        break;
+      }
+  }
+  (void) inflateEnd(&stream);
+  if ((buffer != (unsigned char *) NULL) && (status != Z_STREAM_END) &&
+      (status != Z_OK) && (status != Z_BUF_ERROR))
+    buffer=(unsigned char *) RelinquishMagickMemory(buffer);
+  if (buffer != (unsigned char *) NULL)
+    *extent=(size_t) stream.total_out;
+  return(buffer);
+}
+#endif
+
+static MagickBooleanType DecodePDFPredictor(unsigned char *data,
+  size_t *extent,const size_t columns)
+{
+  register size_t
+    x;
+
+  size_t
+    rows,
+    y;
+
+  unsigned char
+    *p,
+    *prior,
+    *r;
+
+  /*
+    Undo a PNG row predictor (one byte per pixel) in place.
+  */
+  if (columns == 0)
+    return(MagickFalse);
+  rows=(*extent)/(columns+1);
+  prior=(unsigned char *) NULL;
+  r=data;
+  for (y=0; y < rows; y++)
+  {
+    int
+      filter;
+
+    p=data+y*(columns+1);
+    filter=(int) *p++;
+    for (x=0; x < columns; x++)
+    {
+      int
+        a,
+        b,
+        c,
+        pa,
+        pb,
+        pc,
+        value;
+
+      a=x > 0 ? (int) r[x-1] : 0;
+      b=prior != (unsigned char *) NULL ? (int) prior[x] : 0;
+      c=(x > 0) && (prior != (unsigned char *) NULL) ? (int) prior[x-1] : 0;
+      value=(int) p[x];
+      switch (filter)
+      {
+        case 0: break;
+        case 1: value+=a; break;
+        case 2: value+=b; break;
+        case 3: value+=(a+b)/2; break;
+        case 4:
+        {
+          pa=abs(b-c);
+          pb=abs(a-c);
+          pc=abs(a+b-2*c);
+          value+=(pa <= pb) && (pa <= pc) ? a : pb <= pc ? b : c;
+          break;
+        }
+        default:
+          return(MagickFalse);
+      }
+      r[x]=(unsigned char) value;
+    }
+    prior=r;
+    r+=columns;
+  }
+  *extent=rows*columns;
+  return(MagickTrue);
+}
+
+static const unsigned char *GetPDFObject(PDFScanInfo *,const size_t,
+  const unsigned char **);
+
+static unsigned char *GetPDFStreamData(PDFScanInfo *scan_info,
+  const unsigned char *p,const unsigned char *q,size_t *extent)
+{
+  const unsigned char
+    *filter,
+    *r,
+    *s,
+    *value;
+
+  double
+    columns,
+    predictor;
+
+  MagickOffsetType
+    length;
+
+  size_t
+    number;
+
+  unsigned char
+    *data;
+
+  /*
+    Return the decoded data of the stream whose dictionary is at p.
+  */
+  *extent=0;
+  r=SkipPDFWhitespace(SkipPDFValue(p,q,0),q);
+  if (IsPDFKeyword(r,q,"stream") == MagickFalse)
+    return((unsigned char *) NULL);
+  r+=6;
+  if ((r < q) && (*r == '\r'))
+    r++;
+  if ((r < q) && (*r == '\n'))
+    r++;
+  value=GetPDFValue(p,q,"Length");
+  if (value == (const unsigned char *) NULL)
+    return((unsigned char *) NULL);
+  s=q;
+  if (ReadPDFReference(value,q,&number) != (const unsigned char *) NULL)
+    value=GetPDFObject(scan_info,number,&s);
+  if ((value == (const unsigned char *) NULL) ||
+      (ReadPDFInteger(value,s,&length) == (const unsigned char *) NULL) ||
+      (length < 0) || (length > (MagickOffsetType) (q-r)))
+    return((unsigned char *) NULL);
+  filter=GetPDFValue(p,q,"Filter");
+  if (filter != (const unsigned char *) NULL)
+    {
+      if (*filter == '[')
+        {
+          /*
+            Only a single filter is supported.
+          */
+          filter=SkipPDFWhitespace(filter+1,q);
+          if (*SkipPDFWhitespace(SkipPDFValue(filter,q,0),q) != ']')
+            return((unsigned char *) NULL);
+        }
+      if (IsPDFKeyword(filter,q,"/FlateDecode") == MagickFalse)
+        return((unsigned char *) NULL);
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+      data=InflatePDFStream(r,(size_t) length,extent);
+#else
+      data=(unsigned char *) NULL;
+#endif
+    }
+  else
+    {
+      data=(unsigned char *) AcquireQuantumMemory((size_t) length+1,
+        sizeof(*data));
+      if (data != (unsigned char *) NULL)
+        {
+          (void) memcpy(data,r,(size_t) length);
+          *extent=(size_t) length;
+        }
+    }
+  if (data == (unsigned char *) NULL)
+    return((unsigned char *) NULL);
+  value=GetPDFValue(p,q,"DecodeParms");
+  if ((value != (const unsigned char *) NULL) && (*value == '['))
+    value=SkipPDFWhitespace(value+1,q);
+  if ((value != (const unsigned char *) NULL) && (*value == '<'))
+    {
+      predictor=1.0;
+      columns=1.0;
+      s=GetPDFValue(value,q,"Predictor");
+      if (s != (const unsigned char *) NULL)
+        (void) ReadPDFNumber(s,q,&predictor);
+      s=GetPDFValue(value,q,"Columns");
+      if (s != (const unsigned char *) NULL)
+        (void) ReadPDFNumber(s,q,&columns);
+      if ((predictor >= 10.0) && ((columns < 1.0) ||
+          (DecodePDFPredictor(data,extent,(size_t) columns) == MagickFalse)))
+        data=(unsigned char *) RelinquishMagickMemory(data);
+      else
+        if ((predictor > 1.0) && (predictor < 10.0))
+          data=(unsigned char *) RelinquishMagickMemory(data);
+    }
+  return(data);
+}
+
+static PDFStreamInfo *GetPDFObjectStream(PDFScanInfo *scan_info,
+  const size_t number)
+{
+  const unsigned char
+    *p,
+    *q,
+    *value;
+
+  double
+    first;
+
+  PDFStreamInfo
+    *stream_info;
+
+  register ssize_t
+    i;
+
+  size_t
+    length,
+    n;
+
+  unsigned char
+    *data;
+
+  /*
+    Decode (once) the object stream that holds compressed objects.  Reading
+    the stream may decode other object streams and move the stream table, so
+    the entry is addressed by index across those calls.
+  */
+  for (i=0; i < (ssize_t) scan_info->number_streams; i++)
+    if (scan_info->streams[i].number == number)
+      return(scan_info->streams[i].data == (unsigned char *) NULL ?
+        (PDFStreamInfo *) NULL : scan_info->streams+i);
+  if ((number >= scan_info->number_objects) ||
+      (scan_info->xref[number].type != 1))
+    return((PDFStreamInfo *) NULL);
+  scan_info->streams=(PDFStreamInfo *) ResizeQuantumMemory(
+    scan_info->streams,scan_info->number_streams+1,
+    sizeof(*scan_info->streams));
+  if (scan_info->streams == (PDFStreamInfo *) NULL)
+    {
+      scan_info->number_streams=0;
+      return((PDFStreamInfo *) NULL);
+    }
+  n=scan_info->number_streams++;
+  stream_info=scan_info->streams+n;
+  (void) ResetMagickMemory(stream_info,0,sizeof(*stream_info));
+  stream_info->number=number;
+  p=GetPDFObject(scan_info,number,&q);
+  if (p == (const unsigned char *) NULL)
+    return((PDFStreamInfo *) NULL);
+  value=GetPDFValue(p,q,"First");
+  if ((value == (const unsigned char *) NULL) ||
+      (ReadPDFNumber(value,q,&first) == (const unsigned char *) NULL) ||
+      (first < 0.0))
+    return((PDFStreamInfo *) NULL);
+  data=GetPDFStreamData(scan_info,p,q,&length);
+  if ((data == (unsigned char *) NULL) || (n >= scan_info->number_streams))
+    {
+      if (data != (unsigned char *) NULL)
+        data=(unsigned char *) RelinquishMagickMemory(data);
+      return((PDFStreamInfo *) NULL);
+    }
+  stream_info=scan_info->streams+n;
+  stream_info->data=data;
+  stream_info->length=length;
+  stream_info->first=(size_t) first;
+  if (stream_info->first > stream_info->length)
+    {
+      stream_info->data=(unsigned char *) RelinquishMagickMemory(
+        stream_info->data);
+      return((PDFStreamInfo *) NULL);
+    }
+  return(stream_info);
+}
+
+static const unsigned char *GetPDFObject(PDFScanInfo *scan_info,
+  const size_t number,const unsigned char **q)
+{
+  const unsigned char
+    *p;
+
+  MagickOffsetType
+    generation,
+    offset,
+    value;
+
+  PDFStreamInfo
+    *stream_info;
+
+  register size_t
+    i;
+
+  /*
+    Return the body of an object and the end of the region that holds it.
+  */
+  if (number >= scan_info->number_objects)
+    return((const unsigned char *) NULL);
+  switch (scan_info->xref[number].type)
+  {
+    case 1:
+    {
+      if ((scan_info->xref[number].offset < 0) ||
+          (scan_info->xref[number].offset >= (MagickOffsetType)
+           scan_info->length))
+        return((const unsigned char *) NULL);
+      *q=scan_info->data+scan_info->length;
+      p=ReadPDFInteger(scan_info->data+scan_info->xref[number].offset,*q,
+        &value);
+      if ((p == (const unsigned char *) NULL) || (value != (MagickOffsetType)
+          number))
+        return((const unsigned char *) NULL);
+      p=ReadPDFInteger(p,*q,&generation);
+      if (p == (const unsigned char *) NULL)
+        return((const unsigned char *) NULL);
+      p=SkipPDFWhitespace(p,*q);
+      if (IsPDFKeyword(p,*q,"obj") == MagickFalse)
+        return((const unsigned char *) NULL);
+      return(SkipPDFWhitespace(p+3,*q));
+    }
+    case 2:
+    {
+      stream_info=GetPDFObjectStream(scan_info,(size_t)
+        scan_info->xref[number].offset);
+      if (stream_info == (PDFStreamInfo *) NULL)
+        return((const unsigned char *) NULL);
+      p=stream_info->data;
+      *q=stream_info->data+stream_info->first;
+      for (i=0; i <= scan_info->xref[number].index; i++)
+      {
+        p=ReadPDFInteger(p,*q,&value);
+        if (p == (const unsigned char *) NULL)
+          return((const unsigned char *) NULL);
+        p=ReadPDFInteger(p,*q,&offset);
+        if (p == (const unsigned char *) NULL)
+          return((const unsigned char *) NULL);
+      }
+      if ((value != (MagickOffsetType) number) || (offset < 0) ||
+          ((size_t) offset >= (stream_info->length-stream_info->first)))
+        return((const unsigned char *) NULL);
+      *q=stream_info->data+stream_info->length;
+      return(SkipPDFWhitespace(stream_info->data+stream_info->first+offset,
+        *q));
+    }
+    default:
+      break;
+  }
+  return((const unsigned char *) NULL);
+}
+
+static const unsigned char *ResolvePDFValue(PDFScanInfo *scan_info,
+  const unsigned char *p,const unsigned char **q)
+{
+  size_t
+    number;
+
+  if (p == (const unsigned char *) NULL)
+    return((const unsigned char *) NULL);
+  if (ReadPDFReference(p,*q,&number) == (const unsigned char *) NULL)
+    return(p);
+  return(GetPDFObject(scan_info,number,q));
+}
+
+static MagickBooleanType ReadPDFXrefStream(PDFScanInfo *scan_info,
+  const MagickOffsetType offset,MagickOffsetType *previous)
+{
+  const unsigned char
+    *index,
+    *p,
+    *q,
+    *value;
+
+  double
+    count,
+    size,
+    start,
+    width[3];
+
+  MagickOffsetType
+    generation,
+    number;
+
+  register size_t
+    i,
+    j;
+
+  size_t
+    extent,
+    entry;
+
+  unsigned char
+    *data,
+    *r;
+
+  /*
+    Read a cross-reference stream (PDF 1.5 and later).
+  */
+  q=scan_info->data+scan_info->length;
+  p=ReadPDFInteger(scan_info->data+offset,q,&number);
+  if (p != (const unsigned char *) NULL)
+    p=ReadPDFInteger(p,q,&generation);
+  if (p == (const unsigned char *) NULL)
+    return(MagickFalse);
+  p=SkipPDFWhitespace(p,q);
+  if (IsPDFKeyword(p,q,"obj") == MagickFalse)
+    return(MagickFalse);
+  p=SkipPDFWhitespace(p+3,q);
+  value=GetPDFValue(p,q,"W");
+  if ((value == (const unsigned char *) NULL) || (*value != '['))
+    return(MagickFalse);
+  value++;
+  for (i=0; i < 3; i++)
+  {
+    value=ReadPDFNumber(value,q,width+i);
+    if ((value == (const unsigned char *) NULL) || (width[i] < 0.0) ||
+        (width[i] > (double) (sizeof(MagickOffsetType)-1)))
+      return(MagickFalse);
+  }
+  value=GetPDFValue(p,q,"Size");
+  if ((value == (const unsigned char *) NULL) ||
+      (ReadPDFNumber(value,q,&size) == (const unsigned char *) NULL))
+    return(MagickFalse);
+  if (scan_info->root == 0)
+    {
+      value=GetPDFValue(p,q,"Root");
+      if (value != (const unsigned char *) NULL)
+        (void) ReadPDFReference(value,q,&scan_info->root);
+    }
+  *previous=0;
+  value=GetPDFValue(p,q,"Prev");
+  if (value != (const unsigned char *) NULL)
+    (void) ReadPDFInteger(value,q,previous);
+  entry=(size_t) width[0]+(size_t) width[1]+(size_t) width[2];
+  if (entry == 0)
+    return(MagickFalse);
+  data=GetPDFStreamData(scan_info,p,q,&extent);
+  if (data == (unsigned char *) NULL)
+    return(MagickFalse);
+  index=GetPDFValue(p,q,"Index");
+  if ((index != (const unsigned char *) NULL) && (*index == '['))
+    index++;
+  else
+    index=(const unsigned char *) NULL;
+  r=data;
+  for ( ; ; )
+  {
+    start=0.0;
+    count=size;
+    if (index != (const unsigned char *) NULL)
+      {
+        index=ReadPDFNumber(index,q,&start);
+        if (index != (const unsigned char *) NULL)
+          index=ReadPDFNumber(index,q,&count);
+        if (index == (const unsigned char *) NULL)
+          break;
+      }
+    if ((start < 0.0) || (count < 0.0))
+      break;
+    if (count > (double) (extent/entry))
+      count=(double) (extent/entry);
+    for (i=0; (i < (size_t) count) && ((r+entry) <= (data+extent)); i++)
+    {
+      MagickSizeType
+        field[3];
+
+      for (j=0; j < 3; j++)
+      {
+        register size_t
+          k;
+
+        field[j]=0;
+        for (k=0; k < (size_t) width[j]; k++)
+          field[j]=(field[j] << 8) | (*r++);
+      }
+      if (width[0] == 0.0)
+        field[0]=1;
+      if ((field[0] == 1) || (field[0] == 2))
+        SetPDFXrefEntry(scan_info,(size_t) start+i,(int) field[0],
+          (MagickOffsetType) field[1],(size_t) field[2]);
+    }
+    if (index == (const unsigned char *) NULL)
+      break;
+  }
+  data=(unsigned char *) RelinquishMagickMemory(data);
+  return(MagickTrue);
+}
+
+static MagickBooleanType ReadPDFXref(PDFScanInfo *scan_info)
+{
+  const unsigned char
+    *p,
+    *q,
+    *value;
+
+  MagickOffsetType
+    count,
+    generation,
+    object_offset,
+    offset,
+    previous,
+    start;
+
+  register ssize_t
+    i;
+
+  size_t
+    revisions;
+
+  /*
+    Locate startxref and walk the chain of cross-reference sections.
+  */
+  q=scan_info->data+scan_info->length;
+  p=q-MagickMin(scan_info->length,4096);
+  for (value=(const unsigned char *) NULL; p < q; p++)
+    if ((*p == 's') && (IsPDFKeyword(p,q,"startxref") != MagickFalse))
+      value=p+9;
+  if (value == (const unsigned char *) NULL)
+    return(MagickFalse);
+  if (ReadPDFInteger(value,q,&offset) == (const unsigned char *) NULL)
+    return(MagickFalse);
+  for (revisions=0; (offset > 0) && (revisions < 64); revisions++)
+  {
+    if (offset >= (MagickOffsetType) scan_info->length)
+      return(MagickFalse);
+    p=SkipPDFWhitespace(scan_info->data+offset,q);
+    if (IsPDFKeyword(p,q,"xref") == MagickFalse)
+      {
+        if (ReadPDFXrefStream(scan_info,offset,&previous) == MagickFalse)
+          return(MagickFalse);
+        offset=previous;
+        continue;
+      }
+    for (p+=4; ; )
+    {
+      p=SkipPDFWhitespace(p,q);
+      if (IsPDFKeyword(p,q,"trailer") != MagickFalse)
+        break;
+      p=ReadPDFInteger(p,q,&start);
+      if (p != (const unsigned char *) NULL)
+        p=ReadPDFInteger(p,q,&count);
+      if (p == (const unsigned char *) NULL)
+        return(MagickFalse);
+      for (i=0; i < (ssize_t) count; i++)
+      {
+        p=ReadPDFInteger(p,q,&object_offset);
+        if (p != (const unsigned char *) NULL)
+          p=ReadPDFInteger(p,q,&generation);
+        if (p == (const unsigned char *) NULL)
+          return(MagickFalse);
+        p=SkipPDFWhitespace(p,q);
+        if (p >= q)
+          return(MagickFalse);
+        if (*p == 'n')
+          SetPDFXrefEntry(scan_info,(size_t) (start+i),1,object_offset,0);
+        p++;
+      }
+    }
+    p+=7;
+    if (scan_info->root == 0)
+      {
+        value=GetPDFValue(p,q,"Root");
+        if (value != (const unsigned char *) NULL)
+          (void) ReadPDFReference(value,q,&scan_info->root);
+      }
+    value=GetPDFValue(p,q,"XRefStm");
+    if ((value != (const unsigned char *) NULL) &&
+        (ReadPDFInteger(value,q,&offset) != (const unsigned char *) NULL) &&
+        (offset >= 0) && (offset < (MagickOffsetType) scan_info->length))
+      (void) ReadPDFXrefStream(scan_info,offset,&previous);
+    offset=0;
+    value=GetPDFValue(p,q,"Prev");
+    if (value != (const unsigned char *) NULL)
+      (void) ReadPDFInteger(value,q,&offset);
+  }
+  return(scan_info->root != 0 ? MagickTrue : MagickFalse);
+}
+
+static MagickBooleanType ReadPDFBox(PDFScanInfo *scan_info,
+  const unsigned char *p,const unsigned char *q,SegmentInfo *box)
+{
+  double
+    values[4];
+
+  register ssize_t
+    i;
+
+  p=ResolvePDFValue(scan_info,p,&q);
+  if ((p == (const unsigned char *) NULL) || (*p != '['))
+    return(MagickFalse);
+  p++;
+  for (i=0; i < 4; i++)
+  {
+    p=ReadPDFNumber(p,q,values+i);
+    if (p == (const unsigned char *) NULL)
+      return(MagickFalse);
+  }
+  box->x1=MagickMin(values[0],values[2]);
+  box->y1=MagickMin(values[1],values[3]);
+  box->x2=MagickMax(values[0],values[2]);
+  box->y2=MagickMax(values[1],values[3]);
+  return(MagickTrue);
+}
+
+static void ScanPDFPageTree(PDFScanInfo *scan_info,const size_t number,
+  const SegmentInfo *inherited_box,const double inherited_angle,
+  const size_t depth,PDFInfo *pdf_info)
+{
+  const unsigned char
+    *kids,
+    *p,
+    *q,
+    *value;
+
+  double
+    angle;
+
+  SegmentInfo
+    box;
+
+  size_t
+    kid;
+
+  /*
+    Walk the page tree; boxes and rotation are inherited from parents.
+  */
+  if ((depth > 32) || (scan_info->visits++ > scan_info->number_objects))
+    return;
+  p=GetPDFObject(scan_info,number,&q);
+  if (p == (const unsigned char *) NULL)
+    return;
+  box=(*inherited_box);
+  angle=inherited_angle;
+  value=GetPDFValue(p,q,"MediaBox");
+  if (value != (const unsigned char *) NULL)
+    (void) ReadPDFBox(scan_info,value,q,&box);
+  value=(const unsigned char *) NULL;
+  if (scan_info->cropbox != MagickFalse)
+    value=GetPDFValue(p,q,"CropBox");
+  else
+    if (scan_info->trimbox != MagickFalse)
+      value=GetPDFValue(p,q,"TrimBox");
+  if (value != (const unsigned char *) NULL)
+    (void) ReadPDFBox(scan_info,value,q,&box);
+  value=GetPDFValue(p,q,"Rotate");
+  if (value != (const unsigned char *) NULL)
+    (void) ReadPDFNumber(ResolvePDFValue(scan_info,value,&q),q,&angle);
+  kids=GetPDFValue(p,q,"Kids");
+  if (kids == (const unsigned char *) NULL)
+    {
+      /*
+        A page: keep the largest box, the rotation of the first page.
+      */
+      if (pdf_info->number_pages == 0)
+        pdf_info->angle=angle;
+      if (pdf_info->number_pages < scan_info->number_extents)
+        {
+          PointInfo
+            *extent;
+
+          extent=scan_info->extents+pdf_info->number_pages;
+          extent->x=fabs(box.x2-box.x1);
+          extent->y=fabs(box.y2-box.y1);
+          if (fmod(fabs(angle),180.0) == 90.0)
+            {
+              extent->x=fabs(box.y2-box.y1);
+              extent->y=fabs(box.x2-box.x1);
+            }
+        }
+      pdf_info->number_pages++;
+      if ((fabs(box.x2-box.x1) > fabs(pdf_info->bounds.x2-
+           pdf_info->bounds.x1)) && (fabs(box.y2-box.y1) >
+          fabs(pdf_info->bounds.y2-pdf_info->bounds.y1)))
+        pdf_info->bounds=box;
+      return;
+    }
+  kids=ResolvePDFValue(scan_info,kids,&q);
+  if ((kids == (const unsigned char *) NULL) || (*kids != '['))
+    return;
+  for (kids++; ; )
+  {
+    kids=SkipPDFWhitespace(kids,q);
+    if ((kids >= q) || (*kids == ']'))
+      break;
+    value=ReadPDFReference(kids,q,&kid);
+    if (value == (const unsigned char *) NULL)
+      {
+        kids=SkipPDFValue(kids,q,0);
+        continue;
+      }
+    ScanPDFPageTree(scan_info,kid,&box,angle,depth+1,pdf_info);
+    kids=value;
+  }
+}
+
+static void ScanPDFColorspaces(PDFScanInfo *scan_info,Image *image,
+  PDFInfo *pdf_info,ExceptionInfo *exception)
+{
+  const unsigned char
+    *p,
+    *q,
+    *r;
+
+  register size_t
+    i;
+
+  size_t
+    spotcolor;
+
+  /*
+    Look for CMYK and separation color spaces in object dictionaries.
+  */
+  spotcolor=0;
+  for (i=1; i < scan_info->number_objects; i++)
+  {
+    p=GetPDFObject(scan_info,i,&q);
+    if (p == (const unsigned char *) NULL)
+      continue;
+    q=SkipPDFValue(p,q,0);
+    for ( ; p < q; p++)
+    {
+      if (*p != '/')
+        continue;
+      p++;
+      if ((IsPDFKeyword(p,q,"DefaultCMYK") != MagickFalse) ||
+          (IsPDFKeyword(p,q,"DeviceCMYK") != MagickFalse) ||
+          (IsPDFKeyword(p,q,"CMYKProcessColor") != MagickFalse))
+        pdf_info->cmyk=MagickTrue;
+      if (IsPDFKeyword(p,q,"Separation") == MagickFalse)
+        continue;
+      r=SkipPDFWhitespace(p+10,q);
+      if ((r < q) && (*r == '/'))
+        {
+          char
+            name[MagickPathExtent],
+            property[MagickPathExtent],
+            *value;
+
+          register size_t
+            j;
+
+          /*
+            Note spot names.
+          */
+          for (j=0, r++; (r < q) && (j < (MagickPathExtent-1)); j++, r++)
+          {
+            if (IsPDFRegular((int) *r) == MagickFalse)
+              break;
+            name[j]=(char) *r;
+          }
+          name[j]='\0';
+          (void) FormatLocaleString(property,MagickPathExtent,
+            "pdf:SpotColor-%.20g",(double) spotcolor++);
+          value=AcquireString(name);
+          (void) SubstituteString(&value,"#20"," ");
+          (void) SetImageProperty(image,property,value,exception);
+          value=DestroyString(value);
+        }
+    }
+  }
+}
+
+static void ClosePDFScan(PDFScanInfo *scan_info)
+{
+  register ssize_t
+    i;
+
+  for (i=0; i < (ssize_t) scan_info->number_streams; i++)
+    if (scan_info->streams[i].data != (unsigned char *) NULL)
+      scan_info->streams[i].data=(unsigned char *) RelinquishMagickMemory(
+        scan_info->streams[i].data);
+  if (scan_info->streams != (PDFStreamInfo *) NULL)
+    scan_info->streams=(PDFStreamInfo *) RelinquishMagickMemory(
+      scan_info->streams);
+  if (scan_info->xref != (PDFXrefInfo *) NULL)
+    scan_info->xref=(PDFXrefInfo *) RelinquishMagickMemory(scan_info->xref);
+  (void) UnmapBlob((void *) scan_info->data,scan_info->length);
+  scan_info->data=(const unsigned char *) NULL;
+}
+
+static MagickBooleanType OpenPDFScan(const char *filename,
+  const MagickBooleanType cropbox,const MagickBooleanType trimbox,
+  PDFScanInfo *scan_info)
+{
+  const unsigned char
+    *p,
+    *q,
+    *value;
+
+  int
+    file;
+
+  struct stat
+    attributes;
+
+  /*
+    Map the document and locate the root of its page tree.
+  */
+  (void) ResetMagickMemory(scan_info,0,sizeof(*scan_info));
+  if ((GetPathAttributes(filename,&attributes) == MagickFalse) ||
+      (S_ISREG(attributes.st_mode) == 0) || (attributes.st_size < 16))
+    return(MagickFalse);
+  file=open_utf8(filename,O_RDONLY | O_BINARY,0);
+  if (file == -1)
+    return(MagickFalse);
+  scan_info->length=(size_t) attributes.st_size;
+  scan_info->data=(const unsigned char *) MapBlob(file,ReadMode,0,
+    scan_info->length);
+  (void) close(file);
+  if (scan_info->data == (const unsigned char *) NULL)
+    return(MagickFalse);
+  scan_info->cropbox=cropbox;
+  scan_info->trimbox=trimbox;
+  if (ReadPDFXref(scan_info) != MagickFalse)
+    {
+      q=scan_info->data+scan_info->length;
+      p=GetPDFObject(scan_info,scan_info->root,&q);
+      value=(const unsigned char *) NULL;
+      if (p != (const unsigned char *) NULL)
+        value=GetPDFValue(p,q,"Pages");
+      if ((value != (const unsigned char *) NULL) &&
+          (ReadPDFReference(value,q,&scan_info->pages) !=
+           (const unsigned char *) NULL))
+        return(MagickTrue);
+    }
+  ClosePDFScan(scan_info);
+  return(MagickFalse);
+}
+
+static RectangleInfo *GetPDFPageGeometries(const char *filename,
+  const MagickBooleanType cropbox,const MagickBooleanType trimbox,
+  const PointInfo *resolution,const size_t number_pages)
+{
+  PDFInfo
+    pdf_info;
+
+  PDFScanInfo
+    scan_info;
+
+  RectangleInfo
+    *geometries;
+
+  register ssize_t
+    i;
+
+  SegmentInfo
+    box;
+
+  /*
+    The size Ghostscript renders each page at, from its (rotated) box.
+  */
+  if (OpenPDFScan(filename,cropbox,trimbox,&scan_info) == MagickFalse)
+    return((RectangleInfo *) NULL);
+  scan_info.extents=(PointInfo *) AcquireQuantumMemory(number_pages,
+    sizeof(*scan_info.extents));
+  geometries=(RectangleInfo *) AcquireQuantumMemory(number_pages,
+    sizeof(*geometries));
+  if ((scan_info.extents == (PointInfo *) NULL) ||
+      (geometries == (RectangleInfo *) NULL))
+    {
+      if (geometries != (RectangleInfo *) NULL)
+        geometries=(RectangleInfo *) RelinquishMagickMemory(geometries);
+      if (scan_info.extents != (PointInfo *) NULL)
+        scan_info.extents=(PointInfo *) RelinquishMagickMemory(
+          scan_info.extents);
+      ClosePDFScan(&scan_info);
+      return((RectangleInfo *) NULL);
+    }
+  scan_info.number_extents=number_pages;
+  (void) ResetMagickMemory(&pdf_info,0,sizeof(pdf_info));
+  (void) ResetMagickMemory(&box,0,sizeof(box));
+  ScanPDFPageTree(&scan_info,scan_info.pages,&box,0.0,0,&pdf_info);
+  if (pdf_info.number_pages != number_pages)
+    geometries=(RectangleInfo *) RelinquishMagickMemory(geometries);
+  else
+    for (i=0; i < (ssize_t) number_pages; i++)
+    {
+      (void) ResetMagickMemory(geometries+i,0,sizeof(*geometries));
+      geometries[i].width=(size_t) floor(scan_info.extents[i].x*
+        resolution->x/72.0+0.5);
+      geometries[i].height=(size_t) floor(scan_info.extents[i].y*
+        resolution->y/72.0+0.5);
+    }
+  scan_info.extents=(PointInfo *) RelinquishMagickMemory(scan_info.extents);
+  ClosePDFScan(&scan_info);
+  return(geometries);
+}
+
+static MagickBooleanType ScanPDFStructure(const char *filename,
+  const MagickBooleanType cropbox,const MagickBooleanType trimbox,
+  Image *image,PDFInfo *pdf_info,ExceptionInfo *exception)
+{
+  char
+    version[MagickPathExtent];
+
+  const unsigned char
+    *p,
+    *q;
+
+  MagickBooleanType
+    status;
+
+  PDFScanInfo
+    scan_info;
+
+  register ssize_t
+    i;
+
+  SegmentInfo
+    box;
+
+  /*
+    Map the document and read its structure without a byte-wise pass.
+  */
+  (void) ResetMagickMemory(pdf_info,0,sizeof(*pdf_info));
+  if (OpenPDFScan(filename,cropbox,trimbox,&scan_info) == MagickFalse)
+    return(MagickFalse);
+  (void) ResetMagickMemory(&box,0,sizeof(box));
+  ScanPDFPageTree(&scan_info,scan_info.pages,&box,0.0,0,pdf_info);
+  status=pdf_info->number_pages != 0 ? MagickTrue : MagickFalse;
+  if (status != MagickFalse)
+    {
+      ScanPDFColorspaces(&scan_info,image,pdf_info,exception);
+      q=scan_info.data+MagickMin(scan_info.length,1024);
+      for (p=scan_info.data; (p+5) < q; p++)
+      {
+        if ((*p != '%') || (memcmp(p+1,"PDF-",4) != 0))
+          continue;
+        for (i=0, p++; (p < q) && (i < 16); i++, p++)
+        {
+          if ((IsPDFWhitespace((int) *p) != MagickFalse) || (*p == '%'))
+            break;
+          version[i]=(char) *p;
+        }
+        version[i]='\0';
+        (void) SetImageProperty(image,"pdf:Version",version,exception);
+        break;
+      }
+    }
+  ClosePDFScan(&scan_info);
+  return(status);
+}
+
+static void *DestroyPDFMetadata(void *metadata)
+{
+  PDFMetadataInfo
+    *p;
+
+  register ssize_t
+    i;
+
+  p=(PDFMetadataInfo *) metadata;
+  if (p->path != (char *) NULL)
+    p->path=DestroyString(p->path);
+  if (p->version != (char *) NULL)
+    p->version=DestroyString(p->version);
+  if (p->spot_colors != (char **) NULL)
+    {
+      for (i=0; i < (ssize_t) p->number_spot_colors; i++)
+        p->spot_colors[i]=DestroyString(p->spot_colors[i]);
+      p->spot_colors=(char **) RelinquishMagickMemory(p->spot_colors);
+    }
+  return(RelinquishMagickMemory(p));
+}
+
+static MagickBooleanType IsPDFMetadataInstantiated(void)
+{
+  if (pdf_metadata == (LinkedListInfo *) NULL)
+    {
+      if (pdf_semaphore == (SemaphoreInfo *) NULL)
+        ActivateSemaphoreInfo(&pdf_semaphore);
+      LockSemaphoreInfo(pdf_semaphore);
+      if (pdf_metadata == (LinkedListInfo *) NULL)
+        {
+          char
+            *value;
+
+          value=GetEnvironmentValue("MAGICK_PDF_CACHE_ENTRIES");
+          if (value != (char *) NULL)
+            {
+              pdf_metadata_entries=StringToUnsignedLong(value);
+              value=DestroyString(value);
+            }
+          value=GetPolicyValue("pdf:cache-entries");
+          if (value != (char *) NULL)
+            {
+              pdf_metadata_entries=StringToUnsignedLong(value);
+              value=DestroyString(value);
+            }
+          pdf_metadata=NewLinkedList(0);
+        }
+      UnlockSemaphoreInfo(pdf_semaphore);
+    }
+  return(pdf_metadata != (LinkedListInfo *) NULL ? MagickTrue : MagickFalse);
+}
+
+static MagickBooleanType GetPDFMetadata(const char *path,
+  const MagickBooleanType cropbox,const MagickBooleanType trimbox,
+  Image *image,PDFInfo *pdf_info,ExceptionInfo *exception)
+{
+  PDFMetadataInfo
+    *metadata;
+
+  register ssize_t
+    i;
+
+  struct stat
+    attributes;
+
+  /*
+    Look up the document by path, size, and modification time.
+  */
+  if ((IsPDFMetadataInstantiated() == MagickFalse) ||
+      (pdf_metadata_entries == 0))
+    return(MagickFalse);
+  if ((GetPathAttributes(path,&attributes) == MagickFalse) ||
+      (S_ISREG(attributes.st_mode) == 0))
+    return(MagickFalse);
+  LockSemaphoreInfo(pdf_semaphore);
+  ResetLinkedListIterator(pdf_metadata);
+  metadata=(PDFMetadataInfo *) GetNextValueInLinkedList(pdf_metadata);
+  while (metadata != (PDFMetadataInfo *) NULL)
+  {
+    if ((LocaleCompare(path,metadata->path) == 0) &&
+        (metadata->cropbox == cropbox) && (metadata->trimbox == trimbox))
+      break;
+    metadata=(PDFMetadataInfo *) GetNextValueInLinkedList(pdf_metadata);
+  }
+  if (metadata == (PDFMetadataInfo *) NULL)
+    {
+      UnlockSemaphoreInfo(pdf_semaphore);
+      return(MagickFalse);
+    }
+  if ((metadata->extent != (MagickSizeType) attributes.st_size) ||
+      (metadata->modify_time != attributes.st_mtime))
+    {
+      /*
+        The document changed since it was scanned.
+      */
+      (void) RemoveElementByValueFromLinkedList(pdf_metadata,metadata);
+      UnlockSemaphoreInfo(pdf_semaphore);
+      (void) DestroyPDFMetadata(metadata);
+      return(MagickFalse);
+    }
+  metadata->hits++;
+  *pdf_info=metadata->pdf_info;
+  if (metadata->version != (char *) NULL)
+    (void) SetImageProperty(image,"pdf:Version",metadata->version,exception);
+  for (i=0; i < (ssize_t) metadata->number_spot_colors; i++)
+  {
+    char
+      property[MagickPathExtent];
+
+    (void) FormatLocaleString(property,MagickPathExtent,"pdf:SpotColor-%.20g",
+      (double) i);
+    (void) SetImageProperty(image,property,metadata->spot_colors[i],exception);
+  }
+  /*
+    Keep the most recently used entries at the tail.
+  */
+  (void) RemoveElementByValueFromLinkedList(pdf_metadata,metadata);
+  (void) AppendValueToLinkedList(pdf_metadata,metadata);
+  UnlockSemaphoreInfo(pdf_semaphore);
+  return(MagickTrue);
+}
+
+static MagickBooleanType ListPDFMetadata(FILE *file,
+  ExceptionInfo *magick_unused(exception))
+{
+  const PDFMetadataInfo
+    *metadata;
+
+  magick_unreferenced(exception);
+  if ((pdf_metadata == (LinkedListInfo *) NULL) ||
+      (IsLinkedListEmpty(pdf_metadata) != MagickFalse))
+    return(MagickTrue);
+  (void) FormatLocaleFile(file,"\nPDF metadata (cache entries %.20g)\n\n",
+    (double) pdf_metadata_entries);
+  (void) FormatLocaleFile(file,
+    "Pages  Rotate  CMYK  Spots   Hits  Geometry            Path\n");
+  (void) FormatLocaleFile(file,
+    "-------------------------------------------------"
+    "------------------------------\n");
+  LockSemaphoreInfo(pdf_semaphore);
+  ResetLinkedListIterator(pdf_metadata);
+  metadata=(const PDFMetadataInfo *) GetNextValueInLinkedList(pdf_metadata);
+  while (metadata != (const PDFMetadataInfo *) NULL)
+  {
+    char
+      geometry[MagickPathExtent];
+
+    const SegmentInfo
+      *bounds;
+
+    bounds=(&metadata->pdf_info.bounds);
+    (void) FormatLocaleString(geometry,MagickPathExtent,"%gx%g%+g%+g",
+      bounds->x2-bounds->x1,bounds->y2-bounds->y1,bounds->x1,bounds->y1);
+    (void) FormatLocaleFile(file,"%5.20g  %6g  %4s  %5.20g  %5.20g  %-18s  "
+      "%s\n",(double) metadata->pdf_info.number_pages,
+      metadata->pdf_info.angle,metadata->pdf_info.cmyk != MagickFalse ?
+      "yes" : "no",(double) metadata->number_spot_colors,(double)
+      metadata->hits,geometry,metadata->path);
+    metadata=(const PDFMetadataInfo *) GetNextValueInLinkedList(pdf_metadata);
+  }
+  UnlockSemaphoreInfo(pdf_semaphore);
+  return(MagickTrue);
+}
+
+static void SetPDFMetadata(const char *path,const MagickBooleanType cropbox,
+  const MagickBooleanType trimbox,const Image *image,const PDFInfo *pdf_info)
+{
+  char
+    property[MagickPathExtent];
+
+  const char
+    *value;
+
+  PDFMetadataInfo
+    *metadata,
+    *p;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_spot_colors;
+
+  struct stat
+    attributes;
+
+  /*
+    Remember the document structure for the next read of this file.
+  */
+  if ((IsPDFMetadataInstantiated() == MagickFalse) ||
+      (pdf_metadata_entries == 0))
+    return;
+  if ((GetPathAttributes(path,&attributes) == MagickFalse) ||
+      (S_ISREG(attributes.st_mode) == 0))
+    return;
+  metadata=(PDFMetadataInfo *) AcquireMagickMemory(sizeof(*metadata));
+  if (metadata == (PDFMetadataInfo *) NULL)
+    return;
+  (void) ResetMagickMemory(metadata,0,sizeof(*metadata));
+  metadata->path=ConstantString(path);
+  metadata->extent=(MagickSizeType) attributes.st_size;
+  metadata->modify_time=attributes.st_mtime;
+  metadata->cropbox=cropbox;
+  metadata->trimbox=trimbox;
+  metadata->pdf_info=(*pdf_info);
+  value=GetImageProperty(image,"pdf:Version",(ExceptionInfo *) NULL);
+  if (value != (const char *) NULL)
+    metadata->version=ConstantString(value);
+  for (number_spot_colors=0; ; number_spot_colors++)
+  {
+    (void) FormatLocaleString(property,MagickPathExtent,"pdf:SpotColor-%.20g",
+      (double) number_spot_colors);
+    if (GetImageProperty(image,property,(ExceptionInfo *) NULL) ==
+        (const char *) NULL)
+      break;
+  }
+  if (number_spot_colors != 0)
+    {
+      metadata->spot_colors=(char **) AcquireQuantumMemory(number_spot_colors,
+        sizeof(*metadata->spot_colors));
+      if (metadata->spot_colors == (char **) NULL)
+        {
+          (void) DestroyPDFMetadata(metadata);
+          return;
+        }
+      for (i=0; i < (ssize_t) number_spot_colors; i++)
+      {
+        (void) FormatLocaleString(property,MagickPathExtent,
+          "pdf:SpotColor-%.20g",(double) i);
+        value=GetImageProperty(image,property,(ExceptionInfo *) NULL);
+        metadata->spot_colors[i]=ConstantString(value);
+      }
+      metadata->number_spot_colors=number_spot_colors;
+    }
+  LockSemaphoreInfo(pdf_semaphore);
+  i=0;
+  while (i < (ssize_t) GetNumberOfElementsInLinkedList(pdf_metadata))
+  {
+    /*
+      Replace an earlier scan of the same document.
+    */
+    p=(PDFMetadataInfo *) GetValueFromLinkedList(pdf_metadata,(size_t) i);
+    if ((LocaleCompare(p->path,path) != 0) || (p->cropbox != cropbox) ||
+        (p->trimbox != trimbox))
+      {
+        i++;
+        continue;
+      }
+    (void) RemoveElementFromLinkedList(pdf_metadata,(size_t) i);
+    (void) DestroyPDFMetadata(p);
+  }
+  while (GetNumberOfElementsInLinkedList(pdf_metadata) >= pdf_metadata_entries)
+  {
+    /*
+      Evict the least recently used document.
+    */
+    p=(PDFMetadataInfo *) RemoveElementFromLinkedList(pdf_metadata,0);
+    (void) DestroyPDFMetadata(p);
+  }
+  (void) AppendValueToLinkedList(pdf_metadata,metadata);
+  UnlockSemaphoreInfo(pdf_semaphore);
+}
+
+#if defined(MAGICKCORE_GS_DISPLAY_DELEGATE)
+static Image *RenderPDFBands(const ImageInfo *image_info,
+  const PointInfo *resolution,const char *density,const char *options,
+  const char *input_filename,const size_t columns,const size_t rows,
+  const size_t band_height,const size_t first_page,const size_t last_page,
+  char *message,ExceptionInfo *exception)
+{
+  char
+    band_options[MagickPathExtent],
+    command[MagickPathExtent],
+    prologue[MagickPathExtent];
+
+  Image
+    *canvas,
+    *images;
+
+  MagickBooleanType
+    status;
+
+  PDFDisplayInfo
+    display_info;
+
+  size_t
+    rows_per_band;
+
+  ssize_t
+    page,
+    y;
+
+  /*
+    Render each page as a series of horizontal bands.  Ghostscript only
+    allocates a band bitmap and each band is streamed into a page canvas
+    backed by a disk or memory-mapped pixel cache, or row by row to the
+    stream handler if the image is read as a stream.  Each band interprets
+    the page again, so this trades rendering time for peak memory.
+  */
+  images=NewImageList();
+  (void) ResetMagickMemory(&display_info,0,sizeof(display_info));
+  display_info.image_info=image_info;
+  display_info.resolution=(*resolution);
+  display_info.exception=exception;
+  status=MagickTrue;
+  for (page=(ssize_t) first_page; page <= (ssize_t) last_page; page++)
+  {
+    canvas=AcquireImage(image_info,exception);
+    canvas->resolution=(*resolution);
+    canvas->scene=(size_t) (page-1);
+    if (image_info->stream != (StreamHandler) NULL)
+      {
+        /*
+          Bands go straight to the stream handler, there is no pixel cache
+          to size.
+        */
+        canvas->columns=columns;
+        canvas->rows=rows;
+      }
+    else
+      {
+        (void) SetPixelCacheType(canvas,DiskCache);
+        status=SetImageExtent(canvas,columns,rows,exception);
+        if (status == MagickFalse)
+          {
+            canvas=DestroyImage(canvas);
+            break;
+          }
+      }
+    display_info.canvas=canvas;
+    for (y=0; y < (ssize_t) rows; y+=(ssize_t) band_height)
+    {
+      /*
+        Shift the page up so this band lands on the fixed band-sized media.
+      */
+      rows_per_band=MagickMin(band_height,rows-(size_t) y);
+      (void) FormatLocaleString(band_options,MagickPathExtent,
+        "%s-dFIXEDMEDIA -g%.20gx%.20g ",options,(double) columns,(double)
+        rows_per_band);
+      (void) FormatLocaleString(command,MagickPathExtent,PDFDisplayArguments,
+        image_info->antialias != MagickFalse ? 4 : 1,
+        image_info->antialias != MagickFalse ? 4 : 1,density,band_options);
+      (void) FormatLocaleString(prologue,MagickPathExtent,
+        "<</BeginPage {pop 0 %g translate}>> setpagedevice",(double)
+        ((ssize_t) (y+rows_per_band)-(ssize_t) rows)*72.0/resolution->y);
+      display_info.band_offset=y;
+      status=InvokePDFDisplay(image_info->verbose,command,prologue,(size_t)
+        page,(size_t) page,input_filename,&display_info,message,exception);
+      if (status == MagickFalse)
+        break;
+    }
+    if (status == MagickFalse)
+      {
+        canvas=DestroyImage(canvas);
+        break;
+      }
+    AppendImageToList(&images,canvas);
+  }
+  if ((status == MagickFalse) && (images != (Image *) NULL))
+    images=DestroyImageList(images);
+  return(images);
+}
+#endif
+
+static Image *RenderPDFPages(const ImageInfo *image_info,Image *image,
+  const DelegateInfo *delegate_info,const char *density,const char *options,
+  const char *filename,const char *postscript_filename,
+  const char *input_filename,const size_t first_page,const size_t last_page,
+  PDFTimingInfo *timing,char *message,ExceptionInfo *exception)
+{
+  char
+    arguments[MagickPathExtent],
+    command[MagickPathExtent],
+    pages[MagickPathExtent],
+    template[MagickPathExtent];
+
+  Image
+    *images,
+    *next;
+
+  ImageInfo
+    *read_info;
+
+  MagickBooleanType
+    status;
+
+  register ssize_t
+    i;
+
+  TimerInfo
+    timer;
+
+  /*
+    Render pages first_page through last_page (0 for the whole document or
+    through to the last page) and read back the rendered frames.
+  */
+  read_info=CloneImageInfo(image_info);
+  *read_info->magick='\0';
+  read_info->number_scenes=0;
+  if (read_info->scenes != (char *) NULL)
+    *read_info->scenes='\0';
+  (void) CopyMagickString(arguments,options,MagickPathExtent);
+  if (first_page != 0)
+    {
+      (void) FormatLocaleString(pages,MagickPathExtent,"-dFirstPage=%.20g ",
+        (double) first_page);
+      (void) ConcatenateMagickString(arguments,pages,MagickPathExtent);
+    }
+  if (last_page != 0)
+    {
+      (void) FormatLocaleString(pages,MagickPathExtent,"-dLastPage=%.20g",
+        (double) last_page);
+      (void) ConcatenateMagickString(arguments,pages,MagickPathExtent);
+    }
+  (void) FormatLocaleString(template,MagickPathExtent,"%s%%d",filename);
+  (void) FormatLocaleString(command,MagickPathExtent,
+    GetDelegateCommands(delegate_info),
+    read_info->antialias != MagickFalse ? 4 : 1,
+    read_info->antialias != MagickFalse ? 4 : 1,density,arguments,template,
+    postscript_filename,input_filename);
+  status=InvokePDFDelegate(read_info->verbose,command,(PDFDisplayInfo *) NULL,
+    IsPDFDocument(input_filename),timing,message,exception);
+  GetTimerInfo(&timer);
+  images=(Image *) NULL;
+  for (i=1; ; i++)
+  {
+    (void) InterpretImageFilename(image_info,image,template,(int) i,
+      read_info->filename,exception);
+    if (IsPDFRendered(read_info->filename) == MagickFalse)
+      break;
+    if (status == MagickFalse)
+      {
+        (void) RelinquishUniqueFileResource(read_info->filename);
+        continue;
+      }
+    read_info->blob=NULL;
+    read_info->length=0;
+    next=ReadImage(read_info,exception);
+    (void) RelinquishUniqueFileResource(read_info->filename);
+    if (next == (Image *) NULL)
+      break;
+    AppendImageToList(&images,next);
+  }
+  if (timing != (PDFTimingInfo *) NULL)
+    timing->read+=GetElapsedTime(&timer);
+  read_info=DestroyImageInfo(read_info);
+  return(images);
+}
+
+static PDFDocumentInfo *DestroyPDFDocumentInfo(
+  PDFDocumentInfo *document_info)
+{
+  LockSemaphoreInfo(document_info->semaphore);
+  document_info->reference_count--;
+  if (document_info->reference_count != 0)
+    {
+      UnlockSemaphoreInfo(document_info->semaphore);
+      return((PDFDocumentInfo *) NULL);
+    }
+  UnlockSemaphoreInfo(document_info->semaphore);
+  if (*document_info->postscript_filename != '\0')
+    (void) RelinquishUniqueFileResource(document_info->postscript_filename);
+  if (*document_info->input_filename != '\0')
+    (void) RelinquishUniqueFileResource(document_info->input_filename);
+  document_info->pages=DestroyLinkedList(document_info->pages,
+    (void *(*)(void *)) NULL);
+  document_info->options=DestroyString(document_info->options);
+  document_info->density=DestroyString(document_info->density);
+  document_info->image_info=DestroyImageInfo(document_info->image_info);
+  RelinquishSemaphoreInfo(&document_info->semaphore);
+  return((PDFDocumentInfo *) RelinquishMagickMemory(document_info));
+}
+
+static void *RelinquishPDFPageInfo(void *page_info)
+{
+  PDFDocumentInfo
+    *document_info;
+
+  document_info=((PDFPageInfo *) page_info)->document;
+  LockSemaphoreInfo(document_info->semaphore);
+  (void) RemoveElementByValueFromLinkedList(document_info->pages,page_info);
+  UnlockSemaphoreInfo(document_info->semaphore);
+  (void) DestroyPDFDocumentInfo(document_info);
+  return(RelinquishMagickMemory(page_info));
+}
+
+static void NotePDFPageResident(PDFPageInfo *page_info)
+{
+  PDFDocumentInfo
+    *document_info;
+
+  PDFPageInfo
+    *oldest;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_pages;
+
+  /*
+    Unload the least recently rendered pages beyond the resident limit.  The
+    loader runs without the lock of the cache it fills, so unloading another
+    cache here cannot deadlock with a load of that cache.  Pages that are
+    pinned by a cache view or were written to stay resident and are kept in
+    the list.
+  */
+  document_info=page_info->document;
+  if (document_info->resident_pages == 0)
+    return;
+  LockSemaphoreInfo(document_info->semaphore);
+  (void) AppendValueToLinkedList(document_info->pages,page_info);
+  number_pages=GetNumberOfElementsInLinkedList(document_info->pages);
+  for (i=1; i < (ssize_t) number_pages; i++)
+  {
+    if (GetNumberOfElementsInLinkedList(document_info->pages) <=
+        document_info->resident_pages)
+      break;
+    oldest=(PDFPageInfo *) RemoveElementFromLinkedList(document_info->pages,0);
+    if (UnloadPixelCache(oldest->cache) == MagickFalse)
+      (void) AppendValueToLinkedList(document_info->pages,oldest);
+  }
+  UnlockSemaphoreInfo(document_info->semaphore);
+}
+
+static Image *LoadPDFPage(const Image *magick_unused(image),void *loader_info,
+  ExceptionInfo *exception)
+{
+  char
+    filename[MagickPathExtent],
+    message[MagickPathExtent];
+
+  Image
+    *page_image,
+    *pages;
+
+  PDFDocumentInfo
+    *document_info;
+
+  PDFPageInfo
+    *page_info;
+
+  /*
+    Render a single page of a PDF read on demand.
+  */
+  magick_unreferenced(image);
+  page_info=(PDFPageInfo *) loader_info;
+  document_info=page_info->document;
+  (void) CopyMagickString(filename,document_info->image_info->filename,
+    MagickPathExtent);
+  (void) AcquireUniqueFilename(filename);
+  (void) RelinquishUniqueFileResource(filename);
+  *message='\0';
+  pages=RenderPDFPages(document_info->image_info,(Image *) NULL,
+    document_info->delegate_info,document_info->density,
+    document_info->options,filename,document_info->postscript_filename,
+    document_info->input_filename,page_info->page,page_info->page,
+    (PDFTimingInfo *) NULL,message,exception);
+  if (pages == (Image *) NULL)
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),DelegateError,
+        "PDFDelegateFailed","`%s'",*message != '\0' ? message :
+        document_info->image_info->filename);
+      return((Image *) NULL);
+    }
+  page_image=RemoveFirstImageFromList(&pages);
+  if (pages != (Image *) NULL)
+    pages=DestroyImageList(pages);
+  NotePDFPageResident(page_info);
+  return(page_image);
+}
 
-static MagickBooleanType IsPDFRendered(const char *path)
+static Image *ReadPDFPagesOnDemand(const ImageInfo *image_info,
+  const DelegateInfo *delegate_info,const char *density,const char *options,
+  const char *filename,const char *postscript_filename,
+  const char *input_filename,const size_t number_pages,
+  const RectangleInfo *geometries,PDFTimingInfo *timing,char *message,
+  ExceptionInfo *exception)
 {
-  MagickBooleanType
-    status;
+  const char
+    *option;
 
-  struct stat
-    attributes;
+  Image
+    *images,
+    *next;
 
-  if ((path == (const char *) NULL) || (*path == '\0'))
-    return(MagickFalse);
-  status=GetPathAttributes(path,&attributes);
-  if ((status != MagickFalse) && S_ISREG(attributes.st_mode) &&
-      (attributes.st_size > 0))
-    return(MagickTrue);
-  return(MagickFalse);
+  PDFDocumentInfo
+    *document_info;
+
+  PDFPageInfo
+    *page_info;
+
+  register ssize_t
+    i;
+
+  /*
+    Render the first page now; the remaining pages are placeholder frames
+    whose pixel caches are filled when their pixels are first accessed.  A
+    placeholder takes the size of its page box if it differs from the first.
+  */
+  images=RenderPDFPages(image_info,(Image *) NULL,delegate_info,density,
+    options,filename,postscript_filename,input_filename,1,1,timing,message,
+    exception);
+  if (images == (Image *) NULL)
+    return((Image *) NULL);
+  if ((GetNextImageInList(images) != (Image *) NULL) ||
+      (LocaleCompare(images->magick,"BMP") == 0))
+    {
+      images=DestroyImageList(images);
+      return((Image *) NULL);
+    }
+  document_info=(PDFDocumentInfo *) AcquireMagickMemory(
+    sizeof(*document_info));
+  if (document_info == (PDFDocumentInfo *) NULL)
+    {
+      images=DestroyImageList(images);
+      return((Image *) NULL);
+    }
+  (void) ResetMagickMemory(document_info,0,sizeof(*document_info));
+  document_info->image_info=CloneImageInfo(image_info);
+  *document_info->image_info->magick='\0';
+  document_info->image_info->number_scenes=0;
+  if (document_info->image_info->scenes != (char *) NULL)
+    *document_info->image_info->scenes='\0';
+  document_info->delegate_info=delegate_info;
+  document_info->density=AcquireString(density);
+  document_info->options=AcquireString(options);
+  (void) CopyMagickString(document_info->postscript_filename,
+    postscript_filename,MagickPathExtent);
+  (void) CopyMagickString(document_info->input_filename,input_filename,
+    MagickPathExtent);
+  option=GetImageOption(image_info,"pdf:lazy-pages");
+  if (option != (const char *) NULL)
+    document_info->resident_pages=StringToUnsignedLong(option);
+  document_info->pages=NewLinkedList(0);
+  document_info->semaphore=AcquireSemaphoreInfo();
+  document_info->reference_count=1;
+  for (i=0; i < (ssize_t) number_pages; i++)
+  {
+    next=images;
+    if (i != 0)
+      {
+        if ((geometries == (const RectangleInfo *) NULL) ||
+            ((geometries[i].width == geometries[0].width) &&
+             (geometries[i].height == geometries[0].height)) ||
+            (geometries[i].width == 0) || (geometries[i].height == 0))
+          next=CloneImage(images,0,0,MagickTrue,exception);
+        else
+          next=CloneImage(images,geometries[i].width,geometries[i].height,
+            MagickTrue,exception);
+        if (next == (Image *) NULL)
+          break;
+      }
+    page_info=(PDFPageInfo *) AcquireMagickMemory(sizeof(*page_info));
+    if (page_info == (PDFPageInfo *) NULL)
+      {
+        if (next != images)
+          next=DestroyImage(next);
+        break;
+      }
+    page_info->document=document_info;
+    page_info->page=(size_t) i+1;
+    LockSemaphoreInfo(document_info->semaphore);
+    document_info->reference_count++;
+    UnlockSemaphoreInfo(document_info->semaphore);
+    if (SetPixelCacheLoader(next,LoadPDFPage,page_info,RelinquishPDFPageInfo,
+          i == 0 ? MagickTrue : MagickFalse) == MagickFalse)
+      {
+        (void) RelinquishPDFPageInfo(page_info);
+        if (next != images)
+          next=DestroyImage(next);
+        break;
+      }
+    page_info->cache=next->cache;
+    if (i == 0)
+      NotePDFPageResident(page_info);
+    else
+      AppendImageToList(&images,next);
+  }
+  if (i < (ssize_t) number_pages)
+    {
+      /*
+        Keep the control and input files: the caller still owns them.
+      */
+      *document_info->postscript_filename='\0';
+      *document_info->input_filename='\0';
+      images=DestroyImageList(images);
+    }
+  (void) DestroyPDFDocumentInfo(document_info);
+  return(images);
+}
+
+static void SetPDFTimingArtifacts(Image *image,const PDFTimingInfo *timing)
+{
+  char
+    value[MagickPathExtent];
+
+  /*
+    Seconds spent in each stage of the read, for benchmarks and tracing.
+  */
+  (void) FormatLocaleString(value,MagickPathExtent,"%.9g",timing->scan);
+  (void) SetImageArtifact(image,"pdf:elapsed-scan",value);
+  (void) FormatLocaleString(value,MagickPathExtent,"%.9g",timing->startup);
+  (void) SetImageArtifact(image,"pdf:elapsed-startup",value);
+  (void) FormatLocaleString(value,MagickPathExtent,"%.9g",timing->render);
+  (void) SetImageArtifact(image,"pdf:elapsed-render",value);
+  (void) FormatLocaleString(value,MagickPathExtent,"%.9g",timing->read);
+  (void) SetImageArtifact(image,"pdf:elapsed-read",value);
+  (void) FormatLocaleString(value,MagickPathExtent,"%.9g",
+    timing->consolidate);
+  (void) SetImageArtifact(image,"pdf:elapsed-consolidate",value);
 }
 
 static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
@@ -376,6 +2971,7 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
 #define DefaultCMYK  "DefaultCMYK"
 #define DeviceCMYK  "DeviceCMYK"
 #define MediaBox  "MediaBox"
+#define PDFPage  "Page"
 #define RenderPostscriptText  "Rendering Postscript...  "
 #define PDFRotate  "Rotate"
 #define SpotColor  "Separation"
@@ -417,9 +3013,12 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
     file;
 
   MagickBooleanType
+    cached,
     cmyk,
     cropbox,
+    direct,
     fitPage,
+    lazy,
     status,
     stop_on_error,
     trimbox;
@@ -427,6 +3026,15 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
   MagickStatusType
     flags;
 
+  PDFDisplayInfo
+    display_info;
+
+  PDFInfo
+    pdf_info;
+
+  PDFTimingInfo
+    timing;
+
   PointInfo
     delta;
 
@@ -445,12 +3053,19 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
     hires_bounds;
 
   size_t
+    band_height,
+    first_page,
+    last_page,
+    number_pages,
     scene,
     spotcolor;
 
   ssize_t
     count;
 
+  TimerInfo
+    timer;
+
   assert(image_info != (const ImageInfo *) NULL);
   assert(image_info->signature == MagickCoreSignature);
   if (image_info->debug != MagickFalse)
@@ -458,6 +3073,7 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
       image_info->filename);
   assert(exception != (ExceptionInfo *) NULL);
   assert(exception->signature == MagickCoreSignature);
+  (void) ResetMagickMemory(&timing,0,sizeof(timing));
   /*
     Open image file.
   */
@@ -508,11 +3124,44 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
   /*
     Determine page geometry from the PDF media box.
   */
-  cmyk=image_info->colorspace == CMYKColorspace ? MagickTrue : MagickFalse;
+  cmyk=MagickFalse;
   cropbox=IsStringTrue(GetImageOption(image_info,"pdf:use-cropbox"));
   stop_on_error=IsStringTrue(GetImageOption(image_info,"pdf:stop-on-error"));
   trimbox=IsStringTrue(GetImageOption(image_info,"pdf:use-trimbox"));
+  band_height=0;
+  option=GetImageOption(image_info,"pdf:band-height");
+  if (option != (const char *) NULL)
+    band_height=StringToUnsignedLong(option);
+  direct=MagickFalse;
+#if defined(MAGICKCORE_GS_DISPLAY_DELEGATE)
+  direct=IsStringTrue(GetImageOption(image_info,"pdf:direct"));
+  if (band_height != 0)
+    direct=MagickTrue;
+#else
+  if (band_height != 0)
+    (void) ThrowMagickException(exception,GetMagickModule(),
+      MissingDelegateWarning,"DelegateLibrarySupportNotBuiltIn",
+      "`%s' (pdf:band-height)",image_info->filename);
+#endif
+  lazy=IsStringTrue(GetImageOption(image_info,"pdf:lazy"));
+  if (image_info->stream != (StreamHandler) NULL)
+    {
+      /*
+        Streamed rows must arrive top-down one page at a time.  The display
+        device renders the page in bands that go straight to the stream, so
+        neither Ghostscript nor the pixel cache holds the whole page.
+        Without it the page is rendered to a PNM file on disk that is read
+        back a row at a time.
+      */
+      lazy=MagickFalse;
+#if defined(MAGICKCORE_GS_DISPLAY_DELEGATE)
+      direct=MagickTrue;
+      if (band_height == 0)
+        band_height=PDFStreamBandHeight;
+#endif
+    }
   count=0;
+  number_pages=0;
   spotcolor=0;
   (void) ResetMagickMemory(&bounding_box,0,sizeof(bounding_box));
   (void) ResetMagickMemory(&bounds,0,sizeof(bounds));
@@ -520,109 +3169,203 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
   (void) ResetMagickMemory(command,0,sizeof(command));
   angle=0.0;
   p=command;
-  for (c=ReadBlobByte(image); c != EOF; c=ReadBlobByte(image))
-  {
-    /*
-      Note PDF elements.
-    */
-    if (c == '\n')
-      c=' ';
-    *p++=(char) c;
-    if ((c != (int) '/') && (c != (int) '%') &&
-        ((size_t) (p-command) < (MagickPathExtent-1)))
-      continue;
-    *(--p)='\0';
-    p=command;
-    if (LocaleNCompare(PDFRotate,command,strlen(PDFRotate)) == 0)
-      count=(ssize_t) sscanf(command,"Rotate %lf",&angle);
-    /*
-      Is this a CMYK document?
-    */
-    if (LocaleNCompare(DefaultCMYK,command,strlen(DefaultCMYK)) == 0)
-      cmyk=MagickTrue;
-    if (LocaleNCompare(DeviceCMYK,command,strlen(DeviceCMYK)) == 0)
-      cmyk=MagickTrue;
-    if (LocaleNCompare(CMYKProcessColor,command,strlen(CMYKProcessColor)) == 0)
-      cmyk=MagickTrue;
-    if (LocaleNCompare(SpotColor,command,strlen(SpotColor)) == 0)
-      {
-        char
-          name[MagickPathExtent],
-          property[MagickPathExtent],
-          *value;
-
-        /*
-          Note spot names.
-        */
-        (void) FormatLocaleString(property,MagickPathExtent,
-          "pdf:SpotColor-%.20g",(double) spotcolor++);
-        i=0;
-        for (c=ReadBlobByte(image); c != EOF; c=ReadBlobByte(image))
+  GetTimerInfo(&timer);
+  cached=GetPDFMetadata(image_info->filename,cropbox,trimbox,image,&pdf_info,
+    exception);
+  if ((cached != MagickFalse) ||
+      (ScanPDFStructure(input_filename,cropbox,trimbox,image,&pdf_info,
+         exception) != MagickFalse))
+    {
+      /*
+        An earlier read or the cross-reference table located the page
+        objects directly.
+      */
+      angle=pdf_info.angle;
+      if (pdf_info.cmyk != MagickFalse)
+        cmyk=MagickTrue;
+      number_pages=pdf_info.number_pages;
+      if (image_info->page == (char *) NULL)
         {
-          if ((isspace(c) != 0) || (c == '/') || ((i+1) == MagickPathExtent))
-            break;
-          name[i++]=(char) c;
+          bounds=pdf_info.bounds;
+          hires_bounds=pdf_info.bounds;
         }
-        name[i]='\0';
-        value=AcquireString(name);
-        (void) SubstituteString(&value,"#20"," ");
-        (void) SetImageProperty(image,property,value,exception);
-        value=DestroyString(value);
+    }
+  else
+    for (c=ReadBlobByte(image); c != EOF; c=ReadBlobByte(image))
+    {
+      /*
+        Note PDF elements.
+      */
+      if (c == '\n')
+        c=' ';
+      *p++=(char) c;
+      if ((c != (int) '/') && (c != (int) '%') &&
+          ((size_t) (p-command) < (MagickPathExtent-1)))
         continue;
-      }
-    if (LocaleNCompare(PDFVersion,command,strlen(PDFVersion)) == 0)
-      (void) SetImageProperty(image,"pdf:Version",command,exception);
-    if (image_info->page != (char *) NULL)
-      continue;
-    count=0;
-    if (cropbox != MagickFalse)
-      {
-        if (LocaleNCompare(CropBox,command,strlen(CropBox)) == 0)
+      *(--p)='\0';
+      p=command;
+      if (LocaleNCompare(PDFRotate,command,strlen(PDFRotate)) == 0)
+        count=(ssize_t) sscanf(command,"Rotate %lf",&angle);
+      if ((LocaleNCompare(PDFPage,command,strlen(PDFPage)) == 0) &&
+          (isalnum((int) ((unsigned char) command[strlen(PDFPage)])) == 0))
+        number_pages++;
+      /*
+        Is this a CMYK document?
+      */
+      if (LocaleNCompare(DefaultCMYK,command,strlen(DefaultCMYK)) == 0)
+        cmyk=MagickTrue;
+      if (LocaleNCompare(DeviceCMYK,command,strlen(DeviceCMYK)) == 0)
+        cmyk=MagickTrue;
+      if (LocaleNCompare(CMYKProcessColor,command,
+            strlen(CMYKProcessColor)) == 0)
+        cmyk=MagickTrue;
+      if (LocaleNCompare(SpotColor,command,strlen(SpotColor)) == 0)
+        {
+          char
+            name[MagickPathExtent],
+            property[MagickPathExtent],
+            *value;
+
+          /*
+            Note spot names.
+          */
+          (void) FormatLocaleString(property,MagickPathExtent,
+            "pdf:SpotColor-%.20g",(double) spotcolor++);
+          i=0;
+          for (c=ReadBlobByte(image); c != EOF; c=ReadBlobByte(image))
           {
-            /*
-              Note region defined by crop box.
-            */
-            count=(ssize_t) sscanf(command,"CropBox [%lf %lf %lf %lf",
-              &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
-            if (count != 4)
-              count=(ssize_t) sscanf(command,"CropBox[%lf %lf %lf %lf",
-                &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
+            if ((isspace(c) != 0) || (c == '/') || ((i+1) == MagickPathExtent))
+              break;
+            name[i++]=(char) c;
           }
-      }
-    else
-      if (trimbox != MagickFalse)
+          name[i]='\0';
+          value=AcquireString(name);
+          (void) SubstituteString(&value,"#20"," ");
+          (void) SetImageProperty(image,property,value,exception);
+          value=DestroyString(value);
+          continue;
+        }
+      if (LocaleNCompare(PDFVersion,command,strlen(PDFVersion)) == 0)
+        (void) SetImageProperty(image,"pdf:Version",command,exception);
+      if (image_info->page != (char *) NULL)
+        continue;
+      count=0;
+      if (cropbox != MagickFalse)
         {
-          if (LocaleNCompare(TrimBox,command,strlen(TrimBox)) == 0)
+          if (LocaleNCompare(CropBox,command,strlen(CropBox)) == 0)
             {
               /*
-                Note region defined by trim box.
+                Note region defined by crop box.
               */
-              count=(ssize_t) sscanf(command,"TrimBox [%lf %lf %lf %lf",
+              count=(ssize_t) sscanf(command,"CropBox [%lf %lf %lf %lf",
                 &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
               if (count != 4)
-                count=(ssize_t) sscanf(command,"TrimBox[%lf %lf %lf %lf",
+                count=(ssize_t) sscanf(command,"CropBox[%lf %lf %lf %lf",
                   &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
             }
         }
       else
-        if (LocaleNCompare(MediaBox,command,strlen(MediaBox)) == 0)
+        if (trimbox != MagickFalse)
           {
-            /*
-              Note region defined by media box.
-            */
-            count=(ssize_t) sscanf(command,"MediaBox [%lf %lf %lf %lf",
-              &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
-            if (count != 4)
-              count=(ssize_t) sscanf(command,"MediaBox[%lf %lf %lf %lf",
-                &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
+            if (LocaleNCompare(TrimBox,command,strlen(TrimBox)) == 0)
+              {
+                /*
+                  Note region defined by trim box.
+                */
+                count=(ssize_t) sscanf(command,"TrimBox [%lf %lf %lf %lf",
+                  &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
+                if (count != 4)
+                  count=(ssize_t) sscanf(command,"TrimBox[%lf %lf %lf %lf",
+                    &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
+              }
           }
-    if (count != 4)
-      continue;
-    if ((fabs(bounds.x2-bounds.x1) <= fabs(hires_bounds.x2-hires_bounds.x1)) ||
-        (fabs(bounds.y2-bounds.y1) <= fabs(hires_bounds.y2-hires_bounds.y1)))
-      continue;
-    hires_bounds=bounds;
-  }
+        else
+          if (LocaleNCompare(MediaBox,command,strlen(MediaBox)) == 0)
+            {
+              /*
+                Note region defined by media box.
+              */
+              count=(ssize_t) sscanf(command,"MediaBox [%lf %lf %lf %lf",
+                &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
+              if (count != 4)
+                count=(ssize_t) sscanf(command,"MediaBox[%lf %lf %lf %lf",
+                  &bounds.x1,&bounds.y1,&bounds.x2,&bounds.y2);
+            }
+      if (count != 4)
+        continue;
+      if ((fabs(bounds.x2-bounds.x1) <=
+           fabs(hires_bounds.x2-hires_bounds.x1)) ||
+          (fabs(bounds.y2-bounds.y1) <= fabs(hires_bounds.y2-hires_bounds.y1)))
+        continue;
+      hires_bounds=bounds;
+    }
+  timing.scan=GetElapsedTime(&timer);
+  if ((cached == MagickFalse) && (image_info->page == (char *) NULL))
+    {
+      pdf_info.angle=angle;
+      pdf_info.bounds=hires_bounds;
+      pdf_info.cmyk=cmyk;
+      pdf_info.number_pages=number_pages;
+      SetPDFMetadata(image_info->filename,cropbox,trimbox,image,&pdf_info);
+    }
+  if (image_info->colorspace == CMYKColorspace)
+    cmyk=MagickTrue;
+  if (number_pages != 0)
+    {
+      char
+        pages[MagickPathExtent];
+
+      (void) FormatLocaleString(pages,MagickPathExtent,"%.20g",(double)
+        number_pages);
+      (void) SetImageProperty(image,"pdf:Pages",pages,exception);
+    }
+  option=GetImageOption(image_info,"pdf:thumbnail");
+  if ((option != (const char *) NULL) &&
+      (GetImageOption(image_info,"pdf:fit-page") == (const char *) NULL) &&
+      (fabs(hires_bounds.x2-hires_bounds.x1) >= MagickEpsilon) &&
+      (fabs(hires_bounds.y2-hires_bounds.y1) >= MagickEpsilon))
+    {
+      PointInfo
+        extent,
+        resolution;
+
+      RectangleInfo
+        thumbnail;
+
+      /*
+        Render at the resolution that fits the page to the requested size.
+      */
+      (void) ResetMagickMemory(&thumbnail,0,sizeof(thumbnail));
+      flags=GetGeometry(option,(ssize_t *) NULL,(ssize_t *) NULL,
+        &thumbnail.width,&thumbnail.height);
+      extent.x=fabs(hires_bounds.x2-hires_bounds.x1);
+      extent.y=fabs(hires_bounds.y2-hires_bounds.y1);
+      if ((fabs(angle) == 90.0) || (fabs(angle) == 270.0))
+        {
+          extent.x=fabs(hires_bounds.y2-hires_bounds.y1);
+          extent.y=fabs(hires_bounds.x2-hires_bounds.x1);
+        }
+      resolution.x=delta.x*thumbnail.width/extent.x;
+      resolution.y=delta.y*thumbnail.height/extent.y;
+      if ((flags & AspectValue) == 0)
+        {
+          if ((resolution.x < MagickEpsilon) ||
+              ((resolution.y >= MagickEpsilon) &&
+               (resolution.y < resolution.x)))
+            resolution.x=resolution.y;
+          resolution.y=resolution.x;
+        }
+      if (((flags & PercentValue) != 0) ||
+          (resolution.x < MagickEpsilon) || (resolution.y < MagickEpsilon) ||
+          (((flags & GreaterValue) != 0) &&
+           (resolution.x > image->resolution.x)) ||
+          (((flags & LessValue) != 0) && (resolution.x < image->resolution.x)))
+        resolution=image->resolution;
+      if (image->debug != MagickFalse)
+        (void) LogMagickEvent(CoderEvent,GetMagickModule(),
+          "thumbnail %s: density %gx%g",option,resolution.x,resolution.y);
+      image->resolution=resolution;
+    }
   if ((fabs(hires_bounds.x2-hires_bounds.x1) >= MagickEpsilon) &&
       (fabs(hires_bounds.y2-hires_bounds.y1) >= MagickEpsilon))
     {
@@ -672,7 +3415,8 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
       page.width=page.height;
       page.height=swap;
     }
-  if (IssRGBCompatibleColorspace(image_info->colorspace) != MagickFalse)
+  if ((IssRGBCompatibleColorspace(image_info->colorspace) != MagickFalse) ||
+      (image_info->stream != (StreamHandler) NULL))
     cmyk=MagickFalse;
   /*
     Create Ghostscript control file.
@@ -696,7 +3440,10 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
      if (cmyk != MagickFalse)
        delegate_info=GetDelegateInfo("ps:cmyk",(char *) NULL,exception);
      else
-       delegate_info=GetDelegateInfo("ps:alpha",(char *) NULL,exception);
+       if (image_info->stream != (StreamHandler) NULL)
+         delegate_info=GetDelegateInfo("ps:color",(char *) NULL,exception);
+       else
+         delegate_info=GetDelegateInfo("ps:alpha",(char *) NULL,exception);
   if (delegate_info == (const DelegateInfo *) NULL)
     {
       (void) RelinquishUniqueFileResource(postscript_filename);
@@ -721,6 +3468,8 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
       MagickPathExtent);
   if (trimbox != MagickFalse)
     (void) ConcatenateMagickString(options,"-dUseTrimBox ",MagickPathExtent);
+  if (image_info->stream != (StreamHandler) NULL)
+    (void) ConcatenateMagickString(options,"-dMaxBitmap=0 ",MagickPathExtent);
   option=GetImageOption(image_info,"authenticate");
   if (option != (char *) NULL)
     {
@@ -731,62 +3480,263 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
         "'-sPDFPassword=%s' ",option);
       (void) ConcatenateMagickString(options,passphrase,MagickPathExtent);
     }
-  read_info=CloneImageInfo(image_info);
-  *read_info->magick='\0';
-  if (read_info->number_scenes != 0)
+  (void) ResetMagickMemory(&display_info,0,sizeof(display_info));
+#if defined(MAGICKCORE_GS_DISPLAY_DELEGATE)
+  if ((direct != MagickFalse) && (image_info->monochrome == MagickFalse) &&
+      (cmyk == MagickFalse) && (image_info->stream == (StreamHandler) NULL) &&
+      (image_info->background_color.alpha_trait != UndefinedPixelTrait) &&
+      (image_info->background_color.alpha != (MagickRealType) OpaqueAlpha))
+    {
+      /*
+        A transparent background asks for the page transparency only the
+        ps:alpha file path keeps, so render to files, unbanded.  Streamed
+        pages are opaque either way.
+      */
+      direct=MagickFalse;
+      band_height=0;
+    }
+  if ((direct != MagickFalse) && (image_info->stream != (StreamHandler) NULL) &&
+      ((fitPage != MagickFalse) || (number_pages == 0) || (page.width == 0) ||
+       (page.height == 0)))
+    {
+      /*
+        Without the band geometry the display device would hold the whole
+        page, stream it from a file instead.
+      */
+      direct=MagickFalse;
+      band_height=0;
+    }
+  if (direct != MagickFalse)
     {
       char
-        pages[MagickPathExtent];
+        display[MagickPathExtent];
 
-      (void) FormatLocaleString(pages,MagickPathExtent,"-dFirstPage=%.20g "
-        "-dLastPage=%.20g",(double) read_info->scene+1,(double)
-        (read_info->scene+read_info->number_scenes));
-      (void) ConcatenateMagickString(options,pages,MagickPathExtent);
-      read_info->number_scenes=0;
-      if (read_info->scenes != (char *) NULL)
-        *read_info->scenes='\0';
+      unsigned int
+        format;
+
+      /*
+        Render through the display device into the pixel cache, no files.
+        The formats follow the delegate the file path would use: ps:mono
+        renders one bit per pixel and ps:cmyk four channels.  ps:alpha has
+        no display equivalent, since the device does not compute coverage
+        in an alpha byte, so RGB pages are rendered opaque on white.
+      */
+      format=DISPLAY_COLORS_RGB | DISPLAY_ALPHA_NONE | DISPLAY_DEPTH_8 |
+        DISPLAY_BIGENDIAN | DISPLAY_TOPFIRST;
+      if (image_info->monochrome != MagickFalse)
+        format=DISPLAY_COLORS_NATIVE | DISPLAY_ALPHA_NONE | DISPLAY_DEPTH_1 |
+          DISPLAY_BIGENDIAN | DISPLAY_TOPFIRST;
+      else
+        if (cmyk != MagickFalse)
+          format=DISPLAY_COLORS_CMYK | DISPLAY_ALPHA_NONE | DISPLAY_DEPTH_8 |
+            DISPLAY_BIGENDIAN | DISPLAY_TOPFIRST;
+      (void) FormatLocaleString(display,MagickPathExtent,
+        "-sDEVICE=display -dDisplayFormat=%u ",format);
+      (void) ConcatenateMagickString(options,display,MagickPathExtent);
+    }
+#endif
+  first_page=0;
+  last_page=0;
+  if (image_info->number_scenes != 0)
+    {
+      first_page=image_info->scene+1;
+      last_page=image_info->scene+image_info->number_scenes;
     }
-  (void) CopyMagickString(filename,read_info->filename,MagickPathExtent);
+  (void) CopyMagickString(filename,image_info->filename,MagickPathExtent);
   (void) AcquireUniqueFilename(filename);
   (void) RelinquishUniqueFileResource(filename);
-  (void) ConcatenateMagickString(filename,"%d",MagickPathExtent);
-  (void) FormatLocaleString(command,MagickPathExtent,
-    GetDelegateCommands(delegate_info),
-    read_info->antialias != MagickFalse ? 4 : 1,
-    read_info->antialias != MagickFalse ? 4 : 1,density,options,filename,
-    postscript_filename,input_filename);
-  options=DestroyString(options);
-  density=DestroyString(density);
   *message='\0';
-  status=InvokePDFDelegate(read_info->verbose,command,message,exception);
-  (void) RelinquishUniqueFileResource(postscript_filename);
-  (void) RelinquishUniqueFileResource(input_filename);
   pdf_image=(Image *) NULL;
-  if (status == MagickFalse)
-    for (i=1; ; i++)
+  if ((direct != MagickFalse) || (image_info->number_scenes != 0) ||
+      (image_info->ping != MagickFalse) || (number_pages < 2))
+    lazy=MagickFalse;
+  if (lazy != MagickFalse)
     {
-      (void) InterpretImageFilename(image_info,image,filename,(int) i,
-        read_info->filename,exception);
-      if (IsPDFRendered(read_info->filename) == MagickFalse)
-        break;
-      (void) RelinquishUniqueFileResource(read_info->filename);
+      RectangleInfo
+        *geometries;
+
+      /*
+        Defer rendering each page until its pixels are first accessed.
+      */
+      geometries=(RectangleInfo *) NULL;
+      if ((image_info->page == (char *) NULL) && (fitPage == MagickFalse))
+        geometries=GetPDFPageGeometries(input_filename,cropbox,trimbox,
+          &image->resolution,number_pages);
+      pdf_image=ReadPDFPagesOnDemand(image_info,delegate_info,density,options,
+        filename,postscript_filename,input_filename,number_pages,geometries,
+        &timing,message,exception);
+      if (geometries != (RectangleInfo *) NULL)
+        geometries=(RectangleInfo *) RelinquishMagickMemory(geometries);
+      if (pdf_image == (Image *) NULL)
+        lazy=MagickFalse;
     }
-  else
-    for (i=1; ; i++)
+  if (direct != MagickFalse)
     {
-      (void) InterpretImageFilename(image_info,image,filename,(int) i,
-        read_info->filename,exception);
-      if (IsPDFRendered(read_info->filename) == MagickFalse)
-        break;
-      read_info->blob=NULL;
-      read_info->length=0;
-      next=ReadImage(read_info,exception);
-      (void) RelinquishUniqueFileResource(read_info->filename);
-      if (next == (Image *) NULL)
-        break;
-      AppendImageToList(&pdf_image,next);
+      GetTimerInfo(&timer);
+      read_info=CloneImageInfo(image_info);
+      *read_info->magick='\0';
+      read_info->number_scenes=0;
+      if (read_info->scenes != (char *) NULL)
+        *read_info->scenes='\0';
+      (void) FormatLocaleString(command,MagickPathExtent,PDFDisplayArguments,
+        read_info->antialias != MagickFalse ? 4 : 1,
+        read_info->antialias != MagickFalse ? 4 : 1,density,options);
+      display_info.image_info=read_info;
+      display_info.resolution=image->resolution;
+      display_info.exception=exception;
+      status=MagickFalse;
+#if defined(MAGICKCORE_GS_DISPLAY_DELEGATE)
+      if ((band_height != 0) && (fitPage == MagickFalse) &&
+          (number_pages != 0) && (page.width != 0) && (page.height != 0))
+        {
+          display_info.images=RenderPDFBands(read_info,&image->resolution,
+            density,options,input_filename,page.width,page.height,band_height,
+            first_page != 0 ? first_page : 1,first_page != 0 ?
+            MagickMin(last_page,number_pages) : number_pages,message,
+            exception);
+          status=display_info.images != (Image *) NULL ? MagickTrue :
+            MagickFalse;
+        }
+      else
+        status=InvokePDFDisplay(read_info->verbose,command,(const char *) NULL,
+          first_page,last_page,input_filename,&display_info,message,exception);
+#endif
+      if ((status == MagickFalse) &&
+          (display_info.images != (Image *) NULL))
+        display_info.images=DestroyImageList(display_info.images);
+      pdf_image=display_info.images;
+      read_info=DestroyImageInfo(read_info);
+      timing.render+=GetElapsedTime(&timer);
+    }
+  if ((direct == MagickFalse) && (lazy == MagickFalse))
+    {
+      size_t
+        number_threads;
+
+      /*
+        Split the page range across workers if there is more than one page.
+      */
+      number_threads=1;
+      option=GetImageOption(image_info,"pdf:threads");
+      if (option != (const char *) NULL)
+        number_threads=StringToUnsignedLong(option);
+      number_threads=MagickMin(number_threads,(size_t)
+        GetMagickResourceLimit(ThreadResource));
+      if ((GetDelegateThreadSupport(delegate_info) == MagickFalse) ||
+          (image_info->stream != (StreamHandler) NULL))
+        number_threads=1;
+      if (first_page == 0)
+        {
+          first_page=1;
+          last_page=number_pages;
+        }
+      if (last_page > first_page)
+        number_threads=MagickMin(number_threads,last_page-first_page+1);
+      else
+        number_threads=1;
+      if (number_threads <= 1)
+        pdf_image=RenderPDFPages(image_info,image,delegate_info,density,options,
+          filename,postscript_filename,input_filename,image_info->number_scenes
+          != 0 ? first_page : 0,image_info->number_scenes != 0 ? last_page : 0,
+          &timing,message,exception);
+      else
+        {
+          char
+            **messages;
+
+          Image
+            **chunks;
+
+          size_t
+            extent;
+
+          ssize_t
+            j;
+
+          chunks=(Image **) AcquireQuantumMemory(number_threads,
+            sizeof(*chunks));
+          messages=(char **) AcquireQuantumMemory(number_threads,
+            sizeof(*messages));
+          if ((chunks == (Image **) NULL) || (messages == (char **) NULL))
+            {
+              if (chunks != (Image **) NULL)
+                chunks=(Image **) RelinquishMagickMemory(chunks);
+              if (messages != (char **) NULL)
+                messages=(char **) RelinquishMagickMemory(messages);
+              (void) RelinquishUniqueFileResource(postscript_filename);
+              (void) RelinquishUniqueFileResource(input_filename);
+              options=DestroyString(options);
+              density=DestroyString(density);
+              ThrowReaderException(ResourceLimitError,
+                "MemoryAllocationFailed");
+            }
+          extent=(last_page-first_page+number_threads)/number_threads;
+          for (j=0; j < (ssize_t) number_threads; j++)
+          {
+            chunks[j]=(Image *) NULL;
+            messages[j]=AcquireString("");
+          }
+          /*
+            The last chunk renders through to the end of the document in case
+            the page count estimate is short.
+          */
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+          #pragma omp parallel for schedule(static,1) num_threads(number_threads)
+#endif
+          for (j=0; j < (ssize_t) number_threads; j++)
+          {
+            char
+              chunk_filename[MagickPathExtent];
+
+            PDFTimingInfo
+              chunk_timing;
+
+            size_t
+              first,
+              last;
+
+            first=first_page+j*extent;
+            last=MagickMin(first+extent-1,last_page);
+            if (first > last_page)
+              continue;
+            if ((j == (ssize_t) (number_threads-1)) &&
+                (image_info->number_scenes == 0))
+              last=0;
+            (void) FormatLocaleString(chunk_filename,MagickPathExtent,
+              "%s-%.20g",filename,(double) j);
+            (void) ResetMagickMemory(&chunk_timing,0,sizeof(chunk_timing));
+            chunks[j]=RenderPDFPages(image_info,image,delegate_info,density,
+              options,chunk_filename,postscript_filename,input_filename,first,
+              last,&chunk_timing,messages[j],exception);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+            #pragma omp critical (MagickCore_ReadPDFImage)
+#endif
+            {
+              timing.startup+=chunk_timing.startup;
+              timing.render+=chunk_timing.render;
+              timing.read+=chunk_timing.read;
+            }
+          }
+          for (j=0; j < (ssize_t) number_threads; j++)
+          {
+            if (chunks[j] != (Image *) NULL)
+              AppendImageToList(&pdf_image,chunks[j]);
+            if ((*message == '\0') && (*messages[j] != '\0'))
+              (void) CopyMagickString(message,messages[j],MagickPathExtent);
+            messages[j]=DestroyString(messages[j]);
+          }
+          messages=(char **) RelinquishMagickMemory(messages);
+          chunks=(Image **) RelinquishMagickMemory(chunks);
+        }
+    }
+  (void) ConcatenateMagickString(filename,"%d",MagickPathExtent);
+  options=DestroyString(options);
+  density=DestroyString(density);
+  if (lazy == MagickFalse)
+    {
+      (void) RelinquishUniqueFileResource(postscript_filename);
+      (void) RelinquishUniqueFileResource(input_filename);
     }
-  read_info=DestroyImageInfo(read_info);
   if (pdf_image == (Image *) NULL)
     {
       if (*message != '\0')
@@ -800,7 +3750,9 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
       Image
         *cmyk_image;
 
+      GetTimerInfo(&timer);
       cmyk_image=ConsolidateCMYKImages(pdf_image,exception);
+      timing.consolidate=GetElapsedTime(&timer);
       if (cmyk_image != (Image *) NULL)
         {
           pdf_image=DestroyImageList(pdf_image);
@@ -829,6 +3781,7 @@ static Image *ReadPDFImage(const ImageInfo *image_info,ExceptionInfo *exception)
     pdf_image->page=page;
     (void) CloneImageProfiles(pdf_image,image);
     (void) CloneImageProperties(pdf_image,image);
+    SetPDFTimingArtifacts(pdf_image,&timing);
     next=SyncNextImageInList(pdf_image);
     if (next != (Image *) NULL)
       pdf_image=next;
@@ -871,6 +3824,7 @@ ModuleExport size_t RegisterPDFImage(void)
   MagickInfo
     *entry;
 
+  (void) RegisterDelegateListHandler(ListPDFMetadata);
   entry=AcquireMagickInfo("PDF","AI","Adobe Illustrator CS2");
   entry->decoder=(DecodeImageHandler *) ReadPDFImage;
   entry->encoder=(EncodeImageHandler *) WritePDFImage;
@@ -928,6 +3882,14 @@ ModuleExport void UnregisterPDFImage(void)
   (void) UnregisterMagickInfo("EPDF");
   (void) UnregisterMagickInfo("PDF");
   (void) UnregisterMagickInfo("PDFA");
+  UnregisterDelegateListHandler(ListPDFMetadata);
+  if (pdf_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&pdf_semaphore);
+  LockSemaphoreInfo(pdf_semaphore);
+  if (pdf_metadata != (LinkedListInfo *) NULL)
+    pdf_metadata=DestroyLinkedList(pdf_metadata,DestroyPDFMetadata);
+  UnlockSemaphoreInfo(pdf_semaphore);
+  RelinquishSemaphoreInfo(&pdf_semaphore);
 }
 
 /*
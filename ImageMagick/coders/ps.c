@@ -197,28 +197,7 @@ static MagickBooleanType InvokePostscriptDelegate(
   register ssize_t
     i;
 
-#if defined(MAGICKCORE_WINDOWS_SUPPORT)
-  ghost_info=NTGhostscriptDLLVectors();
-#else
-  GhostInfo
-    ghost_info_struct;
-
-  ghost_info=(&ghost_info_struct);
-  (void) ResetMagickMemory(&ghost_info_struct,0,sizeof(ghost_info_struct));
-  ghost_info_struct.delete_instance=(void (*)(gs_main_instance *))
-    gsapi_delete_instance;
-  ghost_info_struct.exit=(int (*)(gs_main_instance *)) gsapi_exit;
-  ghost_info_struct.new_instance=(int (*)(gs_main_instance **,void *))
-    gsapi_new_instance;
-  ghost_info_struct.init_with_args=(int (*)(gs_main_instance *,int,char **))
-    gsapi_init_with_args;
-  ghost_info_struct.run_string=(int (*)(gs_main_instance *,const char *,int,
-    int *)) gsapi_run_string;
-  ghost_info_struct.set_stdio=(int (*)(gs_main_instance *,int(*)(void *,char *,
-    int),int(*)(void *,const char *,int),int(*)(void *, const char *, int)))
-    gsapi_set_stdio;
-  ghost_info_struct.revision=(int (*)(gsapi_revision_t *,int)) gsapi_revision;
-#endif
+  ghost_info=GetGhostscriptInfo();
   if (ghost_info == (GhostInfo *) NULL)
     ExecuteGhostscriptCommand(command,status);
   if ((ghost_info->revision)(&revision,sizeof(revision)) != 0)
@@ -230,15 +209,20 @@ static MagickBooleanType InvokePostscriptDelegate(
       SetArgsStart(command,args_start);
       (void) fputs(args_start,stdout);
     }
+  /*
+    PostScript always runs on a one-shot interpreter: a job may change
+    interpreter state that a pooled instance would carry to the next one.
+  */
   errors=(char *) NULL;
-  status=(ghost_info->new_instance)(&interpreter,(void *) &errors);
+  status=AcquireGhostscriptInterpreter(ghost_info,&interpreter,
+    (void *) &errors);
   if (status < 0)
     ExecuteGhostscriptCommand(command,status);
   code=0;
   argv=StringToArgv(command,&argc);
   if (argv == (char **) NULL)
     {
-      (ghost_info->delete_instance)(interpreter);
+      RelinquishGhostscriptInterpreter(ghost_info,interpreter);
       return(MagickFalse);
     }
   (void) (ghost_info->set_stdio)(interpreter,(int(MagickDLLCall *)(void *,
@@ -248,7 +232,7 @@ static MagickBooleanType InvokePostscriptDelegate(
     status=(ghost_info->run_string)(interpreter,"systemdict /start get exec\n",
       0,&code);
   (ghost_info->exit)(interpreter);
-  (ghost_info->delete_instance)(interpreter);
+  RelinquishGhostscriptInterpreter(ghost_info,interpreter);
   for (i=0; i < (ssize_t) argc; i++)
     argv[i]=DestroyString(argv[i]);
   argv=(char **) RelinquishMagickMemory(argv);
@@ -0,0 +1,86 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%                      BBBB   EEEEE  N   N   CCCC  H   H                      %
+%                      B   B  E      NN  N  C      H   H                      %
+%                      BBBB   EEE    N N N  C      HHHHH                      %
+%                      B   B  E      N  NN  C      H   H                      %
+%                      BBBB   EEEEE  N   N   CCCC  H   H                      %
+%                                                                             %
+%                                                                             %
+%                     Run the ImageMagick Benchmark Harnesses                 %
+%                                                                             %
+%                                                                             %
+%  Copyright 1999-2017 ImageMagick Studio LLC, a non-profit organization      %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://www.imagemagick.org/script/license.php                           %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  The bench tool is built as its own command-line target so the harnesses
+%  stay out of the application.  The first argument selects the harness;
+%  the remaining arguments are passed to it unchanged.
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "../MagickWand/studio.h"
+#include "../MagickWand/MagickWand.h"
+#include "./bench.h"
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%  M a i n                                                                    %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  The format of the bench command is:
+%
+%      bench cache [options ...]
+%      bench check [options ...] [check ...]
+%      bench pdf [options ...] [file.pdf ...]
+%
+*/
+
+static int BenchUsage(void)
+{
+  (void) printf("Usage: bench harness [options ...]\n");
+  (void) printf("\nHarnesses:\n");
+  (void) printf("  cache                pixel cache throughput\n");
+  (void) printf("  check                fast paths against reference "
+    "results\n");
+  (void) printf("  pdf                  PDF to raster conversion pipeline\n");
+  return(1);
+}
+
+int main(int argc,char **argv)
+{
+  if (argc < 2)
+    return(BenchUsage());
+  if (LocaleCompare(argv[1],"cache") == 0)
+    return(CacheBenchMain(argc-1,argv+1));
+  if (LocaleCompare(argv[1],"check") == 0)
+    return(CheckBenchMain(argc-1,argv+1));
+  if (LocaleCompare(argv[1],"pdf") == 0)
+    return(PDFBenchMain(argc-1,argv+1));
+  return(BenchUsage());
+}
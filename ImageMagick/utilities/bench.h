@@ -0,0 +1,19 @@
+//
+//  bench.h
+//  AutoPDFKit
+//
+//  Entry points of the bench command-line tool.
+//
+
+#ifndef utilities_bench_h
+#define utilities_bench_h
+
+char *EscapeBenchString(const char *);
+
+int CacheBenchMain(int ,char **);
+int CheckBenchMain(int ,char **);
+int PDFBenchMain(int ,char **);
+
+MagickBooleanType WriteBenchPDF(const char *,const size_t,const char *);
+
+#endif /* utilities_bench_h */
@@ -0,0 +1,519 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%     CCCC    A     CCCC  H   H  EEEEE  BBBB   EEEEE  N   N   CCCC  H   H     %
+%    C       A A   C      H   H  E      B   B  E      NN  N  C      H   H     %
+%    C      AAAAA  C      HHHHH  EEE    BBBB   EEE    N N N  C      HHHHH     %
+%    C      A   A  C      H   H  E      B   B  E      N  NN  C      H   H     %
+%     CCCC  A   A   CCCC  H   H  EEEEE  BBBB   EEEEE  N   N   CCCC  H   H     %
+%                                                                             %
+%                                                                             %
+%              Benchmark Pixel Cache Throughput by Thread Count               %
+%                                                                             %
+%                                                                             %
+%  Copyright 1999-2017 ImageMagick Studio LLC, a non-profit organization      %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://www.imagemagick.org/script/license.php                           %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  Write and then read every row of an image through a cache view, once for
+%  each thread count from one up to the thread limit, and report the
+%  throughput of each pass.  By default the memory and map resources are
+%  exhausted so the image is cached on disk, which measures how well
+%  concurrent disk cache transfers scale.  With -cache distributed, a pixel
+%  cache server is started on the loopback interface and the image is cached
+%  there, so each read pass also checks the round trip through the server.
+%  Each pass is reported as one JSON object per line so results can be
+%  compared across builds.
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "../MagickWand/studio.h"
+#include "../MagickWand/MagickWand.h"
+#include "./bench.h"
+#if defined(MAGICKCORE_HAVE_FORK) && defined(MAGICKCORE_HAVE_SOCKET)
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+#endif
+
+/*
+  Define declarations.
+*/
+#define BenchCachePort  6668
+
+/*
+  Typedef declarations.
+*/
+typedef struct _BenchOptions
+{
+  const char
+    *label;
+
+  MagickBooleanType
+    disk,
+    distributed;
+
+  size_t
+    columns,
+    iterations,
+    rows,
+    threads;
+} BenchOptions;
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   B e n c h P i x e l C a c h e                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  BenchPixelCache() transfers every row of the image through the pixel cache
+%  with the given number of threads and returns the elapsed time in seconds,
+%  or a negative value if a transfer failed.  A write pass stores a
+%  deterministic pattern; a read pass fetches it back and verifies it.
+%
+%  The format of the BenchPixelCache method is:
+%
+%      double BenchPixelCache(Image *image,const size_t threads,
+%        const MagickBooleanType write,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o threads: the number of threads.
+%
+%    o write: write the pattern rather than read it.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static inline Quantum BenchPattern(const ssize_t x,const ssize_t y,
+  const ssize_t i)
+{
+  return((Quantum) (QuantumRange*((double) ((x+3*y+7*i) & 0xff)/255.0)));
+}
+
+static double BenchPixelCache(Image *image,const size_t threads,
+  const MagickBooleanType write,ExceptionInfo *exception)
+{
+  CacheView
+    *image_view;
+
+  MagickBooleanType
+    status;
+
+  ssize_t
+    y;
+
+  TimerInfo
+    timer;
+
+  status=MagickTrue;
+  image_view=AcquireAuthenticCacheView(image,exception);
+  GetTimerInfo(&timer);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static,4) shared(status) \
+    num_threads((int) threads)
+#else
+  (void) threads;
+#endif
+  for (y=0; y < (ssize_t) image->rows; y++)
+  {
+    register ssize_t
+      i,
+      x;
+
+    size_t
+      number_channels;
+
+    if (status == MagickFalse)
+      continue;
+    number_channels=GetPixelChannels(image);
+    if (write != MagickFalse)
+      {
+        register Quantum
+          *magick_restrict q;
+
+        q=GetCacheViewAuthenticPixels(image_view,0,y,image->columns,1,
+          exception);
+        if (q == (Quantum *) NULL)
+          {
+            status=MagickFalse;
+            continue;
+          }
+        for (x=0; x < (ssize_t) image->columns; x++)
+        {
+          for (i=0; i < (ssize_t) number_channels; i++)
+            q[i]=BenchPattern(x,y,i);
+          q+=number_channels;
+        }
+        if (SyncCacheViewAuthenticPixels(image_view,exception) == MagickFalse)
+          status=MagickFalse;
+      }
+    else
+      {
+        register const Quantum
+          *magick_restrict p;
+
+        p=GetCacheViewVirtualPixels(image_view,0,y,image->columns,1,
+          exception);
+        if (p == (const Quantum *) NULL)
+          {
+            status=MagickFalse;
+            continue;
+          }
+        for (x=0; x < (ssize_t) image->columns; x++)
+        {
+          for (i=0; i < (ssize_t) number_channels; i++)
+            if (p[i] != BenchPattern(x,y,i))
+              status=MagickFalse;
+          p+=number_channels;
+        }
+      }
+  }
+  image_view=DestroyCacheView(image_view);
+  if (status == MagickFalse)
+    return(-1.0);
+  return(GetElapsedTime(&timer));
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   S t a r t B e n c h C a c h e S e r v e r                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  StartBenchCacheServer() forks a distributed pixel cache server on the
+%  loopback interface and waits until it accepts connections.  It returns the
+%  process id of the server, or -1 if it could not be started.  The server
+%  runs in its own process so that the resource limits the bench sets to
+%  force a distributed cache do not apply to it.
+%
+%  The format of the StartBenchCacheServer method is:
+%
+%      ssize_t StartBenchCacheServer(const int port)
+%
+%  A description of each parameter follows:
+%
+%    o port: the port.
+%
+*/
+static ssize_t StartBenchCacheServer(const int port)
+{
+#if defined(MAGICKCORE_HAVE_FORK) && defined(MAGICKCORE_HAVE_SOCKET)
+  pid_t
+    pid;
+
+  register ssize_t
+    i;
+
+  pid=fork();
+  if (pid == -1)
+    return(-1);
+  if (pid == 0)
+    {
+      ExceptionInfo
+        *exception;
+
+      exception=AcquireExceptionInfo();
+      DistributePixelCacheServer(port,exception);
+      _exit(1);
+    }
+  for (i=0; i < 100; i++)
+  {
+    int
+      file,
+      status;
+
+    struct sockaddr_in
+      address;
+
+    (void) ResetMagickMemory(&address,0,sizeof(address));
+    address.sin_family=AF_INET;
+    address.sin_port=htons((unsigned short) port);
+    address.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+    file=socket(AF_INET,SOCK_STREAM,0);
+    if (file == -1)
+      break;
+    status=connect(file,(struct sockaddr *) &address,sizeof(address));
+    (void) close(file);
+    if (status == 0)
+      return((ssize_t) pid);
+    MagickDelay(50);
+  }
+  (void) kill(pid,SIGKILL);
+  (void) waitpid(pid,(int *) NULL,0);
+  return(-1);
+#else
+  (void) port;
+  return(-1);
+#endif
+}
+
+static void StopBenchCacheServer(const ssize_t pid)
+{
+#if defined(MAGICKCORE_HAVE_FORK) && defined(MAGICKCORE_HAVE_SOCKET)
+  (void) kill((pid_t) pid,SIGKILL);
+  (void) waitpid((pid_t) pid,(int *) NULL,0);
+#else
+  (void) pid;
+#endif
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%  C a c h e B e n c h M a i n                                                %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CacheBenchMain() runs the benchmark:
+%
+%      cachebench [-cache disk|distributed|any] [-iterations n] [-label text]
+%        [-size geometry] [-threads n]
+%
+*/
+
+static int CacheBenchUsage(void)
+{
+  (void) printf("Usage: cachebench [options ...]\n");
+  (void) printf("\nOptions:\n");
+  (void) printf("  -cache type          disk (default), distributed, or any\n");
+  (void) printf("  -iterations value    passes per thread count (default 3)\n");
+  (void) printf("  -label text          tag each result, e.g. with a commit "
+    "id\n");
+  (void) printf("  -size geometry       image size (default 8192x8192)\n");
+  (void) printf("  -threads value       maximum number of threads\n");
+  return(1);
+}
+
+int CacheBenchMain(int argc,char **argv)
+{
+  BenchOptions
+    options;
+
+  char
+    *label;
+
+  double
+    baseline[2];
+
+  ExceptionInfo
+    *exception;
+
+  Image
+    *image;
+
+  ImageInfo
+    *image_info;
+
+  int
+    exit_code;
+
+  register ssize_t
+    i;
+
+  size_t
+    threads;
+
+  ssize_t
+    server;
+
+  MagickCoreGenesis(*argv,MagickTrue);
+  exception=AcquireExceptionInfo();
+  (void) ResetMagickMemory(&options,0,sizeof(options));
+  options.label="";
+  options.disk=MagickTrue;
+  options.columns=8192;
+  options.rows=8192;
+  options.iterations=3;
+  options.threads=(size_t) GetMagickResourceLimit(ThreadResource);
+  exit_code=0;
+  for (i=1; i < (ssize_t) argc; i++)
+  {
+    const char
+      *option;
+
+    option=argv[i];
+    if ((*option != '-') || (i == (ssize_t) (argc-1)))
+      {
+        exit_code=CacheBenchUsage();
+        break;
+      }
+    if (LocaleCompare("-cache",option) == 0)
+      {
+        i++;
+        options.disk=LocaleCompare(argv[i],"any") == 0 ? MagickFalse :
+          MagickTrue;
+        options.distributed=LocaleCompare(argv[i],"distributed") == 0 ?
+          MagickTrue : MagickFalse;
+        continue;
+      }
+    if (LocaleCompare("-iterations",option) == 0)
+      {
+        options.iterations=(size_t) strtoul(argv[++i],(char **) NULL,10);
+        continue;
+      }
+    if (LocaleCompare("-label",option) == 0)
+      {
+        options.label=argv[++i];
+        continue;
+      }
+    if (LocaleCompare("-size",option) == 0)
+      {
+        RectangleInfo
+          geometry;
+
+        (void) ResetMagickMemory(&geometry,0,sizeof(geometry));
+        (void) ParseAbsoluteGeometry(argv[++i],&geometry);
+        if ((geometry.width == 0) || (geometry.height == 0))
+          {
+            exit_code=CacheBenchUsage();
+            break;
+          }
+        options.columns=geometry.width;
+        options.rows=geometry.height;
+        continue;
+      }
+    if (LocaleCompare("-threads",option) == 0)
+      {
+        options.threads=(size_t) strtoul(argv[++i],(char **) NULL,10);
+        continue;
+      }
+    exit_code=CacheBenchUsage();
+    break;
+  }
+#if !defined(MAGICKCORE_OPENMP_SUPPORT)
+  options.threads=1;
+#endif
+  if (options.threads == 0)
+    options.threads=1;
+  if (exit_code != 0)
+    {
+      exception=DestroyExceptionInfo(exception);
+      MagickCoreTerminus();
+      return(exit_code);
+    }
+  server=(-1);
+  if (options.distributed != MagickFalse)
+    {
+      /*
+        Cache the image on a loopback server: no memory, map, or disk left.
+      */
+      server=StartBenchCacheServer(BenchCachePort);
+      if (server == -1)
+        {
+          (void) fprintf(stderr,"cachebench: unable to start the pixel cache "
+            "server on port %d\n",BenchCachePort);
+          exception=DestroyExceptionInfo(exception);
+          MagickCoreTerminus();
+          return(1);
+        }
+      (void) SetMagickResourceLimit(DiskResource,0);
+    }
+  if (options.disk != MagickFalse)
+    {
+      (void) SetMagickResourceLimit(MemoryResource,0);
+      (void) SetMagickResourceLimit(MapResource,0);
+    }
+  image_info=AcquireImageInfo();
+  image=AcquireImage(image_info,exception);
+  if ((image == (Image *) NULL) ||
+      (SetImageExtent(image,options.columns,options.rows,exception) ==
+       MagickFalse))
+    {
+      CatchException(exception);
+      if (image != (Image *) NULL)
+        image=DestroyImage(image);
+      image_info=DestroyImageInfo(image_info);
+      exception=DestroyExceptionInfo(exception);
+      if (server != -1)
+        StopBenchCacheServer(server);
+      MagickCoreTerminus();
+      return(1);
+    }
+  label=EscapeBenchString(options.label);
+  baseline[0]=0.0;
+  baseline[1]=0.0;
+  for (threads=1; exit_code == 0; threads<<=1)
+  {
+    if (threads > options.threads)
+      threads=options.threads;
+    for (i=0; i < (ssize_t) (2*options.iterations); i++)
+    {
+      double
+        elapsed,
+        megabytes;
+
+      MagickBooleanType
+        write;
+
+      write=(i % 2) == 0 ? MagickTrue : MagickFalse;
+      elapsed=BenchPixelCache(image,threads,write,exception);
+      if (elapsed < 0.0)
+        {
+          CatchException(exception);
+          exit_code=1;
+          break;
+        }
+      megabytes=(double) options.columns*options.rows*GetPixelChannels(image)*
+        sizeof(Quantum)/1.0e6;
+      if ((threads == 1) && (baseline[i % 2] == 0.0))
+        baseline[i % 2]=elapsed;
+      (void) fprintf(stdout,"{\"label\": \"%s\", \"cache\": \"%s\", "
+        "\"columns\": %.20g, \"rows\": %.20g, \"threads\": %.20g, "
+        "\"operation\": \"%s\", \"iteration\": %.20g, \"elapsed\": %.6f, "
+        "\"megabytes-per-second\": %.6f, \"speedup\": %.6f}\n",label,
+        CommandOptionToMnemonic(MagickCacheOptions,(ssize_t)
+        GetImagePixelCacheType(image)),(double) options.columns,
+        (double) options.rows,(double) threads,write != MagickFalse ?
+        "write" : "read",(double) (i/2),elapsed,elapsed > 0.0 ? megabytes/
+        elapsed : 0.0,elapsed > 0.0 ? baseline[i % 2]/elapsed : 0.0);
+      (void) fflush(stdout);
+    }
+    if (threads == options.threads)
+      break;
+  }
+  label=DestroyString(label);
+  image=DestroyImage(image);
+  image_info=DestroyImageInfo(image_info);
+  exception=DestroyExceptionInfo(exception);
+  if (server != -1)
+    StopBenchCacheServer(server);
+  MagickCoreTerminus();
+  return(exit_code);
+}
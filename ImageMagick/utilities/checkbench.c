@@ -0,0 +1,1436 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%     CCCC  H   H  EEEEE   CCCC  K   K  BBBB   EEEEE  N   N   CCCC  H   H     %
+%    C      H   H  E      C      K  K   B   B  E      NN  N  C      H   H     %
+%    C      HHHHH  EEE    C      KKK    BBBB   EEE    N N N  C      HHHHH     %
+%    C      H   H  E      C      K  K   B   B  E      N  NN  C      H   H     %
+%     CCCC  H   H  EEEEE   CCCC  K   K  BBBB   EEEEE  N   N   CCCC  H   H     %
+%                                                                             %
+%                                                                             %
+%          Check the Benchmarked Fast Paths Against Reference Results         %
+%                                                                             %
+%                                                                             %
+%  Copyright 1999-2017 ImageMagick Studio LLC, a non-profit organization      %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://www.imagemagick.org/script/license.php                           %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  The benchmarks measure how fast a path is; these checks confirm it still
+%  produces the same result as the path it replaces.  Each check renders or
+%  processes a small deterministic input twice, once through the fast path
+%  and once through a reference, and compares the results.  Each check is
+%  reported as one JSON object per line and the exit status is non-zero if
+%  any check fails, so the checks can gate a build.
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "../MagickWand/studio.h"
+#include "../MagickWand/MagickWand.h"
+#include "./bench.h"
+
+/*
+  Typedef declarations.
+*/
+typedef MagickBooleanType
+  (*CheckMethod)(char *,ExceptionInfo *);
+
+typedef double
+  (*CheckReduction)(double *,const size_t);
+
+typedef struct _CheckInfo
+{
+  const char
+    *name;
+
+  CheckMethod
+    method;
+} CheckInfo;
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   A c q u i r e C h e c k I m a g e                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  AcquireCheckImage() returns an RGB image filled with deterministic noise,
+%  one of 256 levels per channel, so every run checks the same pixels.
+%
+%  The format of the AcquireCheckImage method is:
+%
+%      Image *AcquireCheckImage(const size_t columns,const size_t rows,
+%        const unsigned int seed,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o columns, rows: the image size.
+%
+%    o seed: the noise seed.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static inline Quantum CheckNoise(unsigned int *seed)
+{
+  *seed=1103515245U*(*seed)+12345U;
+  return((Quantum) (QuantumRange*((*seed >> 16) & 0xff)/255.0));
+}
+
+static Image *AcquireCheckImage(const size_t columns,const size_t rows,
+  const unsigned int seed,ExceptionInfo *exception)
+{
+  Image
+    *image;
+
+  ImageInfo
+    *image_info;
+
+  MagickBooleanType
+    status;
+
+  ssize_t
+    y;
+
+  unsigned int
+    state;
+
+  image_info=AcquireImageInfo();
+  image=AcquireImage(image_info,exception);
+  image_info=DestroyImageInfo(image_info);
+  status=SetImageExtent(image,columns,rows,exception);
+  state=seed;
+  for (y=0; (status != MagickFalse) && (y < (ssize_t) image->rows); y++)
+  {
+    register Quantum
+      *q;
+
+    register ssize_t
+      x;
+
+    q=QueueAuthenticPixels(image,0,y,image->columns,1,exception);
+    if (q == (Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    for (x=0; x < (ssize_t) image->columns; x++)
+    {
+      SetPixelRed(image,CheckNoise(&state),q);
+      SetPixelGreen(image,CheckNoise(&state),q);
+      SetPixelBlue(image,CheckNoise(&state),q);
+      q+=GetPixelChannels(image);
+    }
+    status=SyncAuthenticPixels(image,exception);
+  }
+  if (status == MagickFalse)
+    image=DestroyImage(image);
+  return(image);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C o m p a r e C h e c k I m a g e s                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CompareCheckImages() compares two image lists frame by frame and returns
+%  the largest absolute difference of any channel of any pixel, or a negative
+%  value if the lists differ in length, geometry, or channels.
+%
+%  The format of the CompareCheckImages method is:
+%
+%      double CompareCheckImages(const Image *images,const Image *reference,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o images: the image list.
+%
+%    o reference: the reference image list.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static double CompareCheckImages(const Image *images,const Image *reference,
+  ExceptionInfo *exception)
+{
+  const Image
+    *p,
+    *q;
+
+  double
+    distortion;
+
+  distortion=0.0;
+  p=images;
+  q=reference;
+  while ((p != (const Image *) NULL) && (q != (const Image *) NULL))
+  {
+    CacheView
+      *image_view,
+      *reference_view;
+
+    ssize_t
+      y;
+
+    if ((p->columns != q->columns) || (p->rows != q->rows) ||
+        (GetPixelChannels(p) != GetPixelChannels(q)))
+      return(-1.0);
+    image_view=AcquireVirtualCacheView(p,exception);
+    reference_view=AcquireVirtualCacheView(q,exception);
+    for (y=0; y < (ssize_t) p->rows; y++)
+    {
+      register const Quantum
+        *magick_restrict r,
+        *magick_restrict s;
+
+      register ssize_t
+        i;
+
+      r=GetCacheViewVirtualPixels(image_view,0,y,p->columns,1,exception);
+      s=GetCacheViewVirtualPixels(reference_view,0,y,q->columns,1,exception);
+      if ((r == (const Quantum *) NULL) || (s == (const Quantum *) NULL))
+        {
+          distortion=(-1.0);
+          break;
+        }
+      for (i=0; i < (ssize_t) (p->columns*GetPixelChannels(p)); i++)
+        if (fabs((double) r[i]-(double) s[i]) > distortion)
+          distortion=fabs((double) r[i]-(double) s[i]);
+    }
+    reference_view=DestroyCacheView(reference_view);
+    image_view=DestroyCacheView(image_view);
+    if (distortion < 0.0)
+      return(distortion);
+    p=GetNextImageInList(p);
+    q=GetNextImageInList(q);
+  }
+  if ((p != (const Image *) NULL) || (q != (const Image *) NULL))
+    return(-1.0);
+  return(distortion);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e a d C h e c k I m a g e                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReadCheckImage() reads an image with an optional density and define.
+%
+%  The format of the ReadCheckImage method is:
+%
+%      Image *ReadCheckImage(const char *filename,const char *density,
+%        const char *key,const char *value,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o filename: the image filename.
+%
+%    o density: the render resolution, or NULL for the default.
+%
+%    o key,value: define this coder option, or NULL for none.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static Image *ReadCheckImage(const char *filename,const char *density,
+  const char *key,const char *value,ExceptionInfo *exception)
+{
+  Image
+    *image;
+
+  ImageInfo
+    *image_info;
+
+  image_info=AcquireImageInfo();
+  (void) CopyMagickString(image_info->filename,filename,MagickPathExtent);
+  if (density != (const char *) NULL)
+    (void) CloneString(&image_info->density,density);
+  if (key != (const char *) NULL)
+    (void) SetImageOption(image_info,key,value);
+  image=ReadImage(image_info,exception);
+  image_info=DestroyImageInfo(image_info);
+  return(image);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e d u c e C h e c k I m a g e                                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ReduceCheckImage() is the brute-force reference for the neighborhood
+%  operators: each sample of the result is the given reduction of the
+%  samples under the set elements of the kernel, with coordinates beyond the
+%  image clamped to its edge.  The kernel must be symmetric about its origin,
+%  so it reads the same whether or not the operator reflects it.
+%
+%  The format of the ReduceCheckImage method is:
+%
+%      Image *ReduceCheckImage(const Image *image,const KernelInfo *kernel,
+%        const CheckReduction reduce,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o image: the image.
+%
+%    o kernel: the neighborhood; elements above 0.5 are set.
+%
+%    o reduce: reduce the neighborhood samples to one.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static double MaximumCheckReduction(double *samples,const size_t number_samples)
+{
+  double
+    maximum;
+
+  register ssize_t
+    i;
+
+  maximum=samples[0];
+  for (i=1; i < (ssize_t) number_samples; i++)
+    if (samples[i] > maximum)
+      maximum=samples[i];
+  return(maximum);
+}
+
+static double MinimumCheckReduction(double *samples,const size_t number_samples)
+{
+  double
+    minimum;
+
+  register ssize_t
+    i;
+
+  minimum=samples[0];
+  for (i=1; i < (ssize_t) number_samples; i++)
+    if (samples[i] < minimum)
+      minimum=samples[i];
+  return(minimum);
+}
+
+static int CompareCheckSamples(const void *x,const void *y)
+{
+  const double
+    *p,
+    *q;
+
+  p=(const double *) x;
+  q=(const double *) y;
+  if (*p < *q)
+    return(-1);
+  if (*p > *q)
+    return(1);
+  return(0);
+}
+
+static double MedianCheckReduction(double *samples,const size_t number_samples)
+{
+  qsort((void *) samples,number_samples,sizeof(*samples),CompareCheckSamples);
+  return(samples[number_samples/2]);
+}
+
+static Image *ReduceCheckImage(const Image *image,const KernelInfo *kernel,
+  const CheckReduction reduce,ExceptionInfo *exception)
+{
+  double
+    *samples;
+
+  Image
+    *reduce_image;
+
+  MagickBooleanType
+    status;
+
+  register const Quantum
+    *pixels;
+
+  size_t
+    channels;
+
+  ssize_t
+    y;
+
+  reduce_image=CloneImage(image,image->columns,image->rows,MagickTrue,
+    exception);
+  if (reduce_image == (Image *) NULL)
+    return((Image *) NULL);
+  samples=(double *) AcquireQuantumMemory(kernel->width*kernel->height,
+    sizeof(*samples));
+  pixels=GetVirtualPixels(image,0,0,image->columns,image->rows,exception);
+  if ((samples == (double *) NULL) || (pixels == (const Quantum *) NULL))
+    {
+      if (samples != (double *) NULL)
+        samples=(double *) RelinquishMagickMemory(samples);
+      return(DestroyImage(reduce_image));
+    }
+  channels=GetPixelChannels(image);
+  status=MagickTrue;
+  for (y=0; y < (ssize_t) image->rows; y++)
+  {
+    register Quantum
+      *q;
+
+    register ssize_t
+      x;
+
+    q=QueueAuthenticPixels(reduce_image,0,y,reduce_image->columns,1,
+      exception);
+    if (q == (Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    for (x=0; x < (ssize_t) image->columns; x++)
+    {
+      register ssize_t
+        i;
+
+      for (i=0; i < (ssize_t) channels; i++)
+      {
+        size_t
+          n;
+
+        ssize_t
+          u,
+          v;
+
+        n=0;
+        for (v=0; v < (ssize_t) kernel->height; v++)
+          for (u=0; u < (ssize_t) kernel->width; u++)
+          {
+            ssize_t
+              s,
+              t;
+
+            if (!(kernel->values[v*(ssize_t) kernel->width+u] > 0.5))
+              continue;
+            s=x+u-kernel->x;
+            s=s < 0 ? 0 : s >= (ssize_t) image->columns ?
+              (ssize_t) image->columns-1 : s;
+            t=y+v-kernel->y;
+            t=t < 0 ? 0 : t >= (ssize_t) image->rows ?
+              (ssize_t) image->rows-1 : t;
+            samples[n++]=(double) pixels[(t*(ssize_t) image->columns+s)*
+              (ssize_t) channels+i];
+          }
+        q[i]=(Quantum) reduce(samples,n);
+      }
+      q+=channels;
+    }
+    if (SyncAuthenticPixels(reduce_image,exception) == MagickFalse)
+      {
+        status=MagickFalse;
+        break;
+      }
+  }
+  samples=(double *) RelinquishMagickMemory(samples);
+  if (status == MagickFalse)
+    reduce_image=DestroyImage(reduce_image);
+  return(reduce_image);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   W r i t e C h e c k P D F                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  WriteCheckPDF() writes a document of small noise images through the PDF
+%  encoder, one image per page, so the checks also read what ImageMagick
+%  itself writes and not only the hand-built bench documents.
+%
+%  The format of the WriteCheckPDF method is:
+%
+%      MagickBooleanType WriteCheckPDF(const size_t pages,const char *path,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o pages: the number of pages.
+%
+%    o path: write the document to this file.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType WriteCheckPDF(const size_t pages,const char *path,
+  ExceptionInfo *exception)
+{
+  Image
+    *images;
+
+  ImageInfo
+    *image_info;
+
+  MagickBooleanType
+    status;
+
+  register ssize_t
+    i;
+
+  images=NewImageList();
+  for (i=0; i < (ssize_t) pages; i++)
+  {
+    Image
+      *image;
+
+    image=AcquireCheckImage(64,48,(unsigned int) i+1,exception);
+    if (image == (Image *) NULL)
+      {
+        images=DestroyImageList(images);
+        return(MagickFalse);
+      }
+    AppendImageToList(&images,image);
+  }
+  image_info=AcquireImageInfo();
+  (void) FormatLocaleString(images->filename,MagickPathExtent,"pdf:%s",path);
+  status=WriteImages(image_info,images,images->filename,exception);
+  image_info=DestroyImageInfo(image_info);
+  images=DestroyImageList(images);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C h e c k M o r p h o l o g y                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CheckMorphology() dilates and erodes a noise image with a 7x5 rectangle
+%  and checks the results against the brute-force maximum and minimum.  The
+%  image is made wide enough that the flat kernel path works in several
+%  bands of 64 rows, so the band seams are checked too.
+%
+%  The format of the CheckMorphology method is:
+%
+%      MagickBooleanType CheckMorphology(char *detail,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o detail: describe the result here.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType CheckMorphology(char *detail,
+  ExceptionInfo *exception)
+{
+  static const CheckReduction
+    Reductions[] = { MaximumCheckReduction, MinimumCheckReduction };
+
+  static const MorphologyMethod
+    Methods[] = { DilateMorphology, ErodeMorphology };
+
+  Image
+    *image;
+
+  KernelInfo
+    *kernel;
+
+  MagickBooleanType
+    status;
+
+  register ssize_t
+    i;
+
+  /*
+    A band holds about 16 MiB of samples, and never fewer than 64 rows.
+  */
+  image=AcquireCheckImage(16777216/(3*64*sizeof(Quantum)),136,24,exception);
+  if (image == (Image *) NULL)
+    return(MagickFalse);
+  (void) SetImageVirtualPixelMethod(image,EdgeVirtualPixelMethod,exception);
+  kernel=AcquireKernelInfo("Rectangle:7x5",exception);
+  if (kernel == (KernelInfo *) NULL)
+    {
+      image=DestroyImage(image);
+      return(MagickFalse);
+    }
+  status=MagickTrue;
+  for (i=0; i < (ssize_t) (sizeof(Methods)/sizeof(*Methods)); i++)
+  {
+    char
+      result[MagickPathExtent];
+
+    double
+      distortion;
+
+    Image
+      *morphology_image,
+      *reference;
+
+    morphology_image=MorphologyImage(image,Methods[i],1,kernel,exception);
+    reference=ReduceCheckImage(image,kernel,Reductions[i],exception);
+    distortion=(-1.0);
+    if ((morphology_image != (Image *) NULL) &&
+        (reference != (Image *) NULL))
+      distortion=CompareCheckImages(morphology_image,reference,exception);
+    if (distortion != 0.0)
+      status=MagickFalse;
+    (void) FormatLocaleString(result,MagickPathExtent,"%s%s %.20gx%.20g "
+      "by a 7x5 rectangle: maximum difference %g",i == 0 ? "" : "; ",
+      CommandOptionToMnemonic(MagickMorphologyOptions,(ssize_t) Methods[i]),
+      (double) image->columns,(double) image->rows,distortion);
+    (void) ConcatenateMagickString(detail,result,MagickPathExtent);
+    if (reference != (Image *) NULL)
+      reference=DestroyImage(reference);
+    if (morphology_image != (Image *) NULL)
+      morphology_image=DestroyImage(morphology_image);
+  }
+  kernel=DestroyKernelInfo(kernel);
+  image=DestroyImage(image);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C h e c k P D F B a n d s                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CheckPDFBands() renders the first page of a generated vector document at
+%  150 DPI in bands of 64 rows and again in one piece, and checks that the
+%  pages are identical.
+%
+%  The format of the CheckPDFBands method is:
+%
+%      MagickBooleanType CheckPDFBands(char *detail,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o detail: describe the result here.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType CheckPDFBands(char *detail,ExceptionInfo *exception)
+{
+  char
+    filename[MagickPathExtent],
+    path[MagickPathExtent];
+
+  double
+    distortion;
+
+  Image
+    *image,
+    *reference;
+
+  MagickBooleanType
+    banded;
+
+  (void) AcquireUniqueFilename(path);
+  if (WriteBenchPDF("vector",1,path) == MagickFalse)
+    {
+      (void) FormatLocaleString(detail,MagickPathExtent,
+        "unable to write `%s'",path);
+      (void) RelinquishUniqueFileResource(path);
+      return(MagickFalse);
+    }
+  (void) FormatLocaleString(filename,MagickPathExtent,"pdf:%s[0]",path);
+  reference=ReadCheckImage(filename,"150",(const char *) NULL,
+    (const char *) NULL,exception);
+  image=ReadCheckImage(filename,"150","pdf:band-height","64",exception);
+  banded=exception->severity == MissingDelegateWarning ? MagickFalse :
+    MagickTrue;
+  (void) RelinquishUniqueFileResource(path);
+  distortion=(-1.0);
+  if ((image != (Image *) NULL) && (reference != (Image *) NULL))
+    distortion=CompareCheckImages(image,reference,exception);
+  (void) FormatLocaleString(detail,MagickPathExtent,"%.20gx%.20g page in "
+    "64 row bands, maximum difference %g",reference != (Image *) NULL ?
+    (double) reference->columns : 0.0,reference != (Image *) NULL ?
+    (double) reference->rows : 0.0,distortion);
+  if (banded == MagickFalse)
+    (void) ConcatenateMagickString(detail," (no display device: both reads "
+      "unbanded)",MagickPathExtent);
+  if (image != (Image *) NULL)
+    image=DestroyImageList(image);
+  if (reference != (Image *) NULL)
+    reference=DestroyImageList(reference);
+  return(distortion == 0.0 ? MagickTrue : MagickFalse);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C h e c k P D F C a c h e                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CheckPDFCache() reads a document twice, so the second read is served from
+%  the metadata cache, then overwrites it in place with a different number of
+%  pages and reads it again.  The page count and the rendered frames must
+%  follow the file, not the cache.
+%
+%  The format of the CheckPDFCache method is:
+%
+%      MagickBooleanType CheckPDFCache(char *detail,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o detail: describe the result here.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType CheckPDFCache(char *detail,ExceptionInfo *exception)
+{
+  static const size_t
+    Pages[] = { 4, 4, 2 };
+
+  char
+    filename[MagickPathExtent],
+    path[MagickPathExtent];
+
+  MagickBooleanType
+    status;
+
+  register ssize_t
+    i;
+
+  (void) AcquireUniqueFilename(path);
+  (void) FormatLocaleString(filename,MagickPathExtent,"pdf:%s",path);
+  status=MagickTrue;
+  for (i=0; i < (ssize_t) (sizeof(Pages)/sizeof(*Pages)); i++)
+  {
+    char
+      result[MagickPathExtent];
+
+    const char
+      *value;
+
+    Image
+      *images;
+
+    size_t
+      frames,
+      pages;
+
+    if (((i == 0) || (Pages[i] != Pages[i-1])) &&
+        (WriteBenchPDF("pages",Pages[i],path) == MagickFalse))
+      {
+        (void) FormatLocaleString(detail,MagickPathExtent,
+          "unable to write `%s'",path);
+        status=MagickFalse;
+        break;
+      }
+    images=ReadCheckImage(filename,"18",(const char *) NULL,
+      (const char *) NULL,exception);
+    frames=GetImageListLength(images);
+    pages=0;
+    if (images != (Image *) NULL)
+      {
+        value=GetImageProperty(images,"pdf:Pages",exception);
+        if (value != (const char *) NULL)
+          pages=(size_t) strtoul(value,(char **) NULL,10);
+        images=DestroyImageList(images);
+      }
+    if ((pages != Pages[i]) || (frames != Pages[i]))
+      status=MagickFalse;
+    (void) FormatLocaleString(result,MagickPathExtent,"%sread %.20g of %.20g "
+      "pages: scanner %.20g, Ghostscript %.20g",i == 0 ? "" : "; ",(double)
+      i+1,(double) Pages[i],(double) pages,(double) frames);
+    (void) ConcatenateMagickString(detail,result,MagickPathExtent);
+  }
+  (void) RelinquishUniqueFileResource(path);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C h e c k P D F P a g e s                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CheckPDFPages() checks the page count the structure scanner reports in the
+%  pdf:Pages property against the number of pages Ghostscript renders, for a
+%  generated document and for one written by the PDF encoder.
+%
+%  The format of the CheckPDFPages method is:
+%
+%      MagickBooleanType CheckPDFPages(char *detail,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o detail: describe the result here.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType CheckPDFPages(char *detail,ExceptionInfo *exception)
+{
+  static const char
+    *Documents[] = { "generated", "encoded" };
+
+  static const size_t
+    Pages[] = { 5, 3 };
+
+  MagickBooleanType
+    status;
+
+  register ssize_t
+    i;
+
+  status=MagickTrue;
+  for (i=0; i < (ssize_t) (sizeof(Pages)/sizeof(*Pages)); i++)
+  {
+    char
+      filename[MagickPathExtent],
+      path[MagickPathExtent],
+      result[MagickPathExtent];
+
+    const char
+      *value;
+
+    Image
+      *images;
+
+    MagickBooleanType
+      written;
+
+    size_t
+      frames,
+      pages;
+
+    (void) AcquireUniqueFilename(path);
+    if (i == 0)
+      written=WriteBenchPDF("pages",Pages[i],path);
+    else
+      written=WriteCheckPDF(Pages[i],path,exception);
+    images=(Image *) NULL;
+    if (written != MagickFalse)
+      {
+        (void) FormatLocaleString(filename,MagickPathExtent,"pdf:%s",path);
+        images=ReadCheckImage(filename,"18",(const char *) NULL,
+          (const char *) NULL,exception);
+      }
+    (void) RelinquishUniqueFileResource(path);
+    frames=GetImageListLength(images);
+    pages=0;
+    if (images != (Image *) NULL)
+      {
+        value=GetImageProperty(images,"pdf:Pages",exception);
+        if (value != (const char *) NULL)
+          pages=(size_t) strtoul(value,(char **) NULL,10);
+        images=DestroyImageList(images);
+      }
+    if ((pages != Pages[i]) || (frames != Pages[i]))
+      status=MagickFalse;
+    (void) FormatLocaleString(result,MagickPathExtent,"%s%s: %.20g pages, "
+      "scanner %.20g, Ghostscript %.20g",i == 0 ? "" : "; ",Documents[i],
+      (double) Pages[i],(double) pages,(double) frames);
+    (void) ConcatenateMagickString(detail,result,MagickPathExtent);
+  }
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C h e c k P D F T h r e a d s                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CheckPDFThreads() renders a generated many-page document with the page
+%  range split across three Ghostscript workers and again with one, and
+%  checks that every page is identical.
+%
+%  The format of the CheckPDFThreads method is:
+%
+%      MagickBooleanType CheckPDFThreads(char *detail,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o detail: describe the result here.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType CheckPDFThreads(char *detail,
+  ExceptionInfo *exception)
+{
+  char
+    filename[MagickPathExtent],
+    path[MagickPathExtent];
+
+  double
+    distortion;
+
+  Image
+    *images,
+    *reference;
+
+  MagickSizeType
+    workers;
+
+  (void) AcquireUniqueFilename(path);
+  if (WriteBenchPDF("pages",7,path) == MagickFalse)
+    {
+      (void) FormatLocaleString(detail,MagickPathExtent,
+        "unable to write `%s'",path);
+      (void) RelinquishUniqueFileResource(path);
+      return(MagickFalse);
+    }
+  (void) FormatLocaleString(filename,MagickPathExtent,"pdf:%s",path);
+  reference=ReadCheckImage(filename,"36","pdf:threads","1",exception);
+  images=ReadCheckImage(filename,"36","pdf:threads","3",exception);
+  (void) RelinquishUniqueFileResource(path);
+  distortion=(-1.0);
+  if ((images != (Image *) NULL) && (reference != (Image *) NULL))
+    distortion=CompareCheckImages(images,reference,exception);
+  workers=GetMagickResourceLimit(ThreadResource);
+  if (workers > 3)
+    workers=3;
+  (void) FormatLocaleString(detail,MagickPathExtent,"%.20g of 7 pages with "
+    "%.20g workers, %.20g with 1, maximum difference %g",(double)
+    GetImageListLength(images),(double) workers,(double)
+    GetImageListLength(reference),distortion);
+  if (images != (Image *) NULL)
+    images=DestroyImageList(images);
+  if (reference != (Image *) NULL)
+    reference=DestroyImageList(reference);
+  return(distortion == 0.0 ? MagickTrue : MagickFalse);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C h e c k P D F T h u m b n a i l                                         %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CheckPDFThumbnail() renders a page with the pdf:thumbnail hint and checks
+%  it comes out at the size -thumbnail would resize the default 72 DPI
+%  render to.
+%
+%  The format of the CheckPDFThumbnail method is:
+%
+%      MagickBooleanType CheckPDFThumbnail(char *detail,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o detail: describe the result here.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType CheckPDFThumbnail(char *detail,
+  ExceptionInfo *exception)
+{
+  char
+    filename[MagickPathExtent],
+    path[MagickPathExtent];
+
+  Image
+    *image,
+    *reference;
+
+  MagickBooleanType
+    status;
+
+  RectangleInfo
+    geometry;
+
+  (void) AcquireUniqueFilename(path);
+  if (WriteBenchPDF("pages",1,path) == MagickFalse)
+    {
+      (void) FormatLocaleString(detail,MagickPathExtent,
+        "unable to write `%s'",path);
+      (void) RelinquishUniqueFileResource(path);
+      return(MagickFalse);
+    }
+  (void) FormatLocaleString(filename,MagickPathExtent,"pdf:%s",path);
+  reference=ReadCheckImage(filename,(const char *) NULL,(const char *) NULL,
+    (const char *) NULL,exception);
+  image=ReadCheckImage(filename,(const char *) NULL,"pdf:thumbnail",
+    "128x128",exception);
+  (void) RelinquishUniqueFileResource(path);
+  if ((image == (Image *) NULL) || (reference == (Image *) NULL))
+    {
+      (void) CopyMagickString(detail,"unable to read the page",
+        MagickPathExtent);
+      if (image != (Image *) NULL)
+        image=DestroyImageList(image);
+      if (reference != (Image *) NULL)
+        reference=DestroyImageList(reference);
+      return(MagickFalse);
+    }
+  SetGeometry(reference,&geometry);
+  (void) ParseMetaGeometry("128x128",&geometry.x,&geometry.y,&geometry.width,
+    &geometry.height);
+  status=(image->columns == geometry.width) &&
+    (image->rows == geometry.height) ? MagickTrue : MagickFalse;
+  (void) FormatLocaleString(detail,MagickPathExtent,"%.20gx%.20g page, "
+    "thumbnail %.20gx%.20g, rendered %.20gx%.20g",(double) reference->columns,
+    (double) reference->rows,(double) geometry.width,(double) geometry.height,
+    (double) image->columns,(double) image->rows);
+  image=DestroyImageList(image);
+  reference=DestroyImageList(reference);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C h e c k R e s i z e                                                     %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CheckResize() halves a noise image with the box filter and checks every
+%  pixel against the mean of its 2x2 source block, once without alpha, which
+%  takes the all-channel path, and once with an opaque alpha channel, which
+%  takes the per-channel path.
+%
+%  The format of the CheckResize method is:
+%
+%      MagickBooleanType CheckResize(char *detail,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o detail: describe the result here.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType CheckResize(char *detail,ExceptionInfo *exception)
+{
+  MagickBooleanType
+    status;
+
+  register ssize_t
+    i;
+
+  status=MagickTrue;
+  for (i=0; i < 2; i++)
+  {
+    char
+      result[MagickPathExtent];
+
+    double
+      distortion;
+
+    Image
+      *image,
+      *resize_image;
+
+    size_t
+      channels;
+
+    ssize_t
+      y;
+
+    image=AcquireCheckImage(96,64,21,exception);
+    if (image == (Image *) NULL)
+      return(MagickFalse);
+    if (i != 0)
+      (void) SetImageAlphaChannel(image,OpaqueAlphaChannel,exception);
+    resize_image=ResizeImage(image,image->columns/2,image->rows/2,BoxFilter,
+      exception);
+    if (resize_image == (Image *) NULL)
+      {
+        image=DestroyImage(image);
+        return(MagickFalse);
+      }
+    channels=GetPixelChannels(image);
+    distortion=0.0;
+    for (y=0; y < (ssize_t) resize_image->rows; y++)
+    {
+      register const Quantum
+        *magick_restrict p,
+        *magick_restrict q;
+
+      register ssize_t
+        x;
+
+      p=GetVirtualPixels(image,0,2*y,image->columns,2,exception);
+      q=GetVirtualPixels(resize_image,0,y,resize_image->columns,1,exception);
+      if ((p == (const Quantum *) NULL) || (q == (const Quantum *) NULL) ||
+          (GetPixelChannels(resize_image) != channels))
+        {
+          distortion=(-1.0);
+          break;
+        }
+      for (x=0; x < (ssize_t) resize_image->columns; x++)
+      {
+        register const Quantum
+          *magick_restrict r;
+
+        register ssize_t
+          j;
+
+        r=p+2*x*channels;
+        for (j=0; j < (ssize_t) channels; j++)
+        {
+          double
+            mean;
+
+          mean=((double) r[j]+(double) r[channels+j]+(double)
+            r[image->columns*channels+j]+(double)
+            r[(image->columns+1)*channels+j])/4.0;
+          if (fabs((double) q[j]-mean) > distortion)
+            distortion=fabs((double) q[j]-mean);
+        }
+        q+=channels;
+      }
+    }
+    if ((distortion < 0.0) || (distortion > 1.0))
+      status=MagickFalse;
+    (void) FormatLocaleString(result,MagickPathExtent,"%s%.20g channels: "
+      "maximum difference from the 2x2 mean %g",i == 0 ? "" : "; ",(double)
+      channels,distortion);
+    (void) ConcatenateMagickString(detail,result,MagickPathExtent);
+    resize_image=DestroyImage(resize_image);
+    image=DestroyImage(image);
+  }
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   C h e c k S t a t i s t i c                                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CheckStatistic() runs the median, maximum, and minimum statistics over a
+%  9x7 neighborhood, large enough to take the sliding histogram path, and
+%  checks them against the brute-force reference.  The image spans several
+%  strips of rows, and the rows near the top edge read virtual pixels above
+%  the image.  The neighborhood holds an odd number of samples, so the
+%  median, the sample of rank count/2, is the same whichever way it is found.
+%
+%  The format of the CheckStatistic method is:
+%
+%      MagickBooleanType CheckStatistic(char *detail,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o detail: describe the result here.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static MagickBooleanType CheckStatistic(char *detail,
+  ExceptionInfo *exception)
+{
+  static const CheckReduction
+    Reductions[] =
+    {
+      MedianCheckReduction,
+      MaximumCheckReduction,
+      MinimumCheckReduction
+    };
+
+  static const StatisticType
+    Statistics[] = { MedianStatistic, MaximumStatistic, MinimumStatistic };
+
+  Image
+    *image;
+
+  KernelInfo
+    *kernel;
+
+  MagickBooleanType
+    status;
+
+  register ssize_t
+    i;
+
+  image=AcquireCheckImage(61,100,25,exception);
+  if (image == (Image *) NULL)
+    return(MagickFalse);
+  (void) SetImageVirtualPixelMethod(image,EdgeVirtualPixelMethod,exception);
+  kernel=AcquireKernelInfo("Rectangle:9x7",exception);
+  if (kernel == (KernelInfo *) NULL)
+    {
+      image=DestroyImage(image);
+      return(MagickFalse);
+    }
+  status=MagickTrue;
+  for (i=0; i < (ssize_t) (sizeof(Statistics)/sizeof(*Statistics)); i++)
+  {
+    char
+      result[MagickPathExtent];
+
+    double
+      distortion;
+
+    Image
+      *reference,
+      *statistic_image;
+
+    statistic_image=StatisticImage(image,Statistics[i],kernel->width,
+      kernel->height,exception);
+    reference=ReduceCheckImage(image,kernel,Reductions[i],exception);
+    distortion=(-1.0);
+    if ((statistic_image != (Image *) NULL) && (reference != (Image *) NULL))
+      distortion=CompareCheckImages(statistic_image,reference,exception);
+    if (distortion != 0.0)
+      status=MagickFalse;
+    (void) FormatLocaleString(result,MagickPathExtent,"%s%s %.20gx%.20g "
+      "over 9x7: maximum difference %g",i == 0 ? "" : "; ",
+      CommandOptionToMnemonic(MagickStatisticOptions,(ssize_t) Statistics[i]),
+      (double) image->columns,(double) image->rows,distortion);
+    (void) ConcatenateMagickString(detail,result,MagickPathExtent);
+    if (reference != (Image *) NULL)
+      reference=DestroyImage(reference);
+    if (statistic_image != (Image *) NULL)
+      statistic_image=DestroyImage(statistic_image);
+  }
+  kernel=DestroyKernelInfo(kernel);
+  image=DestroyImage(image);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%  C h e c k B e n c h M a i n                                                %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  CheckBenchMain() runs the checks, or only the named ones:
+%
+%      checkbench [-label text] [check ...]
+%
+*/
+
+static int CheckBenchUsage(const CheckInfo *checks,const size_t number_checks)
+{
+  register ssize_t
+    i;
+
+  (void) printf("Usage: checkbench [options ...] [check ...]\n");
+  (void) printf("\nOptions:\n");
+  (void) printf("  -label text          tag each result, e.g. with a commit "
+    "id\n");
+  (void) printf("\nChecks:\n");
+  for (i=0; i < (ssize_t) number_checks; i++)
+    (void) printf("  %s\n",checks[i].name);
+  return(1);
+}
+
+int CheckBenchMain(int argc,char **argv)
+{
+  static const CheckInfo
+    Checks[] =
+    {
+      { "morphology", CheckMorphology },
+      { "pdf-bands", CheckPDFBands },
+      { "pdf-cache", CheckPDFCache },
+      { "pdf-pages", CheckPDFPages },
+      { "pdf-threads", CheckPDFThreads },
+      { "pdf-thumbnail", CheckPDFThumbnail },
+      { "resize", CheckResize },
+      { "statistic", CheckStatistic }
+    };
+
+  char
+    *label;
+
+  const char
+    *option_label;
+
+  ExceptionInfo
+    *exception;
+
+  int
+    exit_code;
+
+  MagickBooleanType
+    *selected;
+
+  register ssize_t
+    i,
+    j;
+
+  size_t
+    number_checks,
+    number_selected;
+
+  MagickCoreGenesis(*argv,MagickTrue);
+  exception=AcquireExceptionInfo();
+  number_checks=sizeof(Checks)/sizeof(*Checks);
+  selected=(MagickBooleanType *) AcquireQuantumMemory(number_checks,
+    sizeof(*selected));
+  if (selected == (MagickBooleanType *) NULL)
+    {
+      exception=DestroyExceptionInfo(exception);
+      MagickCoreTerminus();
+      return(1);
+    }
+  (void) ResetMagickMemory(selected,0,number_checks*sizeof(*selected));
+  option_label="";
+  number_selected=0;
+  exit_code=0;
+  for (i=1; i < (ssize_t) argc; i++)
+  {
+    const char
+      *option;
+
+    option=argv[i];
+    if (*option != '-')
+      {
+        for (j=0; j < (ssize_t) number_checks; j++)
+          if (LocaleCompare(Checks[j].name,option) == 0)
+            break;
+        if (j == (ssize_t) number_checks)
+          {
+            exit_code=CheckBenchUsage(Checks,number_checks);
+            break;
+          }
+        selected[j]=MagickTrue;
+        number_selected++;
+        continue;
+      }
+    if ((LocaleCompare("-label",option) == 0) && (i < (ssize_t) (argc-1)))
+      {
+        option_label=argv[++i];
+        continue;
+      }
+    exit_code=CheckBenchUsage(Checks,number_checks);
+    break;
+  }
+  if (exit_code != 0)
+    {
+      selected=(MagickBooleanType *) RelinquishMagickMemory(selected);
+      exception=DestroyExceptionInfo(exception);
+      MagickCoreTerminus();
+      return(exit_code);
+    }
+  label=EscapeBenchString(option_label);
+  for (i=0; i < (ssize_t) number_checks; i++)
+  {
+    char
+      detail[MagickPathExtent],
+      *escape;
+
+    MagickBooleanType
+      status;
+
+    if ((number_selected != 0) && (selected[i] == MagickFalse))
+      continue;
+    *detail='\0';
+    status=Checks[i].method(detail,exception);
+    if (exception->severity != UndefinedException)
+      {
+        CatchException(exception);
+        ClearMagickException(exception);
+      }
+    escape=EscapeBenchString(detail);
+    (void) fprintf(stdout,"{\"label\": \"%s\", \"check\": \"%s\", "
+      "\"result\": \"%s\", \"detail\": \"%s\"}\n",label,Checks[i].name,
+      status != MagickFalse ? "pass" : "fail",escape);
+    (void) fflush(stdout);
+    escape=DestroyString(escape);
+    if (status == MagickFalse)
+      exit_code=1;
+  }
+  label=DestroyString(label);
+  selected=(MagickBooleanType *) RelinquishMagickMemory(selected);
+  exception=DestroyExceptionInfo(exception);
+  MagickCoreTerminus();
+  return(exit_code);
+}
@@ -0,0 +1,824 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%        PPPP   DDDD   FFFFF  BBBB   EEEEE  N   N   CCCC  H   H               %
+%        P   P  D   D  F      B   B  E      NN  N  C      H   H               %
+%        PPPP   D   D  FFF    BBBB   EEE    N N N  C      HHHHH               %
+%        P      D   D  F      B   B  E      N  NN  C      H   H               %
+%        P      DDDD   F      BBBB   EEEEE  N   N   CCCC  H   H               %
+%                                                                             %
+%                                                                             %
+%                 Benchmark the PDF to Raster Conversion Pipeline             %
+%                                                                             %
+%                                                                             %
+%  Copyright 1999-2017 ImageMagick Studio LLC, a non-profit organization      %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://www.imagemagick.org/script/license.php                           %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  Run a corpus of PDF documents through ReadImage() and the encoder and
+%  report the time spent in each stage of the PDF coder, the encode time,
+%  and pages per second.  Without input files a corpus of vector-heavy,
+%  image-heavy, CMYK, and many-page documents is generated.  Each iteration
+%  is reported as one JSON object per line, or as a CSV row, so results can
+%  be compared across builds.  The peak resident set size is a maximum over
+%  the whole process, so it is reported once, in a final summary record of
+%  kind "all".
+%
+%  With -stream, the first page of each document is streamed into a BMP
+%  file with StreamBMPImage(), the path "convert file.pdf[0] file.bmp"
+%  takes, and no encode stage is timed.  Compare the peak resident set size
+%  of a run with and without -stream on the same document to measure what
+%  the stream saves.
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "../MagickWand/studio.h"
+#include "../MagickWand/MagickWand.h"
+#include "./bench.h"
+#if defined(MAGICKCORE_HAVE_SYS_RESOURCE_H)
+#include <sys/resource.h>
+#endif
+
+/*
+  Typedef declarations.
+*/
+typedef enum
+{
+  JSONBenchFormat,
+  CSVBenchFormat
+} BenchFormat;
+
+typedef struct _BenchDocumentInfo
+{
+  char
+    kind[MagickPathExtent],
+    path[MagickPathExtent];
+
+  MagickBooleanType
+    temporary;
+} BenchDocumentInfo;
+
+typedef struct _BenchOptions
+{
+  BenchFormat
+    format;
+
+  const char
+    *density,
+    *encode,
+    *label;
+
+  MagickBooleanType
+    stream;
+
+  size_t
+    iterations,
+    pages;
+} BenchOptions;
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e n e r a t e B e n c h D o c u m e n t                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GenerateBenchDocument() writes one document of the synthetic corpus.  The
+%  vector and pages documents are written as PDF directly; the image and
+%  CMYK documents embed a generated raster through the PDF encoder.  The
+%  content is deterministic so every run measures the same work.  The check
+%  harness writes its documents with WriteBenchPDF() as well.
+%
+%  The format of the GenerateBenchDocument method is:
+%
+%      MagickBooleanType GenerateBenchDocument(const char *kind,
+%        const size_t pages,const char *path,ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o kind: vector, image, cmyk, or pages.
+%
+%    o pages: the number of pages of the pages document.
+%
+%    o path: write the document to this file.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+static inline double BenchRandom(unsigned int *seed)
+{
+  *seed=1103515245U*(*seed)+12345U;
+  return((double) ((*seed >> 8) & 0xffff)/65535.0);
+}
+
+MagickBooleanType WriteBenchPDF(const char *kind,const size_t pages,
+  const char *path)
+{
+  FILE
+    *file;
+
+  MagickOffsetType
+    *offsets,
+    xref;
+
+  register ssize_t
+    i,
+    j;
+
+  size_t
+    number_objects;
+
+  unsigned int
+    seed;
+
+  file=fopen(path,"wb");
+  if (file == (FILE *) NULL)
+    return(MagickFalse);
+  number_objects=3+2*pages;
+  offsets=(MagickOffsetType *) AcquireQuantumMemory(number_objects+1,
+    sizeof(*offsets));
+  if (offsets == (MagickOffsetType *) NULL)
+    {
+      (void) fclose(file);
+      return(MagickFalse);
+    }
+  (void) fprintf(file,"%%PDF-1.4\n");
+  offsets[1]=(MagickOffsetType) ftell(file);
+  (void) fprintf(file,"1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+  offsets[2]=(MagickOffsetType) ftell(file);
+  (void) fprintf(file,"2 0 obj\n<< /Type /Pages /Count %.20g /Kids [",
+    (double) pages);
+  for (i=0; i < (ssize_t) pages; i++)
+    (void) fprintf(file," %.20g 0 R",(double) (4+2*i));
+  (void) fprintf(file," ] >>\nendobj\n");
+  offsets[3]=(MagickOffsetType) ftell(file);
+  (void) fprintf(file,"3 0 obj\n<< /Type /Font /Subtype /Type1 /BaseFont "
+    "/Helvetica >>\nendobj\n");
+  seed=(unsigned int) pages;
+  for (i=0; i < (ssize_t) pages; i++)
+  {
+    char
+      *content;
+
+    size_t
+      length;
+
+    /*
+      Build the page content stream.
+    */
+    content=AcquireString("");
+    if (LocaleCompare(kind,"vector") == 0)
+      for (j=0; j < 20000; j++)
+      {
+        char
+          path_operator[MagickPathExtent];
+
+        double
+          r[12];
+
+        register ssize_t
+          k;
+
+        for (k=0; k < 12; k++)
+          r[k]=BenchRandom(&seed);
+        (void) FormatLocaleString(path_operator,MagickPathExtent,
+          "%.3f %.3f %.3f RG %.3f w %.2f %.2f m %.2f %.2f %.2f %.2f %.2f %.2f "
+          "c S\n",r[0],r[1],r[2],0.1+2.0*r[3],612.0*r[4],792.0*r[5],612.0*r[4]+
+          80.0*r[6]-40.0,792.0*r[5]+80.0*r[7]-40.0,612.0*r[4]+80.0*r[8]-40.0,
+          792.0*r[5]+80.0*r[9]-40.0,612.0*r[4]+80.0*r[10]-40.0,792.0*r[5]+
+          80.0*r[11]-40.0);
+        (void) ConcatenateString(&content,path_operator);
+      }
+    else
+      for (j=0; j < 40; j++)
+      {
+        char
+          text_operator[MagickPathExtent];
+
+        (void) FormatLocaleString(text_operator,MagickPathExtent,
+          "BT /F1 12 Tf 54 %.20g Td (Page %.20g line %.20g: the quick brown "
+          "fox jumps over the lazy dog) Tj ET\n",(double) (750-18*j),(double)
+          i+1,(double) j+1);
+        (void) ConcatenateString(&content,text_operator);
+      }
+    length=strlen(content);
+    offsets[4+2*i]=(MagickOffsetType) ftell(file);
+    (void) fprintf(file,"%.20g 0 obj\n<< /Type /Page /Parent 2 0 R "
+      "/MediaBox [0 0 612 792] /Resources << /Font << /F1 3 0 R >> >> "
+      "/Contents %.20g 0 R >>\nendobj\n",(double) (4+2*i),(double) (5+2*i));
+    offsets[5+2*i]=(MagickOffsetType) ftell(file);
+    (void) fprintf(file,"%.20g 0 obj\n<< /Length %.20g >>\nstream\n",(double)
+      (5+2*i),(double) length);
+    (void) fwrite(content,1,length,file);
+    (void) fprintf(file,"\nendstream\nendobj\n");
+    content=DestroyString(content);
+  }
+  xref=(MagickOffsetType) ftell(file);
+  (void) fprintf(file,"xref\n0 %.20g\n0000000000 65535 f \n",(double)
+    (number_objects+1));
+  for (i=1; i <= (ssize_t) number_objects; i++)
+    (void) fprintf(file,"%010.0f 00000 n \n",(double) offsets[i]);
+  (void) fprintf(file,"trailer\n<< /Size %.20g /Root 1 0 R >>\nstartxref\n"
+    "%.20g\n%%%%EOF\n",(double) (number_objects+1),(double) xref);
+  offsets=(MagickOffsetType *) RelinquishMagickMemory(offsets);
+  return(fclose(file) == 0 ? MagickTrue : MagickFalse);
+}
+
+static MagickBooleanType GenerateBenchDocument(const char *kind,
+  const size_t pages,const char *path,ExceptionInfo *exception)
+{
+  Image
+    *image;
+
+  ImageInfo
+    *image_info;
+
+  MagickBooleanType
+    status;
+
+  ssize_t
+    y;
+
+  if (LocaleCompare(kind,"vector") == 0)
+    return(WriteBenchPDF(kind,1,path));
+  if (LocaleCompare(kind,"pages") == 0)
+    return(WriteBenchPDF(kind,pages,path));
+  /*
+    Embed a 2400x3200 raster, one US letter page at 300 DPI.
+  */
+  image_info=AcquireImageInfo();
+  image=AcquireImage(image_info,exception);
+  status=SetImageExtent(image,2400,3200,exception);
+  for (y=0; (status != MagickFalse) && (y < (ssize_t) image->rows); y++)
+  {
+    register Quantum
+      *q;
+
+    register ssize_t
+      x;
+
+    q=QueueAuthenticPixels(image,0,y,image->columns,1,exception);
+    if (q == (Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    for (x=0; x < (ssize_t) image->columns; x++)
+    {
+      SetPixelRed(image,(Quantum) (QuantumRange*((x ^ y) & 0xff)/255.0),q);
+      SetPixelGreen(image,(Quantum) (QuantumRange*(((x*y) >> 7) & 0xff)/
+        255.0),q);
+      SetPixelBlue(image,(Quantum) (QuantumRange*((x+2*y) & 0xff)/255.0),q);
+      q+=GetPixelChannels(image);
+    }
+    status=SyncAuthenticPixels(image,exception);
+  }
+  if ((status != MagickFalse) && (LocaleCompare(kind,"cmyk") == 0))
+    status=TransformImageColorspace(image,CMYKColorspace,exception);
+  if (status != MagickFalse)
+    {
+      image->resolution.x=300.0;
+      image->resolution.y=300.0;
+      image->units=PixelsPerInchResolution;
+      (void) FormatLocaleString(image->filename,MagickPathExtent,"pdf:%s",
+        path);
+      status=WriteImage(image_info,image,exception);
+    }
+  image=DestroyImage(image);
+  image_info=DestroyImageInfo(image_info);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   B e n c h D o c u m e n t                                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  BenchDocument() reads and encodes a document the requested number of
+%  times and reports each iteration.
+%
+%  The format of the BenchDocument method is:
+%
+%      MagickBooleanType BenchDocument(const ImageInfo *image_info,
+%        const BenchOptions *options,const BenchDocumentInfo *document,
+%        ExceptionInfo *exception)
+%
+%  A description of each parameter follows:
+%
+%    o image_info: the settings, including any -define, for each read.
+%
+%    o options: the benchmark options.
+%
+%    o document: the document.
+%
+%    o exception: return any errors or warnings in this structure.
+%
+*/
+
+char *EscapeBenchString(const char *text)
+{
+  char
+    *escape;
+
+  register const char
+    *p;
+
+  register ssize_t
+    i;
+
+  /*
+    Escape text for a JSON string: quotes, backslashes, and control
+    characters.
+  */
+  escape=(char *) AcquireQuantumMemory(6*strlen(text)+1,sizeof(*escape));
+  if (escape == (char *) NULL)
+    return(AcquireString(""));
+  i=0;
+  for (p=text; *p != '\0'; p++)
+  {
+    if ((unsigned char) *p < 0x20)
+      {
+        (void) FormatLocaleString(escape+i,7,"\\u%04x",(unsigned int)
+          ((unsigned char) *p));
+        i+=6;
+        continue;
+      }
+    if ((*p == '"') || (*p == '\\'))
+      escape[i++]='\\';
+    escape[i++]=(*p);
+  }
+  escape[i]='\0';
+  return(escape);
+}
+
+static char *QuoteBenchString(const char *text)
+{
+  char
+    *quote;
+
+  register const char
+    *p;
+
+  register ssize_t
+    i;
+
+  /*
+    Quote text for a CSV field, doubling any embedded quotes.
+  */
+  quote=(char *) AcquireQuantumMemory(2*strlen(text)+3,sizeof(*quote));
+  if (quote == (char *) NULL)
+    return(AcquireString("\"\""));
+  i=0;
+  quote[i++]='"';
+  for (p=text; *p != '\0'; p++)
+  {
+    if (*p == '"')
+      quote[i++]='"';
+    quote[i++]=(*p);
+  }
+  quote[i++]='"';
+  quote[i]='\0';
+  return(quote);
+}
+
+static double GetBenchArtifact(const Image *image,const char *artifact)
+{
+  const char
+    *value;
+
+  value=GetImageArtifact(image,artifact);
+  if (value == (const char *) NULL)
+    return(0.0);
+  return(InterpretLocaleValue(value,(char **) NULL));
+}
+
+static MagickSizeType GetBenchPeakRSS(void)
+{
+#if defined(MAGICKCORE_HAVE_GETRUSAGE) && \
+    defined(MAGICKCORE_HAVE_SYS_RESOURCE_H)
+  struct rusage
+    usage;
+
+  if (getrusage(RUSAGE_SELF,&usage) != 0)
+    return(0);
+#if defined(__APPLE__)
+  return((MagickSizeType) usage.ru_maxrss);
+#else
+  return((MagickSizeType) usage.ru_maxrss*1024);
+#endif
+#else
+  return(0);
+#endif
+}
+
+static Image *StreamBenchImage(const ImageInfo *image_info,
+  ExceptionInfo *exception)
+{
+  char
+    filename[MagickPathExtent];
+
+  Image
+    *image;
+
+  ImageInfo
+    *write_info;
+
+  StreamInfo
+    *stream_info;
+
+  /*
+    Stream the page into a scratch BMP file, as convert does.
+  */
+  (void) AcquireUniqueFilename(filename);
+  write_info=CloneImageInfo(image_info);
+  (void) FormatLocaleString(write_info->filename,MagickPathExtent,"bmp:%s",
+    filename);
+  (void) SetImageInfo(write_info,1,exception);
+  stream_info=AcquireStreamInfo(write_info,exception);
+  image=(Image *) NULL;
+  if (OpenStream(write_info,stream_info,filename,exception) != MagickFalse)
+    image=StreamBMPImage(image_info,stream_info,exception);
+  stream_info=DestroyStreamInfo(stream_info);
+  write_info=DestroyImageInfo(write_info);
+  (void) RelinquishUniqueFileResource(filename);
+  return(image);
+}
+
+static MagickBooleanType BenchDocument(const ImageInfo *image_info,
+  const BenchOptions *options,const BenchDocumentInfo *document,
+  ExceptionInfo *exception)
+{
+  char
+    *label,
+    *path;
+
+  double
+    encode,
+    read,
+    total;
+
+  Image
+    *images;
+
+  ImageInfo
+    *read_info,
+    *write_info;
+
+  MagickBooleanType
+    status;
+
+  register ssize_t
+    i;
+
+  size_t
+    length,
+    pages;
+
+  TimerInfo
+    timer;
+
+  unsigned char
+    *blob;
+
+  if (options->format == CSVBenchFormat)
+    {
+      label=QuoteBenchString(options->label);
+      path=QuoteBenchString(document->path);
+    }
+  else
+    {
+      label=EscapeBenchString(options->label);
+      path=EscapeBenchString(document->path);
+    }
+  status=MagickTrue;
+  for (i=0; i < (ssize_t) options->iterations; i++)
+  {
+    read_info=CloneImageInfo(image_info);
+    (void) FormatLocaleString(read_info->filename,MagickPathExtent,
+      options->stream != MagickFalse ? "pdf:%s[0]" : "pdf:%s",document->path);
+    if (options->density != (const char *) NULL)
+      (void) CloneString(&read_info->density,options->density);
+    GetTimerInfo(&timer);
+    if (options->stream != MagickFalse)
+      images=StreamBenchImage(read_info,exception);
+    else
+      images=ReadImage(read_info,exception);
+    read=GetElapsedTime(&timer);
+    read_info=DestroyImageInfo(read_info);
+    if (images == (Image *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    pages=GetImageListLength(images);
+    encode=0.0;
+    if (options->stream == MagickFalse)
+      {
+        write_info=CloneImageInfo(image_info);
+        (void) CopyMagickString(write_info->magick,options->encode,
+          MagickPathExtent);
+        GetTimerInfo(&timer);
+        blob=(unsigned char *) ImagesToBlob(write_info,images,&length,
+          exception);
+        encode=GetElapsedTime(&timer);
+        write_info=DestroyImageInfo(write_info);
+        if (blob == (unsigned char *) NULL)
+          status=MagickFalse;
+        else
+          blob=(unsigned char *) RelinquishMagickMemory(blob);
+      }
+    total=read+encode;
+    if (options->format == CSVBenchFormat)
+      (void) fprintf(stdout,"%s,%s,%s,%.20g,%.20g,%.6f,%.6f,%.6f,%.6f,%.6f,"
+        "%.6f,%.6f,%.6f,%.6f,,%s\n",label,document->kind,path,(double) i,
+        (double) pages,GetBenchArtifact(images,"pdf:elapsed-scan"),
+        GetBenchArtifact(images,"pdf:elapsed-startup"),GetBenchArtifact(images,
+        "pdf:elapsed-render"),GetBenchArtifact(images,"pdf:elapsed-read"),
+        GetBenchArtifact(images,"pdf:elapsed-consolidate"),read,encode,total,
+        total > 0.0 ? (double) pages/total : 0.0,status != MagickFalse ? "ok" :
+        "failed");
+    else
+      (void) fprintf(stdout,"{\"label\": \"%s\", \"kind\": \"%s\", "
+        "\"document\": \"%s\", \"iteration\": %.20g, \"pages\": %.20g, "
+        "\"elapsed\": {\"scan\": %.6f, \"startup\": %.6f, \"render\": %.6f, "
+        "\"read\": %.6f, \"consolidate\": %.6f, \"read-image\": %.6f, "
+        "\"encode\": %.6f, \"total\": %.6f}, \"pages-per-second\": %.6f, "
+        "\"status\": \"%s\"}\n",label,document->kind,path,(double) i,(double)
+        pages,GetBenchArtifact(images,"pdf:elapsed-scan"),GetBenchArtifact(
+        images,"pdf:elapsed-startup"),GetBenchArtifact(images,
+        "pdf:elapsed-render"),GetBenchArtifact(images,"pdf:elapsed-read"),
+        GetBenchArtifact(images,"pdf:elapsed-consolidate"),read,encode,total,
+        total > 0.0 ? (double) pages/total : 0.0,status != MagickFalse ? "ok" :
+        "failed");
+    (void) fflush(stdout);
+    images=DestroyImageList(images);
+    if (status == MagickFalse)
+      break;
+  }
+  path=DestroyString(path);
+  label=DestroyString(label);
+  return(status);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%  P D F B e n c h M a i n                                                    %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  PDFBenchMain() runs the benchmark:
+%
+%      pdfbench [-define key=value] [-density geometry] [-encode format]
+%        [-format json|csv] [-iterations n] [-label text] [-pages n]
+%        [-stream] [file.pdf ...]
+%
+*/
+
+static int PDFBenchUsage(void)
+{
+  (void) printf("Usage: pdfbench [options ...] [file.pdf ...]\n");
+  (void) printf("\nOptions:\n");
+  (void) printf("  -define format:option\n");
+  (void) printf("                       define one or more PDF coder "
+    "options\n");
+  (void) printf("  -density geometry    render resolution\n");
+  (void) printf("  -encode format       output image format (default BMP)\n");
+  (void) printf("  -format type         json (default) or csv\n");
+  (void) printf("  -iterations value    runs per document (default 3)\n");
+  (void) printf("  -label text          tag each result, e.g. with a commit "
+    "id\n");
+  (void) printf("  -pages value         pages in the generated many-page "
+    "document\n");
+  (void) printf("  -stream              stream the first page into a BMP "
+    "file\n");
+  (void) printf("\nWithout files, a vector, image, CMYK, and many-page corpus "
+    "is generated.\n");
+  return(1);
+}
+
+int PDFBenchMain(int argc,char **argv)
+{
+  static const char
+    *BenchKinds[] = { "vector", "image", "cmyk", "pages" };
+
+  BenchDocumentInfo
+    *documents;
+
+  BenchOptions
+    options;
+
+  ExceptionInfo
+    *exception;
+
+  ImageInfo
+    *image_info;
+
+  int
+    exit_code;
+
+  MagickBooleanType
+    status,
+    summary;
+
+  register ssize_t
+    i;
+
+  size_t
+    number_documents;
+
+  MagickCoreGenesis(*argv,MagickTrue);
+  exception=AcquireExceptionInfo();
+  image_info=AcquireImageInfo();
+  (void) ResetMagickMemory(&options,0,sizeof(options));
+  options.format=JSONBenchFormat;
+  options.encode="BMP";
+  options.label="";
+  options.iterations=3;
+  options.pages=64;
+  documents=(BenchDocumentInfo *) AcquireQuantumMemory((size_t) argc+4,
+    sizeof(*documents));
+  if (documents == (BenchDocumentInfo *) NULL)
+    {
+      image_info=DestroyImageInfo(image_info);
+      exception=DestroyExceptionInfo(exception);
+      MagickCoreTerminus();
+      return(1);
+    }
+  (void) ResetMagickMemory(documents,0,((size_t) argc+4)*sizeof(*documents));
+  number_documents=0;
+  exit_code=0;
+  for (i=1; i < (ssize_t) argc; i++)
+  {
+    const char
+      *option;
+
+    option=argv[i];
+    if ((*option != '-') || (*(option+1) == '\0'))
+      {
+        (void) CopyMagickString(documents[number_documents].kind,"file",
+          MagickPathExtent);
+        (void) CopyMagickString(documents[number_documents].path,option,
+          MagickPathExtent);
+        number_documents++;
+        continue;
+      }
+    if (LocaleCompare("-stream",option) == 0)
+      {
+        options.stream=MagickTrue;
+        continue;
+      }
+    if (i == (ssize_t) (argc-1))
+      {
+        exit_code=PDFBenchUsage();
+        break;
+      }
+    if (LocaleCompare("-define",option) == 0)
+      {
+        char
+          key[MagickPathExtent],
+          *value;
+
+        (void) CopyMagickString(key,argv[++i],MagickPathExtent);
+        value=strchr(key,'=');
+        if (value != (char *) NULL)
+          *value++='\0';
+        (void) SetImageOption(image_info,key,value != (char *) NULL ? value :
+          "1");
+        continue;
+      }
+    if (LocaleCompare("-density",option) == 0)
+      {
+        options.density=argv[++i];
+        continue;
+      }
+    if (LocaleCompare("-encode",option) == 0)
+      {
+        options.encode=argv[++i];
+        continue;
+      }
+    if (LocaleCompare("-format",option) == 0)
+      {
+        options.format=LocaleCompare("csv",argv[++i]) == 0 ? CSVBenchFormat :
+          JSONBenchFormat;
+        continue;
+      }
+    if (LocaleCompare("-iterations",option) == 0)
+      {
+        options.iterations=strtoul(argv[++i],(char **) NULL,10);
+        continue;
+      }
+    if (LocaleCompare("-label",option) == 0)
+      {
+        options.label=argv[++i];
+        continue;
+      }
+    if (LocaleCompare("-pages",option) == 0)
+      {
+        options.pages=strtoul(argv[++i],(char **) NULL,10);
+        if (options.pages == 0)
+          options.pages=1;
+        continue;
+      }
+    exit_code=PDFBenchUsage();
+    break;
+  }
+  if ((exit_code == 0) && (number_documents == 0))
+    for (i=0; i < (ssize_t) (sizeof(BenchKinds)/sizeof(*BenchKinds)); i++)
+    {
+      /*
+        Generate the synthetic corpus.
+      */
+      (void) CopyMagickString(documents[number_documents].kind,BenchKinds[i],
+        MagickPathExtent);
+      (void) AcquireUniqueFilename(documents[number_documents].path);
+      documents[number_documents].temporary=MagickTrue;
+      number_documents++;
+      if (GenerateBenchDocument(BenchKinds[i],options.pages,
+            documents[number_documents-1].path,exception) == MagickFalse)
+        {
+          CatchException(exception);
+          exit_code=1;
+          break;
+        }
+    }
+  summary=exit_code == 0 ? MagickTrue : MagickFalse;
+  if ((exit_code == 0) && (options.format == CSVBenchFormat))
+    (void) fprintf(stdout,"label,kind,document,iteration,pages,scan,startup,"
+      "render,read,consolidate,read-image,encode,total,pages-per-second,"
+      "peak-rss,status\n");
+  for (i=0; (exit_code == 0) && (i < (ssize_t) number_documents); i++)
+  {
+    status=BenchDocument(image_info,&options,documents+i,exception);
+    if (exception->severity != UndefinedException)
+      {
+        CatchException(exception);
+        ClearMagickException(exception);
+      }
+    if (status == MagickFalse)
+      exit_code=1;
+  }
+  if (summary != MagickFalse)
+    {
+      char
+        *label;
+
+      /*
+        The peak resident set size covers the whole run.
+      */
+      if (options.format == CSVBenchFormat)
+        {
+          label=QuoteBenchString(options.label);
+          (void) fprintf(stdout,"%s,all,,,,,,,,,,,,,%.20g,%s\n",label,
+            (double) GetBenchPeakRSS(),exit_code == 0 ? "ok" : "failed");
+        }
+      else
+        {
+          label=EscapeBenchString(options.label);
+          (void) fprintf(stdout,"{\"label\": \"%s\", \"kind\": \"all\", "
+            "\"peak-rss\": %.20g, \"status\": \"%s\"}\n",label,(double)
+            GetBenchPeakRSS(),exit_code == 0 ? "ok" : "failed");
+        }
+      label=DestroyString(label);
+    }
+  for (i=0; i < (ssize_t) number_documents; i++)
+    if (documents[i].temporary != MagickFalse)
+      (void) RelinquishUniqueFileResource(documents[i].path);
+  documents=(BenchDocumentInfo *) RelinquishMagickMemory(documents);
+  image_info=DestroyImageInfo(image_info);
+  exception=DestroyExceptionInfo(exception);
+  MagickCoreTerminus();
+  return(exit_code);
+}